@@ -1,3 +1,5 @@
 .\libs\vulkan_sdk\Bin\glslc.exe shaders\basic_shader.vert -o shaders\basic_shader.vert.spv
+.\libs\vulkan_sdk\Bin\glslc.exe shaders\basic_shader_packed.vert -o shaders\basic_shader_packed.vert.spv
 .\libs\vulkan_sdk\Bin\glslc.exe shaders\basic_shader.frag -o shaders\basic_shader.frag.spv
+.\libs\vulkan_sdk\Bin\glslc.exe shaders\gpu_cull.comp -o shaders\gpu_cull.comp.spv
 pause
\ No newline at end of file
@@ -2,17 +2,15 @@
 
 // input
 layout(location = 0) in vec3 vertexColor;
+layout(location = 1) in vec2 texCoord;
 
 // output
 layout(location = 0) out vec4 outColor;
 
-layout(push_constant) uniform push 
-{
-	mat4 meshMatrix; // projection * view * model
-	mat4 normalMatrix;
-} Push;
+// Resident levels of the object's texture, the white default while it streams in
+layout(set = 1, binding = 0) uniform sampler2D albedoTexture;
 
 void main() 
 {
-	outColor = vec4 (vertexColor, 1.0);
+	outColor = vec4 (vertexColor * texture(albedoTexture, texCoord).rgb, 1.0);
 };
\ No newline at end of file
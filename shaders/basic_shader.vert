@@ -6,8 +6,13 @@ layout(location = 1) in vec3 vertexColor;
 layout(location = 2) in vec3 normals;
 layout(location = 3) in vec2 texCoord;
 
+// input, FInstanceData. One entry per object, instanced draws step through them
+layout(location = 4) in mat4 instanceMeshMatrix;
+layout(location = 8) in mat4 instanceNormalMatrix;
+
 // output
 layout(location = 0) out vec3 vertexColorOut;
+layout(location = 1) out vec2 texCoordOut;
 
 layout(set = 0, binding = 0) uniform globalUniformBufferObject
 {
@@ -17,21 +22,15 @@ layout(set = 0, binding = 0) uniform globalUniformBufferObject
 	vec4 lightColor;
 } uniformBufferObject;
 
-layout(push_constant) uniform push 
-{
-	mat4 meshMatrix; // projection * view * model
-	mat4 normalMatrix;
-} Push;
-
 // output
 // layout(location = 1) out vec3 vertexColorOut;
 
 void main() 
 {
-	vec4 worldPosition = Push.meshMatrix * vec4(position, 1.0f);
+	vec4 worldPosition = instanceMeshMatrix * vec4(position, 1.0f);
 	gl_Position = uniformBufferObject.projectionViewMatrix * worldPosition;
 
-	vec3 normalWorldSpace = normalize(mat3(Push.normalMatrix) * normals);
+	vec3 normalWorldSpace = normalize(mat3(instanceNormalMatrix) * normals);
 
 	vec3 directionToLight = normalize(uniformBufferObject.lightPosition.xyz - worldPosition.xyz);
 	float lightAttenuation = 1.0f / dot(directionToLight.xyz, directionToLight.xyz);
@@ -40,4 +39,5 @@ void main()
 	vec3 diffuseLight = lightColor * max(dot(normalWorldSpace, normalize(directionToLight)), 0.0f);
 
 	vertexColorOut = vertexColor * (ambientLight + diffuseLight);
+	texCoordOut = texCoord;
 }
\ No newline at end of file
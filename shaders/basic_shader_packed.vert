@@ -0,0 +1,54 @@
+#version 460
+
+// input, PackedVertex. Position is snorm16 in the mesh bounds (meshMatrix carries the dequantization),
+// color is unorm8, the normal is octahedral snorm16 and texCoord is half float
+layout(location = 0) in vec3 position;
+layout(location = 1) in vec3 vertexColor;
+layout(location = 2) in vec2 octahedralNormal;
+layout(location = 3) in vec2 texCoord;
+
+// input, FInstanceData. One entry per object, instanced draws step through them
+layout(location = 4) in mat4 instanceMeshMatrix;
+layout(location = 8) in mat4 instanceNormalMatrix;
+
+// output
+layout(location = 0) out vec3 vertexColorOut;
+layout(location = 1) out vec2 texCoordOut;
+
+layout(set = 0, binding = 0) uniform globalUniformBufferObject
+{
+	mat4 projectionViewMatrix;
+	vec4 ambientColor;
+	vec4 lightPosition;
+	vec4 lightColor;
+} uniformBufferObject;
+
+// output
+// layout(location = 1) out vec3 vertexColorOut;
+
+vec3 decode_octahedral(vec2 encoded)
+{
+	vec3 normal = vec3(encoded, 1.0f - abs(encoded.x) - abs(encoded.y));
+	float fold = max(-normal.z, 0.0f);
+	normal.x += normal.x >= 0.0f ? -fold : fold;
+	normal.y += normal.y >= 0.0f ? -fold : fold;
+	return normalize(normal);
+}
+
+void main() 
+{
+	vec3 normals = decode_octahedral(octahedralNormal);
+	vec4 worldPosition = instanceMeshMatrix * vec4(position, 1.0f);
+	gl_Position = uniformBufferObject.projectionViewMatrix * worldPosition;
+
+	vec3 normalWorldSpace = normalize(mat3(instanceNormalMatrix) * normals);
+
+	vec3 directionToLight = normalize(uniformBufferObject.lightPosition.xyz - worldPosition.xyz);
+	float lightAttenuation = 1.0f / dot(directionToLight.xyz, directionToLight.xyz);
+	vec3 lightColor = uniformBufferObject.lightColor.rgb * uniformBufferObject.lightColor.w * lightAttenuation;
+	vec3 ambientLight = uniformBufferObject.ambientColor.rgb * uniformBufferObject.ambientColor.w;
+	vec3 diffuseLight = lightColor * max(dot(normalWorldSpace, normalize(directionToLight)), 0.0f);
+
+	vertexColorOut = vertexColor * (ambientLight + diffuseLight);
+	texCoordOut = texCoord;
+}
\ No newline at end of file
@@ -4,11 +4,16 @@
 #include <iostream>
 #include <sstream>
 #include <iomanip>
+#include <cstring>
 
 #include "SERendering/SERenderSystems/SERenderSystem.hpp"
 #include "SECore/SEEntities/SECamera.hpp"
 #include "SECore/SEInput/SEKeyboardInputController.hpp"
 #include "SERendering/SEBuffer.hpp"
+#include "SERendering/SEFrameAllocator.hpp"
+#include "SERendering/SEParallelRecorder.hpp"
+#include "SERendering/SEPipelineCache.hpp"
+#include "SERendering/SEStagingRing.hpp"
 
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
@@ -29,10 +34,13 @@ struct FGlobalUniformBufferObject
 	SEApp::SEApp()
 	{
 		m_TimeManager = std::make_unique<SETimeManager>(m_FixedTimeStep);
+		m_AssetStreamer = std::make_unique<SEAssetStreamer>(m_GraphicsDevice);
+		m_MeshCache = std::make_unique<SEMeshCache>(*m_AssetStreamer);
+		m_TextureStreamer = std::make_unique<SETextureStreamer>(m_GraphicsDevice);
 
 		m_GlobalDescriptorPool = SEDescriptorPool::Builder(m_GraphicsDevice)
-			.set_max_sets(SESwapChain::MAX_FRAMES_IN_FLIGHT)
-			.add_pool_size(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, SESwapChain::MAX_FRAMES_IN_FLIGHT)
+			.set_max_sets(1)
+			.add_pool_size(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1)
 			.build();
 
 		load_game_objects();
@@ -40,34 +48,53 @@ struct FGlobalUniformBufferObject
 
 	SEApp::~SEApp()
 	{
+		// Workers use the cache, so they are stopped first
+		m_AssetStreamer = nullptr;
+		m_MeshCache = nullptr;
+		m_TextureStreamer = nullptr;
 		m_GlobalDescriptorPool = nullptr;
 		m_TimeManager = nullptr;
 	}
 #pragma endregion Lifecycle
 
-void SEApp::run()
+std::unique_ptr<SEDescriptorSetLayout> SEApp::create_global_descriptor_set(VkDescriptorSet& globalDescriptorSet)
 {
-	std::vector<std::unique_ptr<SEBuffer>> uniformBuffers(SESwapChain::MAX_FRAMES_IN_FLIGHT);
-	for (std::unique_ptr<SEBuffer>& uniformBuffer : uniformBuffers)
-	{
-		uniformBuffer = std::make_unique<SEBuffer>(m_GraphicsDevice, sizeof(FGlobalUniformBufferObject), 1, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, m_GraphicsDevice.properties.limits.minUniformBufferOffsetAlignment);
-		uniformBuffer->map();
-	}
-
+	// The global uniforms are written to the frame allocator each frame, one set covers every frame in flight
+	// through its dynamic offset
 	std::unique_ptr<SE::SEDescriptorSetLayout> globalDescriptorSetLayout = SEDescriptorSetLayout::Builder(m_GraphicsDevice)
-		.add_binding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_VERTEX_BIT)
+		.add_binding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, VK_SHADER_STAGE_VERTEX_BIT)
 		.build();
 
-	std::vector<VkDescriptorSet> globalDescriptorSets(SESwapChain::MAX_FRAMES_IN_FLIGHT);
-	for (uint32_t index = 0; index < globalDescriptorSets.size(); index++)
+	VkDescriptorBufferInfo bufferInfo = m_Renderer.get_frame_allocator().get_descriptor_info(sizeof(FGlobalUniformBufferObject));
+	SEDescriptorWriter(*globalDescriptorSetLayout, *m_GlobalDescriptorPool)
+		.write_buffer(0, &bufferInfo)
+		.build(globalDescriptorSet);
+	return globalDescriptorSetLayout;
+}
+
+void SEApp::run()
+{
+	SEFrameAllocator& frameAllocator = m_Renderer.get_frame_allocator();
+	VkDescriptorSet globalDescriptorSet;
+	std::unique_ptr<SEDescriptorSetLayout> globalDescriptorSetLayout = create_global_descriptor_set(globalDescriptorSet);
+
+	SERenderSystem RenderSystem{m_GraphicsDevice, frameAllocator, m_Renderer.get_swap_chain_render_pass(), globalDescriptorSetLayout->get_descriptor_set_layout(), m_TextureStreamer->get_descriptor_set_layout(), m_TextureStreamer->get_default_descriptor_set()};
+	FCullingSettings cullingSettings = RenderSystem.get_culling_settings();
+	cullingSettings.gpuCulling = m_bGpuCulling;
+	RenderSystem.set_culling_settings(cullingSettings);
+	RenderSystem.set_draw_sorting(m_bDrawSorting);
+	if (m_bGpuCulling && !RenderSystem.is_gpu_culling_active())
 	{
-		auto bufferInfo = uniformBuffers[index]->get_descriptor_info();
-		SEDescriptorWriter(*globalDescriptorSetLayout, *m_GlobalDescriptorPool)
-			.write_buffer(0, &bufferInfo)
-			.build(globalDescriptorSets[index]);
+		std::cout << "GPU culling needs VK_KHR_draw_indirect_count, culling on the CPU\n";
 	}
+	// GPU culling keeps the objects on the GPU between frames. They never move, so they are registered once
+	for (const SEGameObject& gameObject : m_GameObjects) { RenderSystem.add_gpu_scene_object(gameObject); }
+	SEParallelRecorder parallelRecorder{m_GraphicsDevice, SESwapChain::MAX_FRAMES_IN_FLIGHT, m_RecordingThreadCount};
 
-	SERenderSystem RenderSystem{m_GraphicsDevice, m_Renderer.get_swap_chain_render_pass(), globalDescriptorSetLayout->get_descriptor_set_layout()};
+	// Warm runs start from the cache the previous run saved, compare against a cold run after deleting it
+	const FPipelineCacheStats pipelineCacheStats = m_GraphicsDevice.get_pipeline_cache().get_stats();
+	std::cout << "Pipelines: " << pipelineCacheStats.pipelinesCreated << " created in " << std::fixed << std::setprecision(2) << pipelineCacheStats.creationMilliseconds << " ms ("
+		<< (pipelineCacheStats.bWarm ? "warm" : "cold") << " cache, " << pipelineCacheStats.loadedBytes / 1024 << " KB loaded)" << std::defaultfloat << '\n';
 	SECamera camera{};
 	SEGameObject viewerObject = SEGameObject::create_game_object();
 	SEKeyboardInputController cameraInputController{};
@@ -92,68 +119,144 @@ void SEApp::run()
 		float aspectRatio = m_Renderer.get_swap_chain_aspect_ratio();
 		camera.set_perspective_projection(glm::radians(60.0f), aspectRatio, 0.01f, 1000.0f);
 
+		m_MeshCache->update(m_FrameNumber);
+		// Swaps in textures whose levels finished loading and queues changes from last frame's screen sizes
+		m_TextureStreamer->update(m_FrameNumber);
+		// Uploads queued since the last frame go out in one submission, ahead of the frame that draws them
+		m_GraphicsDevice.get_staging_ring().flush();
+
 		if (VkCommandBuffer commandBuffer = m_Renderer.begin_frame())
 		{
-			uint32_t currentFrameIndex = m_Renderer.get_current_frame_index();
-			FFrameInfo frameInfo{currentFrameIndex, m_TimeManager->get_delta_time(), commandBuffer, camera, globalDescriptorSets[currentFrameIndex]};
-
 			// update global uniform buffer
+			FFrameAllocation globalUniforms{};
+			if (!frameAllocator.allocate_uniform(sizeof(FGlobalUniformBufferObject), globalUniforms))
+			{
+				throw std::runtime_error("failed to allocate global uniforms!");
+			}
 			FGlobalUniformBufferObject uniformBufferObject{};
 			uniformBufferObject.projectionView = camera.get_projection_matrix() * camera.get_view_matrix();
-			uniformBuffers[currentFrameIndex]->write_to_buffer(&uniformBufferObject);
-			uniformBuffers[currentFrameIndex]->flush();
+			memcpy(globalUniforms.data, &uniformBufferObject, sizeof(uniformBufferObject));
+
+			uint32_t currentFrameIndex = m_Renderer.get_current_frame_index();
+			// The fence begin_frame waited on also covers the secondary command buffers of this frame index
+			parallelRecorder.begin_frame(currentFrameIndex);
+			FFrameInfo frameInfo{currentFrameIndex, m_TimeManager->get_delta_time(), commandBuffer, camera, globalDescriptorSet, m_FrameNumber, static_cast<uint32_t>(globalUniforms.offset), m_Renderer.get_swap_chain_extent()};
 
-			// rendering
-			m_Renderer.begin_swap_chain_render_pass(commandBuffer);
-			RenderSystem.render_game_objects(frameInfo, m_GameObjects);
+			// rendering, the culling dispatch has to run outside the render pass. Draws are recorded on worker threads
+			// into secondary command buffers that the render pass executes
+			RenderSystem.record_gpu_culling(frameInfo);
+			const std::vector<VkCommandBuffer>& secondaryCommandBuffers = RenderSystem.record_game_objects(frameInfo, m_GameObjects, parallelRecorder, m_Renderer.get_swap_chain_render_pass());
+			m_Renderer.begin_swap_chain_render_pass(commandBuffer, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+			vkCmdExecuteCommands(commandBuffer, static_cast<uint32_t>(secondaryCommandBuffers.size()), secondaryCommandBuffers.data());
+			m_RenderStats = RenderSystem.get_render_stats();
+			m_RecordMilliseconds = parallelRecorder.get_record_milliseconds();
+			m_RecordedBufferCount = static_cast<uint32_t>(secondaryCommandBuffers.size());
 			m_Renderer.end_swap_chain_render_pass(commandBuffer);
 			m_Renderer.end_frame();
+			m_FrameNumber++;
 		}
 	}
 	// m_TickCounter++;
 
-	vkDeviceWaitIdle(m_GraphicsDevice.device());
+	m_GraphicsDevice.wait_idle();
+
+	std::cout << '\n';
+	m_GraphicsDevice.get_memory_allocator().print_budget_report(std::cout);
+}
+
+void SEApp::benchmark_draw_submission(const std::string& filepath)
+{
+	VkDescriptorSet globalDescriptorSet;
+	std::unique_ptr<SEDescriptorSetLayout> globalDescriptorSetLayout = create_global_descriptor_set(globalDescriptorSet);
+	SERenderSystem renderSystem{m_GraphicsDevice, m_Renderer.get_frame_allocator(), m_Renderer.get_swap_chain_render_pass(), globalDescriptorSetLayout->get_descriptor_set_layout(), m_TextureStreamer->get_descriptor_set_layout(), m_TextureStreamer->get_default_descriptor_set()};
+
+	std::unique_ptr<SEMesh> mesh = SEMesh::create_model_from_file(m_GraphicsDevice, filepath);
+	m_GraphicsDevice.get_staging_ring().flush();
+
+	renderSystem.benchmark_draw_submission(m_Renderer.get_swap_chain_render_pass(), *mesh, globalDescriptorSet, {1000, 10000, 100000});
+
+	m_GraphicsDevice.get_staging_ring().wait_idle();
+	m_GraphicsDevice.wait_idle();
 }
 
 void SEApp::on_tick()
 {
 	std::ostringstream ss;
 	ss << "\rCurrent Tick Time: " << std::setw(3) << m_TimeManager->get_fixed_time_step()
-		<< "   Current FPS: " << std::setw(3) << m_TimeManager->get_fps()
-		<< "   ";
+		<< "   Current FPS: " << std::setw(3) << m_TimeManager->get_fps();
+
+	const FMeshCacheStats meshCacheStats = m_MeshCache->get_stats();
+	const FMeshStreamingStats meshStreamingStats = m_AssetStreamer->get_stats();
+	ss << "   Meshes: " << meshCacheStats.residentMeshes << " (" << meshCacheStats.residentBytes / (1024 * 1024) << "/" << meshCacheStats.budgetBytes / (1024 * 1024) << " MB)"
+		<< " hit " << meshCacheStats.pathHits + meshCacheStats.contentHits << " miss " << meshCacheStats.misses << " evict " << meshCacheStats.evictions
+		<< " streamed " << meshStreamingStats.loads << " (" << (meshStreamingStats.loads > 0 ? meshStreamingStats.loadMilliseconds / meshStreamingStats.loads : 0.0) << " ms avg, " << meshStreamingStats.failures << " failed)"
+		<< "   Objects: " << m_RenderStats.objectsVisible << "/" << m_RenderStats.objectsVisible + m_RenderStats.objectsCulled << " (" << m_RenderStats.gpuCulledObjects << " GPU culled, " << m_RenderStats.instancesDropped << " dropped)"
+		<< " Draws: " << m_RenderStats.drawCalls << " (" << m_RenderStats.indirectCalls << " indirect calls) State changes: " << m_RenderStats.stateChanges
+		<< " (pipeline " << m_RenderStats.pipelineBinds << " geometry " << m_RenderStats.geometryBinds << " texture " << m_RenderStats.textureBinds << ") Triangles: " << m_RenderStats.trianglesSubmitted
+		<< " Clusters: " << m_RenderStats.clustersVisible << "/" << m_RenderStats.clustersVisible + m_RenderStats.clustersCulled
+		<< " Record: " << std::fixed << std::setprecision(3) << m_RecordMilliseconds << std::defaultfloat << " ms on " << m_RecordedBufferCount << " threads";
+
+	const FTextureStreamingStats textureStats = m_TextureStreamer->get_stats();
+	ss << "   Textures: " << textureStats.textures << " (" << textureStats.residentBytes / (1024 * 1024) << "/" << textureStats.budgetBytes / (1024 * 1024) << " MB, wanted " << textureStats.wantedBytes / (1024 * 1024) << ")"
+		<< " pending " << textureStats.pendingLoads << " up " << textureStats.upgrades << " down " << textureStats.downgrades;
+
+	// Usage of the main device local heap against its budget, then where this process's memory goes
+	const FMemoryBudgetReport memoryReport = m_GraphicsDevice.get_memory_allocator().get_budget_report();
+	const FMemoryHeapBudget& deviceLocalHeap = memoryReport.heaps[memoryReport.deviceLocalHeap];
+	ss << "   GPU: " << deviceLocalHeap.usageBytes / (1024 * 1024) << "/" << deviceLocalHeap.budgetBytes / (1024 * 1024) << " MB (";
+	for (uint32_t categoryIndex = 0; categoryIndex < MEMORY_CATEGORY_COUNT; categoryIndex++)
+	{
+		ss << (categoryIndex > 0 ? " " : "") << get_memory_category_name(static_cast<EMemoryCategory>(categoryIndex)) << " " << memoryReport.categories[categoryIndex].liveBytes / (1024 * 1024);
+	}
+	ss << ")   ";
 	std::cout << ss.str() << std::flush;
 }
 
 void SEApp::load_game_objects()
 {
-	std::shared_ptr<SEMesh> seMesh = SEMesh::create_model_from_file(m_GraphicsDevice, "content/models/starter/sm_gadgetbot.obj");
-	std::shared_ptr<SEMesh> sePlaneMesh = SEMesh::create_model_from_file(m_GraphicsDevice, "content/models/starter/plane.obj");
-	
-	if (seMesh != nullptr)
-	{
-		SEGameObject gameObject = SEGameObject::create_game_object();
-		gameObject.m_Mesh = seMesh;
-		gameObject.m_TransformComponent.Translation = { -0.5f, 0.0f, 0.0f };
-		gameObject.m_TransformComponent.Rotation = { 0.0f, 0.0f, 0.0f };
-		gameObject.m_TransformComponent.Scale = { 0.5f, 0.5f, 0.5f };
-		m_GameObjects.push_back(std::move(gameObject));
-
-		SEGameObject gameObjectTwo = SEGameObject::create_game_object();
-		gameObjectTwo.m_Mesh = seMesh;
-		gameObjectTwo.m_TransformComponent.Translation = { 0.5f, 0.0f, 0.0f };
-		gameObjectTwo.m_TransformComponent.Rotation = { 0.0f, 0.0f, 0.0f };
-		gameObjectTwo.m_TransformComponent.Scale = { 0.7f, 0.7f, 0.7f };
-		m_GameObjects.push_back(std::move(gameObjectTwo));
-	}
+	// Meshes stream in on background threads, objects are drawn once their mesh is resident.
+	// The dense gadgetbot uses the packed vertex format, 20 instead of 44 bytes per vertex
+	std::shared_ptr<SEMeshHandle> seMesh = m_MeshCache->request_mesh("content/models/starter/sm_gadgetbot.obj", EVertexFormat::Packed);
+	std::shared_ptr<SEMeshHandle> sePlaneMesh = m_MeshCache->request_mesh("content/models/starter/plane.obj");
+
+	SEGameObject gameObject = SEGameObject::create_game_object();
+	gameObject.m_Mesh = seMesh;
+	gameObject.m_TransformComponent.Translation = { -0.5f, 0.0f, 0.0f };
+	gameObject.m_TransformComponent.Rotation = { 0.0f, 0.0f, 0.0f };
+	gameObject.m_TransformComponent.Scale = { 0.5f, 0.5f, 0.5f };
+	m_GameObjects.push_back(std::move(gameObject));
+
+	SEGameObject gameObjectTwo = SEGameObject::create_game_object();
+	gameObjectTwo.m_Mesh = seMesh;
+	gameObjectTwo.m_TransformComponent.Translation = { 0.5f, 0.0f, 0.0f };
+	gameObjectTwo.m_TransformComponent.Rotation = { 0.0f, 0.0f, 0.0f };
+	gameObjectTwo.m_TransformComponent.Scale = { 0.7f, 0.7f, 0.7f };
+	m_GameObjects.push_back(std::move(gameObjectTwo));
+
+	SEGameObject gameObjectThree = SEGameObject::create_game_object();
+	gameObjectThree.m_Mesh = sePlaneMesh;
+	gameObjectThree.m_Texture = m_TextureStreamer->add_texture("checker", create_checker_texture(256, 32));
+	gameObjectThree.m_TransformComponent.Translation = { 0.0f, 0.5f, 0.0f };
+	gameObjectThree.m_TransformComponent.Scale = { 5.0f, 1.0f, 5.0f };
+	m_GameObjects.push_back(std::move(gameObjectThree));
+}
 
-	if (sePlaneMesh != nullptr)
+std::unique_ptr<SETexture> SEApp::create_checker_texture(uint32_t extent, uint32_t cellExtent)
+{
+	std::vector<uint8_t> texels(static_cast<size_t>(extent) * extent * SETexture::BYTES_PER_TEXEL);
+	for (uint32_t y = 0; y < extent; y++)
 	{
-		SEGameObject gameObjectThree = SEGameObject::create_game_object();
-		gameObjectThree.m_Mesh = sePlaneMesh;
-		gameObjectThree.m_TransformComponent.Translation = { 0.0f, 0.5f, 0.0f };
-		gameObjectThree.m_TransformComponent.Scale = { 5.0f, 1.0f, 5.0f };
-		m_GameObjects.push_back(std::move(gameObjectThree));
+		for (uint32_t x = 0; x < extent; x++)
+		{
+			const uint8_t value = ((x / cellExtent) + (y / cellExtent)) % 2 == 0 ? 255 : 96;
+			uint8_t* texel = &texels[(static_cast<size_t>(y) * extent + x) * SETexture::BYTES_PER_TEXEL];
+			texel[0] = value;
+			texel[1] = value;
+			texel[2] = value;
+			texel[3] = 255;
+		}
 	}
+	return std::make_unique<SETexture>(m_GraphicsDevice, texels.data(), extent, extent);
 }
 
 } // namespace SE
\ No newline at end of file
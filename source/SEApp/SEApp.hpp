@@ -3,7 +3,11 @@
 #include "SERendering/SEWindow/SEWindow.hpp"
 #include "SERendering/SEGraphicsDevice/SEGraphicsDevice.hpp"
 #include "SERendering/SERenderer.hpp"
+#include "SERendering/SERenderSystems/SERenderSystem.hpp"
 #include "SECore/SEEntities/SEGameObject.hpp"
+#include "SECore/SEAssets/SEAssetStreamer.hpp"
+#include "SECore/SEAssets/SEMeshCache.hpp"
+#include "SECore/SEAssets/SETextureStreamer.hpp"
 #include "SECore/SESystems/SETimeManager.hpp"
 #include "SERendering/SEDescriptorSets/SEDescriptors.hpp"
 
@@ -25,6 +29,14 @@ public:
 
 	void run();
 	void on_tick();
+	// Times recording 1k, 10k and 100k draws of a mesh with direct and indirect submission. Call instead of run
+	void benchmark_draw_submission(const std::string& filepath);
+	// Culls objects in a compute shader instead of on the CPU, where the device supports it. Call before run
+	void set_gpu_culling(bool bGpuCulling) { m_bGpuCulling = bGpuCulling; }
+	// Threads recording draws into secondary command buffers, 0 uses the hardware threads. Call before run
+	void set_recording_thread_count(uint32_t recordingThreadCount) { m_RecordingThreadCount = recordingThreadCount; }
+	// Off draws objects unsorted, to compare the state changes on the stats line. Call before run
+	void set_draw_sorting(bool bDrawSorting) { m_bDrawSorting = bDrawSorting; }
 
 	static constexpr uint32_t m_WindowWidth = 1920;
 	static constexpr uint32_t m_WindowHeight = 1080;
@@ -34,12 +46,26 @@ public:
 private:
 
 	void load_game_objects();
+	// Layout and set of the global uniforms, which live in the renderer's frame allocator
+	std::unique_ptr<SEDescriptorSetLayout> create_global_descriptor_set(VkDescriptorSet& globalDescriptorSet);
+	// Procedural checkerboard with GPU generated mips, for meshes that ship without a texture
+	std::unique_ptr<SETexture> create_checker_texture(uint32_t extent, uint32_t cellExtent);
 
 	SEWindow m_Window{m_WindowWidth, m_WindowHeight, m_WindowName};
 	SEGraphicsDevice m_GraphicsDevice{ m_Window };
 	SERenderer m_Renderer{m_Window, m_GraphicsDevice};
 
 	std::vector<SEGameObject> m_GameObjects;
+	std::unique_ptr<SEAssetStreamer> m_AssetStreamer{};
+	std::unique_ptr<SEMeshCache> m_MeshCache{};
+	std::unique_ptr<SETextureStreamer> m_TextureStreamer{};
+	uint64_t m_FrameNumber{0};
+	FRenderStats m_RenderStats{};	// Copied from the render system after each frame for the stats line
+	bool m_bGpuCulling{false};
+	uint32_t m_RecordingThreadCount{0};
+	bool m_bDrawSorting{true};
+	double m_RecordMilliseconds{0.0};		// Recording of the last frame's secondary command buffers
+	uint32_t m_RecordedBufferCount{0};
 	std::unique_ptr<SEDescriptorPool> m_GlobalDescriptorPool{};
 
 	// Time management
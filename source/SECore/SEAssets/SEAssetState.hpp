@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstdint>
+
+namespace SE {
+
+// Loading state of a streamed asset, shared by mesh and texture handles
+enum class EAssetState : uint8_t
+{
+	Queued,
+	Loading,
+	Resident,
+	Failed,
+	Evicted
+};
+
+} // namespace SE
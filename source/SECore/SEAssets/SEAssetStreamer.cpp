@@ -0,0 +1,140 @@
+#include "SEAssetStreamer.hpp"
+#include "SECore/SEAssets/SEMeshCache.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+namespace SE {
+
+#pragma region Lifecycle
+SEAssetStreamer::SEAssetStreamer(SEGraphicsDevice& graphicsDevice, uint32_t workerCount) : m_GraphicsDevice(graphicsDevice)
+{
+	m_Workers.reserve(workerCount);
+	for (uint32_t workerIndex = 0; workerIndex < std::max(1u, workerCount); workerIndex++)
+	{
+		m_Workers.emplace_back(&SEAssetStreamer::worker_loop, this);
+	}
+}
+
+SEAssetStreamer::~SEAssetStreamer()
+{
+	{
+		std::lock_guard<std::mutex> queueLock{m_QueueMutex};
+		m_IsStopping = true;
+
+		// Requests that never started stay unloaded, meshes that are uploading finish first
+		for (const std::shared_ptr<SEMeshHandle>& handle : m_RequestQueue)
+		{
+			handle->set_state(EAssetState::Failed);
+		}
+		m_PendingCount.fetch_sub(static_cast<uint32_t>(m_RequestQueue.size()), std::memory_order_relaxed);
+		m_RequestQueue.clear();
+	}
+	m_QueueCondition.notify_all();
+
+	for (std::thread& worker : m_Workers)
+	{
+		worker.join();
+	}
+}
+#pragma endregion Lifecycle
+
+std::shared_ptr<SEMeshHandle> SEAssetStreamer::request_mesh(const std::string& filepath, EVertexFormat vertexFormat)
+{
+	std::shared_ptr<SEMeshHandle> handle = std::make_shared<SEMeshHandle>(filepath, vertexFormat);
+	enqueue(handle);
+	return handle;
+}
+
+void SEAssetStreamer::enqueue(const std::shared_ptr<SEMeshHandle>& handle)
+{
+	handle->set_state(EAssetState::Queued);
+	{
+		std::lock_guard<std::mutex> queueLock{m_QueueMutex};
+		m_RequestQueue.push_back(handle);
+		m_PendingCount.fetch_add(1, std::memory_order_relaxed);
+	}
+	m_QueueCondition.notify_one();
+}
+
+void SEAssetStreamer::wait_until_idle()
+{
+	std::unique_lock<std::mutex> queueLock{m_QueueMutex};
+	m_IdleCondition.wait(queueLock, [this]() { return m_PendingCount.load(std::memory_order_relaxed) == 0; });
+}
+
+void SEAssetStreamer::worker_loop()
+{
+	while (true)
+	{
+		std::shared_ptr<SEMeshHandle> handle;
+		{
+			std::unique_lock<std::mutex> queueLock{m_QueueMutex};
+			m_QueueCondition.wait(queueLock, [this]() { return m_IsStopping || !m_RequestQueue.empty(); });
+			if (m_IsStopping) { break; }
+
+			handle = std::move(m_RequestQueue.front());
+			m_RequestQueue.pop_front();
+		}
+
+		handle->set_state(EAssetState::Loading);
+		const auto startTime = std::chrono::steady_clock::now();
+
+		// A null mesh marks the handle as failed
+		handle->set_mesh(load_mesh(handle->get_filepath(), handle->get_vertex_format()));
+
+		const double loadMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+
+		{
+			std::lock_guard<std::mutex> queueLock{m_QueueMutex};
+			if (handle->is_resident())
+			{
+				m_Stats.loads++;
+				m_Stats.loadMilliseconds += loadMilliseconds;
+			}
+			else
+			{
+				m_Stats.failures++;
+			}
+			m_PendingCount.fetch_sub(1, std::memory_order_relaxed);
+		}
+		m_IdleCondition.notify_all();
+	}
+
+	m_GraphicsDevice.release_thread_command_pool();
+}
+
+FMeshStreamingStats SEAssetStreamer::get_stats() const
+{
+	std::lock_guard<std::mutex> queueLock{m_QueueMutex};
+	return m_Stats;
+}
+
+std::shared_ptr<SEMesh> SEAssetStreamer::load_mesh(const std::string& filepath, EVertexFormat vertexFormat)
+{
+	try
+	{
+		SEMesh::FMeshSourceData sourceData{};
+		SEMesh::load_source_data(filepath, sourceData);
+
+		// The content hash is known before the upload, an identical resident mesh skips it entirely
+		if (m_MeshCache != nullptr)
+		{
+			if (std::shared_ptr<SEMesh> residentMesh = m_MeshCache->find_by_content(SEMesh::get_format_content_hash(sourceData.contentHash, vertexFormat)))
+			{
+				return residentMesh;
+			}
+		}
+
+		std::shared_ptr<SEMesh> mesh = std::make_shared<SEMesh>(m_GraphicsDevice, sourceData, vertexFormat);
+		return m_MeshCache != nullptr ? m_MeshCache->add_resident(mesh) : mesh;
+	}
+	catch (const std::exception& exception)
+	{
+		std::cerr << "Failed to stream mesh " << filepath << ": " << exception.what() << '\n';
+		return nullptr;
+	}
+}
+
+} // namespace SE
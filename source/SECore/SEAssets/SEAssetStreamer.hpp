@@ -0,0 +1,71 @@
+#pragma once
+
+#include "SECore/SEAssets/SEMeshHandle.hpp"
+#include "SERendering/SEGraphicsDevice/SEGraphicsDevice.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace SE {
+
+class SEMeshCache;
+
+struct FMeshStreamingStats {
+	uint64_t loads = 0;					// Requests that left a resident mesh
+	uint64_t failures = 0;
+	double loadMilliseconds = 0.0;		// Worker time spent on the successful loads
+};
+
+// Loads meshes on background threads. request_mesh returns a handle immediately, a worker parses the asset
+// (or maps the cooked file) and uploads it with its own command pool, then publishes the mesh on the handle
+class SEAssetStreamer {
+
+public:
+#pragma region Lifecycle
+	SEAssetStreamer(SEGraphicsDevice& graphicsDevice, uint32_t workerCount = DEFAULT_WORKER_COUNT);
+	~SEAssetStreamer();
+	SEAssetStreamer(const SEAssetStreamer&) = delete;
+	SEAssetStreamer& operator=(const SEAssetStreamer&) = delete;
+#pragma endregion Lifecycle
+
+	std::shared_ptr<SEMeshHandle> request_mesh(const std::string& filepath, EVertexFormat vertexFormat = EVertexFormat::Full);
+	// Queues an existing handle, used to bring evicted meshes back
+	void enqueue(const std::shared_ptr<SEMeshHandle>& handle);
+
+	// With a cache set, workers reuse resident meshes with equal content instead of uploading a copy
+	void set_mesh_cache(SEMeshCache* meshCache) { m_MeshCache = meshCache; }
+
+	// Requests that are queued or loading
+	uint32_t get_pending_count() const { return m_PendingCount.load(std::memory_order_relaxed); }
+	FMeshStreamingStats get_stats() const;
+
+	// Blocks until every request made so far has finished, used where content must be resident (benchmarks, tools)
+	void wait_until_idle();
+
+	// Uploads serialize on the graphics queue, so more workers mostly help with parsing
+	static constexpr uint32_t DEFAULT_WORKER_COUNT = 2;
+
+private:
+	void worker_loop();
+	std::shared_ptr<SEMesh> load_mesh(const std::string& filepath, EVertexFormat vertexFormat);
+
+	SEGraphicsDevice& m_GraphicsDevice;
+	SEMeshCache* m_MeshCache{nullptr};
+	std::vector<std::thread> m_Workers;
+
+	mutable std::mutex m_QueueMutex;
+	std::condition_variable m_QueueCondition;
+	std::condition_variable m_IdleCondition;
+	std::deque<std::shared_ptr<SEMeshHandle>> m_RequestQueue;
+	std::atomic<uint32_t> m_PendingCount{0};
+	bool m_IsStopping{false};
+	FMeshStreamingStats m_Stats{};		// Guarded by m_QueueMutex
+};
+
+} // namespace SE
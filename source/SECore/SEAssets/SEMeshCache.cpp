@@ -0,0 +1,160 @@
+#include "SEMeshCache.hpp"
+#include "SERendering/SERenderPipeline/SESwapChain.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <vector>
+
+namespace SE {
+
+#pragma region Lifecycle
+SEMeshCache::SEMeshCache(SEAssetStreamer& assetStreamer, VkDeviceSize budgetBytes) : m_AssetStreamer(assetStreamer)
+{
+	m_Stats.budgetBytes = budgetBytes;
+	m_AssetStreamer.set_mesh_cache(this);
+}
+
+SEMeshCache::~SEMeshCache()
+{
+	m_AssetStreamer.set_mesh_cache(nullptr);
+}
+#pragma endregion Lifecycle
+
+std::string SEMeshCache::normalize_path(const std::string& filepath)
+{
+	return std::filesystem::path(filepath).lexically_normal().generic_string();
+}
+
+std::shared_ptr<SEMeshHandle> SEMeshCache::request_mesh(const std::string& filepath, EVertexFormat vertexFormat)
+{
+	const std::string normalizedPath = normalize_path(filepath);
+	std::shared_ptr<SEMeshHandle> handle;
+	{
+		std::lock_guard<std::mutex> cacheLock{m_CacheMutex};
+		std::shared_ptr<SEMeshHandle>& pathEntry = m_PathEntries[normalizedPath + '#' + std::to_string(static_cast<uint32_t>(vertexFormat))];
+		if (pathEntry != nullptr)
+		{
+			m_Stats.pathHits++;
+			return pathEntry;
+		}
+
+		pathEntry = std::make_shared<SEMeshHandle>(normalizedPath, vertexFormat);
+		pathEntry->mark_used(m_CurrentFrame);
+		handle = pathEntry;
+	}
+
+	m_AssetStreamer.enqueue(handle);
+	return handle;
+}
+
+std::shared_ptr<SEMesh> SEMeshCache::find_by_content(uint64_t contentHash)
+{
+	std::lock_guard<std::mutex> cacheLock{m_CacheMutex};
+	auto contentEntry = m_ContentEntries.find(contentHash);
+	if (contentEntry == m_ContentEntries.end())
+	{
+		m_Stats.misses++;
+		return nullptr;
+	}
+
+	// Counts as a use so the mesh is not evicted before the new handle publishes it
+	contentEntry->second.lastUsedFrame = m_CurrentFrame;
+	m_Stats.contentHits++;
+	return contentEntry->second.mesh;
+}
+
+std::shared_ptr<SEMesh> SEMeshCache::add_resident(const std::shared_ptr<SEMesh>& mesh)
+{
+	std::lock_guard<std::mutex> cacheLock{m_CacheMutex};
+	auto [contentEntry, bInserted] = m_ContentEntries.try_emplace(mesh->get_content_hash(), FContentEntry{mesh, m_CurrentFrame});
+	if (bInserted)
+	{
+		m_Stats.residentMeshes++;
+		m_Stats.residentBytes += mesh->get_resident_bytes();
+	}
+	contentEntry->second.lastUsedFrame = m_CurrentFrame;
+	return contentEntry->second.mesh;
+}
+
+void SEMeshCache::update(uint64_t frameNumber)
+{
+	std::lock_guard<std::mutex> cacheLock{m_CacheMutex};
+	m_CurrentFrame = frameNumber;
+
+	for (const auto& [path, handle] : m_PathEntries)
+	{
+		// Evicted meshes that a frame wanted to draw come back through the streamer
+		if (handle->get_state() == EAssetState::Evicted && handle->get_last_used_frame() + 1 >= frameNumber)
+		{
+			m_Stats.reloads++;
+			m_AssetStreamer.enqueue(handle);
+			continue;
+		}
+
+		SEMesh* mesh = handle->get_mesh();
+		if (mesh == nullptr) { continue; }
+
+		// A worker can publish a shared mesh just after its entry was evicted, such meshes are tracked again here
+		auto contentEntry = m_ContentEntries.find(mesh->get_content_hash());
+		if (contentEntry == m_ContentEntries.end())
+		{
+			contentEntry = m_ContentEntries.emplace(mesh->get_content_hash(), FContentEntry{handle->get_shared_mesh(), frameNumber}).first;
+			m_Stats.residentMeshes++;
+			m_Stats.residentBytes += mesh->get_resident_bytes();
+		}
+		contentEntry->second.lastUsedFrame = std::max(contentEntry->second.lastUsedFrame, handle->get_last_used_frame());
+	}
+
+	if (m_Stats.residentBytes <= m_Stats.budgetBytes) { return; }
+
+	// Frames up to MAX_FRAMES_IN_FLIGHT back may still be executing on the GPU
+	std::vector<std::pair<uint64_t, uint64_t>> evictionCandidates;
+	for (const auto& [contentHash, contentEntry] : m_ContentEntries)
+	{
+		if (contentEntry.lastUsedFrame + SESwapChain::MAX_FRAMES_IN_FLIGHT < frameNumber)
+		{
+			evictionCandidates.emplace_back(contentEntry.lastUsedFrame, contentHash);
+		}
+	}
+	std::sort(evictionCandidates.begin(), evictionCandidates.end());
+
+	for (const auto& [lastUsedFrame, contentHash] : evictionCandidates)
+	{
+		if (m_Stats.residentBytes <= m_Stats.budgetBytes) { break; }
+		evict_content(contentHash);
+	}
+}
+
+void SEMeshCache::evict_content(uint64_t contentHash)
+{
+	auto contentEntry = m_ContentEntries.find(contentHash);
+	if (contentEntry == m_ContentEntries.end()) { return; }
+
+	const SEMesh* mesh = contentEntry->second.mesh.get();
+	for (const auto& [path, handle] : m_PathEntries)
+	{
+		if (handle->get_mesh() == mesh)
+		{
+			handle->evict();
+		}
+	}
+
+	m_Stats.evictions++;
+	m_Stats.residentMeshes--;
+	m_Stats.residentBytes -= mesh->get_resident_bytes();
+	m_ContentEntries.erase(contentEntry);
+}
+
+void SEMeshCache::set_budget_bytes(VkDeviceSize budgetBytes)
+{
+	std::lock_guard<std::mutex> cacheLock{m_CacheMutex};
+	m_Stats.budgetBytes = budgetBytes;
+}
+
+FMeshCacheStats SEMeshCache::get_stats() const
+{
+	std::lock_guard<std::mutex> cacheLock{m_CacheMutex};
+	return m_Stats;
+}
+
+} // namespace SE
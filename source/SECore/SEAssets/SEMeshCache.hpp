@@ -0,0 +1,74 @@
+#pragma once
+
+#include "SECore/SEAssets/SEAssetStreamer.hpp"
+#include "SECore/SEAssets/SEMeshHandle.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace SE {
+
+struct FMeshCacheStats {
+	uint64_t pathHits = 0;		// request for a path that already has a handle
+	uint64_t contentHits = 0;	// different path, identical vertex and index data already resident
+	uint64_t misses = 0;
+	uint64_t evictions = 0;
+	uint64_t reloads = 0;		// evicted meshes that were wanted again
+	uint32_t residentMeshes = 0;
+	VkDeviceSize residentBytes = 0;
+	VkDeviceSize budgetBytes = 0;
+};
+
+// Shares meshes between everything that requests them. Handles are deduplicated by normalized path, the
+// streamer asks the cache for resident meshes with the same content hash before uploading. Resident bytes are
+// tracked per unique mesh and the least recently used meshes are evicted once the budget is exceeded
+class SEMeshCache {
+
+public:
+#pragma region Lifecycle
+	SEMeshCache(SEAssetStreamer& assetStreamer, VkDeviceSize budgetBytes = DEFAULT_BUDGET_BYTES);
+	~SEMeshCache();
+	SEMeshCache(const SEMeshCache&) = delete;
+	SEMeshCache& operator=(const SEMeshCache&) = delete;
+#pragma endregion Lifecycle
+
+	std::shared_ptr<SEMeshHandle> request_mesh(const std::string& filepath, EVertexFormat vertexFormat = EVertexFormat::Full);
+
+	// Called by streaming workers. Returns a resident mesh with the given content hash, or nullptr
+	std::shared_ptr<SEMesh> find_by_content(uint64_t contentHash);
+	// Called by streaming workers after an upload. Returns the mesh to publish, which is an earlier mesh when
+	// another worker finished identical content first
+	std::shared_ptr<SEMesh> add_resident(const std::shared_ptr<SEMesh>& mesh);
+
+	// Main thread, once per frame before recording. Requeues evicted meshes that were wanted last frame and
+	// evicts least recently used meshes while over budget. Meshes used by frames in flight are never evicted
+	void update(uint64_t frameNumber);
+
+	void set_budget_bytes(VkDeviceSize budgetBytes);
+	FMeshCacheStats get_stats() const;
+
+	static constexpr VkDeviceSize DEFAULT_BUDGET_BYTES = 512ull * 1024 * 1024;
+
+private:
+	struct FContentEntry {
+		std::shared_ptr<SEMesh> mesh;
+		uint64_t lastUsedFrame;
+	};
+
+	static std::string normalize_path(const std::string& filepath);
+	void evict_content(uint64_t contentHash);
+
+	SEAssetStreamer& m_AssetStreamer;
+
+	mutable std::mutex m_CacheMutex;
+	// Keyed by normalized path plus vertex format
+	std::unordered_map<std::string, std::shared_ptr<SEMeshHandle>> m_PathEntries;
+	std::unordered_map<uint64_t, FContentEntry> m_ContentEntries;
+	uint64_t m_CurrentFrame{0};
+	FMeshCacheStats m_Stats{};
+};
+
+} // namespace SE
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "SECore/SEAssets/SEAssetState.hpp"
+#include "SECore/SEComponents/SEMesh.hpp"
+
+#include <atomic>
+#include <memory>
+#include <string>
+
+namespace SE {
+
+// Shared reference to a mesh that may still be streaming in. The mesh pointer is written once by the loading
+// thread before the state becomes Resident, readers check the state first and never see a partially built mesh
+class SEMeshHandle {
+
+public:
+#pragma region Lifecycle
+	SEMeshHandle(const std::string& filepath, EVertexFormat vertexFormat = EVertexFormat::Full) : m_Filepath(filepath), m_VertexFormat(vertexFormat) {}
+	~SEMeshHandle() = default;
+	SEMeshHandle(const SEMeshHandle&) = delete;
+	SEMeshHandle& operator=(const SEMeshHandle&) = delete;
+#pragma endregion Lifecycle
+
+	// Wraps a mesh that was loaded synchronously
+	static std::shared_ptr<SEMeshHandle> create_resident(const std::string& filepath, std::shared_ptr<SEMesh> mesh)
+	{
+		std::shared_ptr<SEMeshHandle> handle = std::make_shared<SEMeshHandle>(filepath);
+		handle->set_mesh(std::move(mesh));
+		return handle;
+	}
+
+	EAssetState get_state() const { return m_State.load(std::memory_order_acquire); }
+	bool is_resident() const { return get_state() == EAssetState::Resident; }
+	const std::string& get_filepath() const { return m_Filepath; }
+	EVertexFormat get_vertex_format() const { return m_VertexFormat; }
+
+	// Returns the mesh once it is resident, nullptr while it is loading, evicted or when loading failed
+	SEMesh* get_mesh() const { return is_resident() ? m_Mesh.get() : nullptr; }
+	std::shared_ptr<SEMesh> get_shared_mesh() const { return is_resident() ? m_Mesh : nullptr; }
+
+	void set_state(EAssetState state) { m_State.store(state, std::memory_order_release); }
+
+	// Frame number of the last frame that wanted to draw the mesh, drives least recently used eviction
+	void mark_used(uint64_t frameNumber) { m_LastUsedFrame.store(frameNumber, std::memory_order_relaxed); }
+	uint64_t get_last_used_frame() const { return m_LastUsedFrame.load(std::memory_order_relaxed); }
+
+	// Drops the mesh reference. Only call once no frame in flight uses the mesh
+	void evict()
+	{
+		set_state(EAssetState::Evicted);
+		m_Mesh = nullptr;
+	}
+
+	// Publishes the mesh, a null mesh marks the handle as failed
+	void set_mesh(std::shared_ptr<SEMesh> mesh)
+	{
+		const bool bResident = mesh != nullptr;
+		m_Mesh = std::move(mesh);
+		set_state(bResident ? EAssetState::Resident : EAssetState::Failed);
+	}
+
+private:
+	const std::string m_Filepath;
+	const EVertexFormat m_VertexFormat;
+	std::shared_ptr<SEMesh> m_Mesh{};
+	std::atomic<EAssetState> m_State{EAssetState::Queued};
+	std::atomic<uint64_t> m_LastUsedFrame{0};
+};
+
+} // namespace SE
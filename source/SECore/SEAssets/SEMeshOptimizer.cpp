@@ -0,0 +1,365 @@
+#include "SEMeshOptimizer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace SE {
+
+namespace {
+
+// Forsyth's scoring, the cache is modelled as LRU with 32 entries
+constexpr uint32_t FORSYTH_CACHE_SIZE = 32;
+constexpr uint32_t FORSYTH_VALENCE_TABLE_SIZE = 32;
+constexpr float FORSYTH_CACHE_DECAY_POWER = 1.5f;
+constexpr float FORSYTH_LAST_TRIANGLE_SCORE = 0.75f;
+constexpr float FORSYTH_VALENCE_BOOST_SCALE = 2.0f;
+constexpr float FORSYTH_VALENCE_BOOST_POWER = 0.5f;
+
+struct FVertexScoreTables {
+	float cacheScores[FORSYTH_CACHE_SIZE];
+	float valenceScores[FORSYTH_VALENCE_TABLE_SIZE];
+
+	FVertexScoreTables()
+	{
+		for (uint32_t cachePosition = 0; cachePosition < FORSYTH_CACHE_SIZE; cachePosition++)
+		{
+			// The last triangle's vertices get a fixed score so the next triangle does not just reuse the same edge
+			cacheScores[cachePosition] = cachePosition < 3 ? FORSYTH_LAST_TRIANGLE_SCORE
+				: std::pow(1.0f - static_cast<float>(cachePosition - 3) / (FORSYTH_CACHE_SIZE - 3), FORSYTH_CACHE_DECAY_POWER);
+		}
+
+		valenceScores[0] = 0.0f;
+		for (uint32_t liveTriangles = 1; liveTriangles < FORSYTH_VALENCE_TABLE_SIZE; liveTriangles++)
+		{
+			valenceScores[liveTriangles] = FORSYTH_VALENCE_BOOST_SCALE * std::pow(static_cast<float>(liveTriangles), -FORSYTH_VALENCE_BOOST_POWER);
+		}
+	}
+};
+
+const FVertexScoreTables VERTEX_SCORE_TABLES{};
+
+// Vertices with few remaining triangles score higher so lone triangles are not left behind for later
+float get_vertex_score(int32_t cachePosition, uint32_t liveTriangles)
+{
+	if (liveTriangles == 0) { return -1.0f; }
+
+	float score = cachePosition >= 0 ? VERTEX_SCORE_TABLES.cacheScores[cachePosition] : 0.0f;
+	score += liveTriangles < FORSYTH_VALENCE_TABLE_SIZE ? VERTEX_SCORE_TABLES.valenceScores[liveTriangles]
+		: FORSYTH_VALENCE_BOOST_SCALE * std::pow(static_cast<float>(liveTriangles), -FORSYTH_VALENCE_BOOST_POWER);
+	return score;
+}
+
+// FIFO cache simulation with timestamps, a vertex is cached while fewer than cacheSize misses happened since its own
+struct FCacheSimulation {
+	std::vector<uint32_t> timestamps;
+	uint32_t cacheSize;
+	uint32_t time;
+
+	FCacheSimulation(uint32_t vertexCount, uint32_t simulatedCacheSize) : timestamps(vertexCount, 0), cacheSize(simulatedCacheSize), time(simulatedCacheSize + 1) {}
+
+	uint32_t add_triangle(const uint32_t* triangle)
+	{
+		uint32_t misses = 0;
+		for (uint32_t corner = 0; corner < 3; corner++)
+		{
+			if (time - timestamps[triangle[corner]] > cacheSize)
+			{
+				timestamps[triangle[corner]] = time++;
+				misses++;
+			}
+		}
+		return misses;
+	}
+
+	void flush() { time += cacheSize + 1; }
+};
+
+} // namespace
+
+void SEMeshOptimizer::optimize_vertex_cache(uint32_t* indices, uint32_t indexCount, uint32_t vertexCount)
+{
+	const uint32_t triangleCount = indexCount / 3;
+	if (triangleCount == 0 || vertexCount == 0) { return; }
+
+	// Triangle adjacency per vertex. The first liveTriangles entries of a vertex's range are the triangles not yet emitted
+	std::vector<uint32_t> liveTriangles(vertexCount, 0);
+	for (uint32_t index = 0; index < triangleCount * 3; index++)
+	{
+		liveTriangles[indices[index]]++;
+	}
+
+	std::vector<uint32_t> adjacencyOffsets(vertexCount, 0);
+	std::exclusive_scan(liveTriangles.begin(), liveTriangles.end(), adjacencyOffsets.begin(), 0u);
+
+	std::vector<uint32_t> adjacency(triangleCount * 3);
+	{
+		std::vector<uint32_t> fillCounts(vertexCount, 0);
+		for (uint32_t index = 0; index < triangleCount * 3; index++)
+		{
+			const uint32_t vertex = indices[index];
+			adjacency[adjacencyOffsets[vertex] + fillCounts[vertex]++] = index / 3;
+		}
+	}
+
+	std::vector<int32_t> cachePositions(vertexCount, -1);
+	std::vector<float> vertexScores(vertexCount);
+	for (uint32_t vertex = 0; vertex < vertexCount; vertex++)
+	{
+		vertexScores[vertex] = get_vertex_score(-1, liveTriangles[vertex]);
+	}
+
+	std::vector<float> triangleScores(triangleCount);
+	std::vector<bool> emittedTriangles(triangleCount, false);
+	uint32_t bestTriangle = 0;
+	for (uint32_t triangle = 0; triangle < triangleCount; triangle++)
+	{
+		const uint32_t* corners = &indices[triangle * 3];
+		triangleScores[triangle] = vertexScores[corners[0]] + vertexScores[corners[1]] + vertexScores[corners[2]];
+		if (triangleScores[triangle] > triangleScores[bestTriangle]) { bestTriangle = triangle; }
+	}
+
+	std::vector<uint32_t> output(triangleCount * 3);
+	uint32_t cache[FORSYTH_CACHE_SIZE + 3];
+	uint32_t newCache[FORSYTH_CACHE_SIZE + 3];
+	uint32_t cacheCount = 0;
+	uint32_t inputCursor = 0;
+
+	for (uint32_t outputTriangle = 0; outputTriangle < triangleCount; outputTriangle++)
+	{
+		// Nothing in the cache has live triangles left, continue with the next triangle in input order
+		if (bestTriangle == UNUSED_VERTEX)
+		{
+			while (emittedTriangles[inputCursor]) { inputCursor++; }
+			bestTriangle = inputCursor;
+		}
+
+		const uint32_t triangleCorners[3] = { indices[bestTriangle * 3 + 0], indices[bestTriangle * 3 + 1], indices[bestTriangle * 3 + 2] };
+		std::copy(triangleCorners, triangleCorners + 3, &output[outputTriangle * 3]);
+		emittedTriangles[bestTriangle] = true;
+
+		uint32_t newCacheCount = 0;
+		for (uint32_t corner = 0; corner < 3; corner++)
+		{
+			const uint32_t vertex = triangleCorners[corner];
+
+			uint32_t* adjacencyBegin = &adjacency[adjacencyOffsets[vertex]];
+			uint32_t* adjacencyEnd = adjacencyBegin + liveTriangles[vertex];
+			uint32_t* emittedEntry = std::find(adjacencyBegin, adjacencyEnd, bestTriangle);
+			std::swap(*emittedEntry, *(adjacencyEnd - 1));
+			liveTriangles[vertex]--;
+
+			// Degenerate triangles name a vertex more than once, it still takes one cache entry
+			if (std::find(newCache, newCache + newCacheCount, vertex) == newCache + newCacheCount)
+			{
+				newCache[newCacheCount++] = vertex;
+			}
+		}
+
+		for (uint32_t cacheIndex = 0; cacheIndex < cacheCount; cacheIndex++)
+		{
+			const uint32_t vertex = cache[cacheIndex];
+			if (vertex != triangleCorners[0] && vertex != triangleCorners[1] && vertex != triangleCorners[2])
+			{
+				newCache[newCacheCount++] = vertex;
+			}
+		}
+
+		// Entries past the cache size fall out, their score drops to the valence term
+		for (uint32_t cacheIndex = FORSYTH_CACHE_SIZE; cacheIndex < newCacheCount; cacheIndex++)
+		{
+			cachePositions[newCache[cacheIndex]] = -1;
+		}
+
+		for (uint32_t cacheIndex = 0; cacheIndex < newCacheCount; cacheIndex++)
+		{
+			const uint32_t vertex = newCache[cacheIndex];
+			if (cacheIndex < FORSYTH_CACHE_SIZE) { cachePositions[vertex] = static_cast<int32_t>(cacheIndex); }
+
+			const float vertexScore = get_vertex_score(cachePositions[vertex], liveTriangles[vertex]);
+			const float scoreDelta = vertexScore - vertexScores[vertex];
+			vertexScores[vertex] = vertexScore;
+
+			const uint32_t* adjacencyBegin = &adjacency[adjacencyOffsets[vertex]];
+			for (const uint32_t* triangle = adjacencyBegin; triangle != adjacencyBegin + liveTriangles[vertex]; triangle++)
+			{
+				triangleScores[*triangle] += scoreDelta;
+			}
+		}
+
+		// Only triangles touching the cache changed score, the next triangle is picked among them
+		bestTriangle = UNUSED_VERTEX;
+		float bestScore = -1.0f;
+		for (uint32_t cacheIndex = 0; cacheIndex < newCacheCount; cacheIndex++)
+		{
+			const uint32_t vertex = newCache[cacheIndex];
+			const uint32_t* adjacencyBegin = &adjacency[adjacencyOffsets[vertex]];
+			for (const uint32_t* triangle = adjacencyBegin; triangle != adjacencyBegin + liveTriangles[vertex]; triangle++)
+			{
+				if (triangleScores[*triangle] > bestScore)
+				{
+					bestScore = triangleScores[*triangle];
+					bestTriangle = *triangle;
+				}
+			}
+		}
+
+		cacheCount = std::min(newCacheCount, FORSYTH_CACHE_SIZE);
+		std::copy(newCache, newCache + cacheCount, cache);
+	}
+
+	std::copy(output.begin(), output.end(), indices);
+}
+
+void SEMeshOptimizer::optimize_overdraw(uint32_t* indices, uint32_t indexCount, const float* positions, size_t positionStride, uint32_t vertexCount, float threshold)
+{
+	const uint32_t triangleCount = indexCount / 3;
+	if (triangleCount == 0 || vertexCount == 0) { return; }
+
+	const uint8_t* positionBytes = reinterpret_cast<const uint8_t*>(positions);
+	auto get_position = [positionBytes, positionStride](uint32_t vertex) { return reinterpret_cast<const float*>(positionBytes + vertex * positionStride); };
+
+	// Hard boundaries, triangles that miss on all three vertices start a new strip anyway
+	std::vector<uint32_t> hardClusters{};
+	{
+		FCacheSimulation cacheSimulation{vertexCount, SIMULATED_CACHE_SIZE};
+		for (uint32_t triangle = 0; triangle < triangleCount; triangle++)
+		{
+			if (cacheSimulation.add_triangle(&indices[triangle * 3]) == 3) { hardClusters.push_back(triangle); }
+		}
+	}
+	if (hardClusters.empty() || hardClusters[0] != 0) { hardClusters.insert(hardClusters.begin(), 0); }
+
+	// Soft boundaries, a hard cluster is split once the triangles since the last split reach the cluster's own miss ratio
+	// within threshold, so a fresh cache at the split costs little
+	std::vector<uint32_t> clusters{};
+	FCacheSimulation cacheSimulation{vertexCount, SIMULATED_CACHE_SIZE};
+	for (size_t hardCluster = 0; hardCluster < hardClusters.size(); hardCluster++)
+	{
+		const uint32_t clusterBegin = hardClusters[hardCluster];
+		const uint32_t clusterEnd = hardCluster + 1 < hardClusters.size() ? hardClusters[hardCluster + 1] : triangleCount;
+
+		cacheSimulation.flush();
+		uint32_t clusterMisses = 0;
+		for (uint32_t triangle = clusterBegin; triangle < clusterEnd; triangle++)
+		{
+			clusterMisses += cacheSimulation.add_triangle(&indices[triangle * 3]);
+		}
+		const float clusterThreshold = threshold * static_cast<float>(clusterMisses) / static_cast<float>(clusterEnd - clusterBegin);
+
+		clusters.push_back(clusterBegin);
+		cacheSimulation.flush();
+		uint32_t runningMisses = 0;
+		uint32_t runningTriangles = 0;
+		for (uint32_t triangle = clusterBegin; triangle < clusterEnd; triangle++)
+		{
+			runningMisses += cacheSimulation.add_triangle(&indices[triangle * 3]);
+			runningTriangles++;
+
+			if (triangle + 1 < clusterEnd && static_cast<float>(runningMisses) <= clusterThreshold * static_cast<float>(runningTriangles))
+			{
+				clusters.push_back(triangle + 1);
+				cacheSimulation.flush();
+				runningMisses = 0;
+				runningTriangles = 0;
+			}
+		}
+	}
+
+	// Area weighted centroid and normal per cluster
+	const size_t clusterCount = clusters.size();
+	float meshCentroid[3] = { 0.0f, 0.0f, 0.0f };
+	for (uint32_t vertex = 0; vertex < vertexCount; vertex++)
+	{
+		const float* position = get_position(vertex);
+		meshCentroid[0] += position[0];
+		meshCentroid[1] += position[1];
+		meshCentroid[2] += position[2];
+	}
+	for (float& component : meshCentroid) { component /= static_cast<float>(vertexCount); }
+
+	std::vector<float> sortKeys(clusterCount);
+	for (size_t cluster = 0; cluster < clusterCount; cluster++)
+	{
+		const uint32_t clusterBegin = clusters[cluster];
+		const uint32_t clusterEnd = cluster + 1 < clusterCount ? clusters[cluster + 1] : triangleCount;
+
+		float centroid[3] = { 0.0f, 0.0f, 0.0f };
+		float normal[3] = { 0.0f, 0.0f, 0.0f };
+		float clusterArea = 0.0f;
+		for (uint32_t triangle = clusterBegin; triangle < clusterEnd; triangle++)
+		{
+			const float* p0 = get_position(indices[triangle * 3 + 0]);
+			const float* p1 = get_position(indices[triangle * 3 + 1]);
+			const float* p2 = get_position(indices[triangle * 3 + 2]);
+
+			const float edge1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+			const float edge2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+			const float cross[3] = { edge1[1] * edge2[2] - edge1[2] * edge2[1], edge1[2] * edge2[0] - edge1[0] * edge2[2], edge1[0] * edge2[1] - edge1[1] * edge2[0] };
+			const float area = std::sqrt(cross[0] * cross[0] + cross[1] * cross[1] + cross[2] * cross[2]);
+
+			for (uint32_t axis = 0; axis < 3; axis++)
+			{
+				centroid[axis] += (p0[axis] + p1[axis] + p2[axis]) / 3.0f * area;
+				normal[axis] += cross[axis];
+			}
+			clusterArea += area;
+		}
+
+		const float inverseArea = clusterArea > 0.0f ? 1.0f / clusterArea : 0.0f;
+		const float normalLength = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+		const float inverseNormalLength = normalLength > 0.0f ? 1.0f / normalLength : 0.0f;
+
+		float sortKey = 0.0f;
+		for (uint32_t axis = 0; axis < 3; axis++)
+		{
+			sortKey += (centroid[axis] * inverseArea - meshCentroid[axis]) * normal[axis] * inverseNormalLength;
+		}
+		sortKeys[cluster] = sortKey;
+	}
+
+	// Clusters far out along their normal occlude the rest of the mesh from most views, they go first
+	std::vector<uint32_t> clusterOrder(clusterCount);
+	std::iota(clusterOrder.begin(), clusterOrder.end(), 0u);
+	std::stable_sort(clusterOrder.begin(), clusterOrder.end(), [&sortKeys](uint32_t left, uint32_t right) { return sortKeys[left] > sortKeys[right]; });
+
+	std::vector<uint32_t> output{};
+	output.reserve(triangleCount * 3);
+	for (uint32_t cluster : clusterOrder)
+	{
+		const uint32_t clusterBegin = clusters[cluster];
+		const uint32_t clusterEnd = cluster + 1 < clusterCount ? clusters[cluster + 1] : triangleCount;
+		output.insert(output.end(), indices + clusterBegin * 3, indices + clusterEnd * 3);
+	}
+
+	std::copy(output.begin(), output.end(), indices);
+}
+
+uint32_t SEMeshOptimizer::build_vertex_fetch_remap(const uint32_t* indices, uint32_t indexCount, uint32_t vertexCount, std::vector<uint32_t>& remap)
+{
+	remap.assign(vertexCount, UNUSED_VERTEX);
+
+	uint32_t nextVertex = 0;
+	for (uint32_t index = 0; index < indexCount; index++)
+	{
+		uint32_t& remappedVertex = remap[indices[index]];
+		if (remappedVertex == UNUSED_VERTEX) { remappedVertex = nextVertex++; }
+	}
+	return nextVertex;
+}
+
+float SEMeshOptimizer::compute_acmr(const uint32_t* indices, uint32_t indexCount, uint32_t vertexCount, uint32_t cacheSize)
+{
+	const uint32_t triangleCount = indexCount / 3;
+	if (triangleCount == 0) { return 0.0f; }
+
+	FCacheSimulation cacheSimulation{vertexCount, cacheSize};
+	uint32_t misses = 0;
+	for (uint32_t triangle = 0; triangle < triangleCount; triangle++)
+	{
+		misses += cacheSimulation.add_triangle(&indices[triangle * 3]);
+	}
+	return static_cast<float>(misses) / static_cast<float>(triangleCount);
+}
+
+} // namespace SE
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace SE {
+
+// Index and vertex reordering for triangle lists. Runs once per asset before cooking, so the cooked file and the GPU
+// buffers already hold the optimized order. Every pass keeps the set of triangles and their winding
+class SEMeshOptimizer {
+
+public:
+	// Reorders triangles so vertices are reused while still in the post-transform cache (Forsyth, linear speed)
+	static void optimize_vertex_cache(uint32_t* indices, uint32_t indexCount, uint32_t vertexCount);
+
+	// Reorders clusters of a cache optimized index list so outward facing clusters draw first, which lets early depth
+	// reject more of what is behind them. Clusters are only split where the cache miss ratio stays within threshold
+	static void optimize_overdraw(uint32_t* indices, uint32_t indexCount, const float* positions, size_t positionStride, uint32_t vertexCount, float threshold = DEFAULT_OVERDRAW_THRESHOLD);
+
+	// Builds a remap that numbers vertices in the order the index list first references them, so vertex fetch walks
+	// the vertex buffer forward. Unreferenced vertices map to UNUSED_VERTEX. Returns the referenced vertex count
+	static uint32_t build_vertex_fetch_remap(const uint32_t* indices, uint32_t indexCount, uint32_t vertexCount, std::vector<uint32_t>& remap);
+
+	// Average cache miss ratio, post-transform cache misses per triangle of a simulated FIFO cache. 3 is the worst case,
+	// well ordered meshes get close to 0.5
+	static float compute_acmr(const uint32_t* indices, uint32_t indexCount, uint32_t vertexCount, uint32_t cacheSize = SIMULATED_CACHE_SIZE);
+
+	static constexpr uint32_t UNUSED_VERTEX = 0xFFFFFFFFu;
+	static constexpr uint32_t SIMULATED_CACHE_SIZE = 16;
+	static constexpr float DEFAULT_OVERDRAW_THRESHOLD = 1.05f;
+};
+
+} // namespace SE
@@ -0,0 +1,292 @@
+#include "SEMeshSimplifier.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <unordered_set>
+
+namespace SE {
+
+namespace {
+
+struct FVector3 {
+	float x, y, z;
+};
+
+FVector3 subtract(const FVector3& left, const FVector3& right) { return { left.x - right.x, left.y - right.y, left.z - right.z }; }
+FVector3 cross(const FVector3& left, const FVector3& right) { return { left.y * right.z - left.z * right.y, left.z * right.x - left.x * right.z, left.x * right.y - left.y * right.x }; }
+float dot(const FVector3& left, const FVector3& right) { return left.x * right.x + left.y * right.y + left.z * right.z; }
+
+// Sum of squared distances to a set of planes, weighted by triangle area. Symmetric matrix A, vector b and constant c
+struct FQuadric {
+	double a00 = 0, a01 = 0, a02 = 0, a11 = 0, a12 = 0, a22 = 0;
+	double b0 = 0, b1 = 0, b2 = 0;
+	double c = 0;
+	double weight = 0;
+
+	void add_plane(const FVector3& normal, float distance, float planeWeight)
+	{
+		a00 += planeWeight * normal.x * normal.x;
+		a01 += planeWeight * normal.x * normal.y;
+		a02 += planeWeight * normal.x * normal.z;
+		a11 += planeWeight * normal.y * normal.y;
+		a12 += planeWeight * normal.y * normal.z;
+		a22 += planeWeight * normal.z * normal.z;
+		b0 += planeWeight * normal.x * distance;
+		b1 += planeWeight * normal.y * distance;
+		b2 += planeWeight * normal.z * distance;
+		c += planeWeight * distance * distance;
+		weight += planeWeight;
+	}
+
+	void add(const FQuadric& other)
+	{
+		a00 += other.a00; a01 += other.a01; a02 += other.a02;
+		a11 += other.a11; a12 += other.a12; a22 += other.a22;
+		b0 += other.b0; b1 += other.b1; b2 += other.b2;
+		c += other.c;
+		weight += other.weight;
+	}
+
+	// Mean squared distance of a point to the planes
+	float evaluate(const FVector3& point) const
+	{
+		const double x = point.x, y = point.y, z = point.z;
+		const double error = a00 * x * x + a11 * y * y + a22 * z * z + 2.0 * (a01 * x * y + a02 * x * z + a12 * y * z)
+			+ 2.0 * (b0 * x + b1 * y + b2 * z) + c;
+		return weight > 0.0 ? static_cast<float>(std::max(error, 0.0) / weight) : 0.0f;
+	}
+};
+
+struct FCollapse {
+	uint32_t source;
+	uint32_t target;
+	float error;
+};
+
+// Error of the collapse that would reach the goal, a pass takes every collapse up to this error times the slack
+constexpr float PASS_ERROR_SLACK = 1.5f;
+
+} // namespace
+
+float SEMeshSimplifier::simplify(const uint32_t* indices, uint32_t indexCount, const float* positions, size_t positionStride, uint32_t vertexCount,
+	uint32_t targetIndexCount, float targetError, std::vector<uint32_t>& destination)
+{
+	destination.assign(indices, indices + indexCount - indexCount % 3);
+	if (destination.size() <= targetIndexCount || vertexCount == 0) { return 0.0f; }
+
+	// Positions are normalized to the unit cube so errors do not depend on the mesh scale
+	const uint8_t* positionBytes = reinterpret_cast<const uint8_t*>(positions);
+	std::vector<FVector3> vertexPositions(vertexCount);
+	FVector3 boundsMin{ INFINITY, INFINITY, INFINITY };
+	FVector3 boundsMax{ -INFINITY, -INFINITY, -INFINITY };
+	for (uint32_t vertex = 0; vertex < vertexCount; vertex++)
+	{
+		memcpy(&vertexPositions[vertex], positionBytes + vertex * positionStride, sizeof(FVector3));
+		boundsMin = { std::min(boundsMin.x, vertexPositions[vertex].x), std::min(boundsMin.y, vertexPositions[vertex].y), std::min(boundsMin.z, vertexPositions[vertex].z) };
+		boundsMax = { std::max(boundsMax.x, vertexPositions[vertex].x), std::max(boundsMax.y, vertexPositions[vertex].y), std::max(boundsMax.z, vertexPositions[vertex].z) };
+	}
+	const float extent = std::max({ boundsMax.x - boundsMin.x, boundsMax.y - boundsMin.y, boundsMax.z - boundsMin.z });
+	const float inverseExtent = extent > 0.0f ? 1.0f / extent : 0.0f;
+	for (FVector3& position : vertexPositions)
+	{
+		position = { (position.x - boundsMin.x) * inverseExtent, (position.y - boundsMin.y) * inverseExtent, (position.z - boundsMin.z) * inverseExtent };
+	}
+
+	// Vertices that only differ in attributes share a position id. Topology and quadrics work on position ids
+	std::vector<uint32_t> positionIds(vertexCount);
+	std::vector<bool> lockedPositions(vertexCount, false);
+	{
+		std::vector<uint32_t> sortedVertices(vertexCount);
+		std::iota(sortedVertices.begin(), sortedVertices.end(), 0u);
+		auto compare_positions = [&vertexPositions](uint32_t left, uint32_t right)
+		{
+			return memcmp(&vertexPositions[left], &vertexPositions[right], sizeof(FVector3)) < 0;
+		};
+		std::sort(sortedVertices.begin(), sortedVertices.end(), compare_positions);
+
+		for (size_t groupBegin = 0; groupBegin < sortedVertices.size();)
+		{
+			size_t groupEnd = groupBegin + 1;
+			while (groupEnd < sortedVertices.size() && !compare_positions(sortedVertices[groupBegin], sortedVertices[groupEnd])) { groupEnd++; }
+
+			for (size_t member = groupBegin; member < groupEnd; member++)
+			{
+				positionIds[sortedVertices[member]] = sortedVertices[groupBegin];
+			}
+			// Attribute seam, moving the vertex would tear the attributes on the other side
+			if (groupEnd - groupBegin > 1) { lockedPositions[sortedVertices[groupBegin]] = true; }
+			groupBegin = groupEnd;
+		}
+	}
+
+	// Open borders, a directed edge without its opposite edge
+	{
+		std::unordered_set<uint64_t> directedEdges{};
+		directedEdges.reserve(destination.size());
+		for (size_t index = 0; index < destination.size(); index++)
+		{
+			const size_t triangleBase = index - index % 3;
+			const uint32_t from = positionIds[destination[index]];
+			const uint32_t to = positionIds[destination[triangleBase + (index + 1) % 3]];
+			directedEdges.insert(static_cast<uint64_t>(from) << 32 | to);
+		}
+		for (uint64_t edge : directedEdges)
+		{
+			const uint32_t from = static_cast<uint32_t>(edge >> 32);
+			const uint32_t to = static_cast<uint32_t>(edge);
+			if (directedEdges.count(static_cast<uint64_t>(to) << 32 | from) == 0)
+			{
+				lockedPositions[from] = true;
+				lockedPositions[to] = true;
+			}
+		}
+	}
+
+	std::vector<FQuadric> quadrics(vertexCount);
+	for (size_t triangleBase = 0; triangleBase < destination.size(); triangleBase += 3)
+	{
+		const uint32_t positionId0 = positionIds[destination[triangleBase + 0]];
+		const FVector3& p0 = vertexPositions[positionId0];
+		const FVector3& p1 = vertexPositions[positionIds[destination[triangleBase + 1]]];
+		const FVector3& p2 = vertexPositions[positionIds[destination[triangleBase + 2]]];
+
+		FVector3 normal = cross(subtract(p1, p0), subtract(p2, p0));
+		const float doubleArea = std::sqrt(dot(normal, normal));
+		if (doubleArea == 0.0f) { continue; }
+		normal = { normal.x / doubleArea, normal.y / doubleArea, normal.z / doubleArea };
+
+		FQuadric triangleQuadric{};
+		triangleQuadric.add_plane(normal, -dot(normal, p0), doubleArea * 0.5f);
+		quadrics[positionId0].add(triangleQuadric);
+		quadrics[positionIds[destination[triangleBase + 1]]].add(triangleQuadric);
+		quadrics[positionIds[destination[triangleBase + 2]]].add(triangleQuadric);
+	}
+
+	const float targetSquaredError = targetError * targetError;
+	float resultSquaredError = 0.0f;
+
+	std::vector<uint32_t> adjacencyOffsets(vertexCount + 1);
+	std::vector<uint32_t> adjacency{};
+	std::vector<FCollapse> collapses{};
+	std::vector<uint32_t> remap(vertexCount);
+	std::vector<bool> passLockedPositions(vertexCount);
+
+	while (destination.size() > targetIndexCount)
+	{
+		const uint32_t triangleCount = static_cast<uint32_t>(destination.size() / 3);
+
+		// Triangles around each vertex index
+		std::fill(adjacencyOffsets.begin(), adjacencyOffsets.end(), 0u);
+		for (uint32_t index : destination) { adjacencyOffsets[index + 1]++; }
+		std::partial_sum(adjacencyOffsets.begin(), adjacencyOffsets.end(), adjacencyOffsets.begin());
+		adjacency.resize(destination.size());
+		{
+			std::vector<uint32_t> fillCounts(vertexCount, 0);
+			for (size_t index = 0; index < destination.size(); index++)
+			{
+				adjacency[adjacencyOffsets[destination[index]] + fillCounts[destination[index]]++] = static_cast<uint32_t>(index / 3);
+			}
+		}
+
+		// Each interior edge shows up once with ascending indices, the cheaper valid direction is kept
+		collapses.clear();
+		for (size_t index = 0; index < destination.size(); index++)
+		{
+			const uint32_t first = destination[index];
+			const uint32_t second = destination[index - index % 3 + (index + 1) % 3];
+			if (first >= second) { continue; }
+
+			const bool bFirstMovable = !lockedPositions[positionIds[first]];
+			const bool bSecondMovable = !lockedPositions[positionIds[second]];
+			if (!bFirstMovable && !bSecondMovable) { continue; }
+
+			const float firstError = bFirstMovable ? quadrics[positionIds[first]].evaluate(vertexPositions[positionIds[second]]) : INFINITY;
+			const float secondError = bSecondMovable ? quadrics[positionIds[second]].evaluate(vertexPositions[positionIds[first]]) : INFINITY;
+			collapses.push_back(firstError <= secondError ? FCollapse{ first, second, firstError } : FCollapse{ second, first, secondError });
+		}
+		if (collapses.empty()) { break; }
+
+		std::sort(collapses.begin(), collapses.end(), [](const FCollapse& left, const FCollapse& right) { return left.error < right.error; });
+
+		// An interior collapse removes two triangles
+		const size_t collapseGoal = std::max<size_t>((destination.size() - targetIndexCount) / 6, 1);
+		const float passErrorLimit = std::min(targetSquaredError, collapses[std::min(collapseGoal, collapses.size()) - 1].error * PASS_ERROR_SLACK);
+
+		std::iota(remap.begin(), remap.end(), 0u);
+		std::fill(passLockedPositions.begin(), passLockedPositions.end(), false);
+		uint32_t remainingTriangles = triangleCount;
+		uint32_t collapseCount = 0;
+
+		for (const FCollapse& collapse : collapses)
+		{
+			if (collapse.error > passErrorLimit || remainingTriangles * 3 <= targetIndexCount) { break; }
+			if (passLockedPositions[positionIds[collapse.source]] || passLockedPositions[positionIds[collapse.target]]) { continue; }
+
+			// Reject collapses that flip a triangle around the source
+			const FVector3& targetPosition = vertexPositions[positionIds[collapse.target]];
+			bool bFlips = false;
+			uint32_t removedTriangles = 0;
+			for (uint32_t adjacencyIndex = adjacencyOffsets[collapse.source]; adjacencyIndex < adjacencyOffsets[collapse.source + 1]; adjacencyIndex++)
+			{
+				const uint32_t* triangle = &destination[adjacency[adjacencyIndex] * 3];
+				if (triangle[0] == collapse.target || triangle[1] == collapse.target || triangle[2] == collapse.target)
+				{
+					removedTriangles++;
+					continue;
+				}
+
+				FVector3 corners[3];
+				FVector3 movedCorners[3];
+				for (uint32_t corner = 0; corner < 3; corner++)
+				{
+					corners[corner] = vertexPositions[positionIds[triangle[corner]]];
+					movedCorners[corner] = triangle[corner] == collapse.source ? targetPosition : corners[corner];
+				}
+				const FVector3 normal = cross(subtract(corners[1], corners[0]), subtract(corners[2], corners[0]));
+				const FVector3 movedNormal = cross(subtract(movedCorners[1], movedCorners[0]), subtract(movedCorners[2], movedCorners[0]));
+				if (dot(normal, movedNormal) <= 0.0f)
+				{
+					bFlips = true;
+					break;
+				}
+			}
+			if (bFlips) { continue; }
+
+			// Neighbours are locked for the rest of the pass so flip checks stay valid
+			for (uint32_t adjacencyIndex = adjacencyOffsets[collapse.source]; adjacencyIndex < adjacencyOffsets[collapse.source + 1]; adjacencyIndex++)
+			{
+				const uint32_t* triangle = &destination[adjacency[adjacencyIndex] * 3];
+				for (uint32_t corner = 0; corner < 3; corner++) { passLockedPositions[positionIds[triangle[corner]]] = true; }
+			}
+			passLockedPositions[positionIds[collapse.target]] = true;
+
+			remap[collapse.source] = collapse.target;
+			quadrics[positionIds[collapse.target]].add(quadrics[positionIds[collapse.source]]);
+			resultSquaredError = std::max(resultSquaredError, collapse.error);
+			remainingTriangles -= std::min(removedTriangles, remainingTriangles);
+			collapseCount++;
+		}
+		if (collapseCount == 0) { break; }
+
+		// Triangles that lost an edge are dropped
+		size_t writeIndex = 0;
+		for (size_t triangleBase = 0; triangleBase < destination.size(); triangleBase += 3)
+		{
+			const uint32_t corner0 = remap[destination[triangleBase + 0]];
+			const uint32_t corner1 = remap[destination[triangleBase + 1]];
+			const uint32_t corner2 = remap[destination[triangleBase + 2]];
+			if (positionIds[corner0] == positionIds[corner1] || positionIds[corner1] == positionIds[corner2] || positionIds[corner0] == positionIds[corner2]) { continue; }
+
+			destination[writeIndex++] = corner0;
+			destination[writeIndex++] = corner1;
+			destination[writeIndex++] = corner2;
+		}
+		destination.resize(writeIndex);
+	}
+
+	return std::sqrt(resultSquaredError) * extent;
+}
+
+} // namespace SE
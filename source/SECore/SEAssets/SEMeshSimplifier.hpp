@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace SE {
+
+// Quadric error edge collapse (Garland and Heckbert). Vertices only move onto existing vertices, so a simplified index
+// list reuses the vertex buffer of the source mesh. Vertices on open borders and attribute seams stay in place, which
+// keeps LODs free of cracks and texture swimming
+class SEMeshSimplifier {
+
+public:
+	// Collapses edges in order of increasing error until the index count is at or below targetIndexCount or the next
+	// collapse would exceed targetError. targetError is relative to the largest extent of the mesh bounds. Writes the
+	// simplified triangle list to destination and returns its error in position units
+	static float simplify(const uint32_t* indices, uint32_t indexCount, const float* positions, size_t positionStride, uint32_t vertexCount,
+		uint32_t targetIndexCount, float targetError, std::vector<uint32_t>& destination);
+};
+
+} // namespace SE
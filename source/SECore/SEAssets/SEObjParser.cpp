@@ -0,0 +1,351 @@
+#include "SEObjParser.hpp"
+#include "SECore/SEUtilities/SEMappedFile.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+// The parallel front end reuses tinyobjloader's number parsing so positions, colors and coordinates are bit identical
+#define TINYOBJLOADER_IMPLEMENTATION
+#include <tinyobjloader.hpp>
+
+namespace SE {
+
+// Corner of a face as written in the file. Relative (negative) indices are resolved against the counts of the
+// chunk they appear in and get the chunk base added at merge time, once the counts of all previous chunks are known
+struct FObjChunkCorner {
+	int32_t positionIndex;
+	int32_t normalIndex;
+	int32_t texCoordIndex;
+	uint8_t relativeMask;
+};
+
+static constexpr uint8_t RELATIVE_POSITION = 1 << 0;
+static constexpr uint8_t RELATIVE_NORMAL = 1 << 1;
+static constexpr uint8_t RELATIVE_TEXCOORD = 1 << 2;
+
+// Line aligned byte range of the file and everything parsed from it
+struct FObjChunk {
+	const char* begin = nullptr;
+	const char* end = nullptr;
+
+	std::vector<float> positions;
+	std::vector<float> colors;
+	std::vector<float> normals;
+	std::vector<float> texCoords;
+	std::vector<FObjChunkCorner> faceCorners;
+	std::vector<uint8_t> faceSizes;
+
+	std::vector<SEObjParser::FObjCorner> triangleCorners;
+	bool bSupported = true;
+};
+
+// Runs function(index) for every index in [0, count), the calling thread takes index 0
+template <typename Function>
+static void run_parallel(size_t count, const Function& function)
+{
+	std::vector<std::thread> workers;
+	workers.reserve(count > 0 ? count - 1 : 0);
+	for (size_t index = 1; index < count; index++)
+	{
+		workers.emplace_back(function, index);
+	}
+	if (count > 0) { function(0); }
+
+	for (std::thread& worker : workers)
+	{
+		worker.join();
+	}
+}
+
+// Same rules as tinyobj::fixIndex applied to a raw index. Returns false where tinyobjloader would fail the file
+static bool resolve_raw_index(int rawIndex, size_t localCount, bool bAllowZero, int32_t& outIndex, bool& bOutRelative)
+{
+	bOutRelative = false;
+	if (rawIndex > 0)
+	{
+		outIndex = rawIndex - 1;
+		return true;
+	}
+
+	if (rawIndex == 0)
+	{
+		outIndex = -1;
+		return bAllowZero;
+	}
+
+	outIndex = static_cast<int32_t>(localCount) + rawIndex;
+	bOutRelative = true;
+	return true;
+}
+
+static void parse_face(const char* token, FObjChunk& chunk)
+{
+	token += strspn(token, " \t");
+
+	const size_t positionCount = chunk.positions.size() / 3;
+	const size_t normalCount = chunk.normals.size() / 3;
+	const size_t texCoordCount = chunk.texCoords.size() / 2;
+
+	uint32_t faceSize = 0;
+	while (!IS_NEW_LINE(token[0]))
+	{
+		const tinyobj::vertex_index_t rawCorner = tinyobj::parseRawTriple(&token);
+
+		FObjChunkCorner corner{};
+		bool bRelative = false;
+		if (!resolve_raw_index(rawCorner.v_idx, positionCount, false, corner.positionIndex, bRelative))
+		{
+			chunk.bSupported = false;
+			return;
+		}
+		corner.relativeMask |= bRelative ? RELATIVE_POSITION : 0;
+
+		resolve_raw_index(rawCorner.vn_idx, normalCount, true, corner.normalIndex, bRelative);
+		corner.relativeMask |= bRelative ? RELATIVE_NORMAL : 0;
+
+		resolve_raw_index(rawCorner.vt_idx, texCoordCount, true, corner.texCoordIndex, bRelative);
+		corner.relativeMask |= bRelative ? RELATIVE_TEXCOORD : 0;
+
+		chunk.faceCorners.push_back(corner);
+		faceSize++;
+
+		token += strspn(token, " \t\r");
+	}
+
+	// Polygons above quads are ear clipped by tinyobjloader, those files take the reference path
+	if (faceSize > 4)
+	{
+		chunk.bSupported = false;
+		return;
+	}
+
+	chunk.faceSizes.push_back(static_cast<uint8_t>(faceSize));
+}
+
+static void parse_chunk(FObjChunk& chunk)
+{
+	std::string line;
+	line.reserve(256);
+
+	const char* cursor = chunk.begin;
+	while (cursor < chunk.end && chunk.bSupported)
+	{
+		// Lines end at \n, \r or \r\n like tinyobj::safeGetline. The copy gives the tinyobj parsers a terminated string
+		const char* lineEnd = cursor;
+		while (lineEnd < chunk.end && *lineEnd != '\n' && *lineEnd != '\r') { lineEnd++; }
+		line.assign(cursor, lineEnd);
+		cursor = lineEnd + 1;
+
+		const char* token = line.c_str();
+		token += strspn(token, " \t");
+
+		if (token[0] == 'v' && IS_SPACE(token[1]))
+		{
+			token += 2;
+			float x, y, z, r, g, b;
+			tinyobj::parseVertexWithColor(&x, &y, &z, &r, &g, &b, &token);
+			chunk.positions.insert(chunk.positions.end(), { x, y, z });
+			chunk.colors.insert(chunk.colors.end(), { r, g, b });
+		}
+		else if (token[0] == 'v' && token[1] == 'n' && IS_SPACE(token[2]))
+		{
+			token += 3;
+			float x, y, z;
+			tinyobj::parseReal3(&x, &y, &z, &token);
+			chunk.normals.insert(chunk.normals.end(), { x, y, z });
+		}
+		else if (token[0] == 'v' && token[1] == 't' && IS_SPACE(token[2]))
+		{
+			token += 3;
+			float x, y;
+			tinyobj::parseReal2(&x, &y, &token);
+			chunk.texCoords.insert(chunk.texCoords.end(), { x, y });
+		}
+		else if (token[0] == 'f' && IS_SPACE(token[1]))
+		{
+			parse_face(token + 2, chunk);
+		}
+		// Everything else (comments, groups, materials, lines, points) does not contribute triangles
+	}
+}
+
+// Rebases relative indices and splits quads along the shorter diagonal exactly like tinyobj::exportGroupsToShape
+static void triangulate_chunk(FObjChunk& chunk, const SEObjParser::FObjData& objData, size_t positionBase, size_t normalBase, size_t texCoordBase)
+{
+	const int32_t positionCount = static_cast<int32_t>(objData.positions.size() / 3);
+	const int32_t normalCount = static_cast<int32_t>(objData.normals.size() / 3);
+	const int32_t texCoordCount = static_cast<int32_t>(objData.texCoords.size() / 2);
+
+	chunk.triangleCorners.reserve(chunk.faceCorners.size() * 3 / 2);
+
+	size_t cornerOffset = 0;
+	for (uint8_t faceSize : chunk.faceSizes)
+	{
+		SEObjParser::FObjCorner corners[4];
+		for (uint32_t cornerIndex = 0; cornerIndex < faceSize; cornerIndex++)
+		{
+			const FObjChunkCorner& chunkCorner = chunk.faceCorners[cornerOffset + cornerIndex];
+			SEObjParser::FObjCorner& corner = corners[cornerIndex];
+			corner.positionIndex = chunkCorner.positionIndex + ((chunkCorner.relativeMask & RELATIVE_POSITION) ? static_cast<int32_t>(positionBase) : 0);
+			corner.normalIndex = chunkCorner.normalIndex + ((chunkCorner.relativeMask & RELATIVE_NORMAL) ? static_cast<int32_t>(normalBase) : 0);
+			corner.texCoordIndex = chunkCorner.texCoordIndex + ((chunkCorner.relativeMask & RELATIVE_TEXCOORD) ? static_cast<int32_t>(texCoordBase) : 0);
+
+			// Relative indices before the start of the file fail in tinyobjloader, out of range ones are not checked there
+			if (corner.positionIndex < 0 || corner.positionIndex >= positionCount || corner.normalIndex >= normalCount || corner.texCoordIndex >= texCoordCount
+				|| (corner.normalIndex < 0 && (chunkCorner.relativeMask & RELATIVE_NORMAL)) || (corner.texCoordIndex < 0 && (chunkCorner.relativeMask & RELATIVE_TEXCOORD)))
+			{
+				chunk.bSupported = false;
+				return;
+			}
+		}
+		cornerOffset += faceSize;
+
+		if (faceSize < 3) { continue; }
+
+		if (faceSize == 3)
+		{
+			chunk.triangleCorners.insert(chunk.triangleCorners.end(), { corners[0], corners[1], corners[2] });
+			continue;
+		}
+
+		const float* v0 = &objData.positions[3 * static_cast<size_t>(corners[0].positionIndex)];
+		const float* v1 = &objData.positions[3 * static_cast<size_t>(corners[1].positionIndex)];
+		const float* v2 = &objData.positions[3 * static_cast<size_t>(corners[2].positionIndex)];
+		const float* v3 = &objData.positions[3 * static_cast<size_t>(corners[3].positionIndex)];
+
+		const float e02x = v2[0] - v0[0];
+		const float e02y = v2[1] - v0[1];
+		const float e02z = v2[2] - v0[2];
+		const float e13x = v3[0] - v1[0];
+		const float e13y = v3[1] - v1[1];
+		const float e13z = v3[2] - v1[2];
+
+		const float sqr02 = e02x * e02x + e02y * e02y + e02z * e02z;
+		const float sqr13 = e13x * e13x + e13y * e13y + e13z * e13z;
+
+		if (sqr02 < sqr13)
+		{
+			chunk.triangleCorners.insert(chunk.triangleCorners.end(), { corners[0], corners[1], corners[2], corners[0], corners[2], corners[3] });
+		}
+		else
+		{
+			chunk.triangleCorners.insert(chunk.triangleCorners.end(), { corners[0], corners[1], corners[3], corners[1], corners[2], corners[3] });
+		}
+	}
+}
+
+void SEObjParser::load_file(const std::string& filepath, FObjData& objData, uint32_t threadCount)
+{
+	if (parse_file_parallel(filepath, objData, threadCount)) { return; }
+
+	parse_file_tinyobj(filepath, objData);
+}
+
+bool SEObjParser::parse_file_parallel(const std::string& filepath, FObjData& objData, uint32_t threadCount)
+{
+	SEMappedFile file{filepath};
+	if (!file.is_valid()) { return false; }
+
+	const char* fileBegin = reinterpret_cast<const char*>(file.get_data());
+	const char* fileEnd = fileBegin + file.get_size();
+
+	if (threadCount == 0) { threadCount = std::max(1u, std::thread::hardware_concurrency()); }
+	const size_t chunkCount = std::max<size_t>(1, std::min<size_t>(threadCount, file.get_size() / MIN_BYTES_PER_THREAD));
+
+	// Split at the first line break after each even share of the file
+	std::vector<FObjChunk> chunks(chunkCount);
+	const char* chunkBegin = fileBegin;
+	for (size_t chunkIndex = 0; chunkIndex < chunkCount; chunkIndex++)
+	{
+		const char* chunkEnd = chunkIndex + 1 == chunkCount ? fileEnd : std::max(chunkBegin, fileBegin + file.get_size() * (chunkIndex + 1) / chunkCount);
+		while (chunkEnd < fileEnd && *chunkEnd != '\n' && *chunkEnd != '\r') { chunkEnd++; }
+		if (chunkEnd < fileEnd) { chunkEnd++; }
+
+		chunks[chunkIndex].begin = chunkBegin;
+		chunks[chunkIndex].end = chunkEnd;
+		chunkBegin = chunkEnd;
+	}
+
+	run_parallel(chunkCount, [&chunks](size_t chunkIndex) { parse_chunk(chunks[chunkIndex]); });
+
+	// Prefix sums of the record counts give each chunk its place in the merged arrays
+	std::vector<size_t> positionBases(chunkCount), normalBases(chunkCount), texCoordBases(chunkCount), cornerBases(chunkCount);
+	size_t positionFloats = 0, normalFloats = 0, texCoordFloats = 0;
+	for (size_t chunkIndex = 0; chunkIndex < chunkCount; chunkIndex++)
+	{
+		if (!chunks[chunkIndex].bSupported) { return false; }
+
+		positionBases[chunkIndex] = positionFloats;
+		normalBases[chunkIndex] = normalFloats;
+		texCoordBases[chunkIndex] = texCoordFloats;
+		positionFloats += chunks[chunkIndex].positions.size();
+		normalFloats += chunks[chunkIndex].normals.size();
+		texCoordFloats += chunks[chunkIndex].texCoords.size();
+	}
+
+	objData.positions.resize(positionFloats);
+	objData.colors.resize(positionFloats);
+	objData.normals.resize(normalFloats);
+	objData.texCoords.resize(texCoordFloats);
+
+	run_parallel(chunkCount, [&](size_t chunkIndex) {
+		FObjChunk& chunk = chunks[chunkIndex];
+		std::copy(chunk.positions.begin(), chunk.positions.end(), objData.positions.begin() + positionBases[chunkIndex]);
+		std::copy(chunk.colors.begin(), chunk.colors.end(), objData.colors.begin() + positionBases[chunkIndex]);
+		std::copy(chunk.normals.begin(), chunk.normals.end(), objData.normals.begin() + normalBases[chunkIndex]);
+		std::copy(chunk.texCoords.begin(), chunk.texCoords.end(), objData.texCoords.begin() + texCoordBases[chunkIndex]);
+	});
+
+	// Quads need the merged positions of every chunk, so triangulation runs after the copy
+	run_parallel(chunkCount, [&](size_t chunkIndex) {
+		triangulate_chunk(chunks[chunkIndex], objData, positionBases[chunkIndex] / 3, normalBases[chunkIndex] / 3, texCoordBases[chunkIndex] / 2);
+	});
+
+	size_t cornerCount = 0;
+	for (size_t chunkIndex = 0; chunkIndex < chunkCount; chunkIndex++)
+	{
+		if (!chunks[chunkIndex].bSupported) { return false; }
+
+		cornerBases[chunkIndex] = cornerCount;
+		cornerCount += chunks[chunkIndex].triangleCorners.size();
+	}
+
+	objData.corners.resize(cornerCount);
+	run_parallel(chunkCount, [&](size_t chunkIndex) {
+		const FObjChunk& chunk = chunks[chunkIndex];
+		std::copy(chunk.triangleCorners.begin(), chunk.triangleCorners.end(), objData.corners.begin() + cornerBases[chunkIndex]);
+	});
+
+	return true;
+}
+
+void SEObjParser::parse_file_tinyobj(const std::string& filepath, FObjData& objData)
+{
+	tinyobj::attrib_t attrib;
+	std::vector<tinyobj::shape_t> shapes;
+	std::vector<tinyobj::material_t> materials;
+	std::string warn, err;
+
+	if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, filepath.c_str()))
+	{
+		throw std::runtime_error(warn + err);
+	}
+
+	objData.positions = std::move(attrib.vertices);
+	objData.colors = std::move(attrib.colors);
+	objData.normals = std::move(attrib.normals);
+	objData.texCoords = std::move(attrib.texcoords);
+
+	objData.corners.clear();
+	for (const auto& shape : shapes)
+	{
+		for (const auto& index : shape.mesh.indices)
+		{
+			objData.corners.push_back({ index.vertex_index, index.normal_index, index.texcoord_index });
+		}
+	}
+}
+
+} // namespace SE
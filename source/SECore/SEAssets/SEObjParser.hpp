@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace SE {
+
+// OBJ front end for SEMesh. Parses the v/vn/vt/f records of a file on several threads and produces the same
+// attribute arrays and triangulated face corners as tinyobjloader, which is still used for files the fast path can not reproduce exactly
+class SEObjParser {
+
+public:
+
+	// One triangle corner. Indices are zero based, -1 means the attribute is not present
+	struct FObjCorner {
+		int32_t positionIndex;
+		int32_t normalIndex;
+		int32_t texCoordIndex;
+	};
+
+	struct FObjData {
+		std::vector<float> positions;	// xyz per position
+		std::vector<float> colors;		// rgb per position, white when the file has no vertex colors
+		std::vector<float> normals;		// xyz per normal
+		std::vector<float> texCoords;	// uv per texture coordinate
+		std::vector<FObjCorner> corners;	// three corners per triangle, in file order
+	};
+
+	// Parses with the parallel front end, falling back to tinyobjloader when needed. Throws on parse errors
+	static void load_file(const std::string& filepath, FObjData& objData, uint32_t threadCount = 0);
+
+	// Parallel front end only. Returns false when the file contains records it does not reproduce exactly
+	// (polygons above four corners, zero or out of range indices), objData is then left in an unspecified state
+	static bool parse_file_parallel(const std::string& filepath, FObjData& objData, uint32_t threadCount = 0);
+
+	// Reference path through tinyobjloader. Throws on parse errors
+	static void parse_file_tinyobj(const std::string& filepath, FObjData& objData);
+
+	// Files below this size are parsed on a single thread
+	static constexpr size_t MIN_BYTES_PER_THREAD = 1 << 20;
+};
+
+} // namespace SE
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "SECore/SEAssets/SEAssetState.hpp"
+#include "SECore/SEComponents/SETexture.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <string>
+
+namespace SE {
+
+class SETextureStreamer;
+
+// Shared reference to a texture whose resident mip levels change while it is drawn. The streamer replaces the texture
+// in its update, so the texture and its descriptor set are only read and written on the main thread
+class SETextureHandle {
+
+public:
+#pragma region Lifecycle
+	SETextureHandle(const std::string& filepath, bool bStreamed) : m_Filepath(filepath), m_bStreamed(bStreamed) {}
+	~SETextureHandle() = default;
+	SETextureHandle(const SETextureHandle&) = delete;
+	SETextureHandle& operator=(const SETextureHandle&) = delete;
+#pragma endregion Lifecycle
+
+	EAssetState get_state() const { return m_State; }
+	bool is_resident() const { return m_State == EAssetState::Resident; }
+	const std::string& get_filepath() const { return m_Filepath; }
+	// Sequential number given at creation and never 0, orders draws by texture in sort keys
+	uint32_t get_sort_id() const { return m_SortId; }
+	// Textures added fully resident keep their whole chain and are never streamed
+	bool is_streamed() const { return m_bStreamed; }
+
+	// nullptr until the first levels are resident
+	SETexture* get_texture() const { return m_Texture.get(); }
+	// Combined image sampler of the resident levels, for set 1 of the render pipelines
+	VkDescriptorSet get_descriptor_set() const { return m_DescriptorSet; }
+
+	// Extent and level count of the asset's full chain, 0 until the first load completes
+	uint32_t get_width() const { return m_Width; }
+	uint32_t get_height() const { return m_Height; }
+	uint32_t get_mip_count() const { return m_MipCount; }
+	// Finest resident level of the chain, get_mip_count() while nothing is resident
+	uint32_t get_resident_mip() const { return m_Texture != nullptr ? m_Texture->get_first_mip() : m_MipCount; }
+
+	// Called while recording, for every draw that uses the texture, with the extent the texture covers on screen in
+	// pixels. The largest extent of a frame sets the level streaming aims for
+	void request_screen_extent(float screenExtent, uint64_t frameNumber)
+	{
+		if (!m_bRequested || frameNumber != m_RequestFrame)
+		{
+			m_bRequested = true;
+			m_RequestFrame = frameNumber;
+			m_ScreenExtent = screenExtent;
+			return;
+		}
+		m_ScreenExtent = std::max(m_ScreenExtent, screenExtent);
+	}
+
+	// Level whose texels map about one to one to screen pixels at the extent requested last, the last level when
+	// nothing was requested
+	uint32_t get_wanted_mip() const
+	{
+		if (!m_bRequested || m_MipCount == 0) { return m_MipCount > 0 ? m_MipCount - 1 : 0; }
+		const float texelExtent = static_cast<float>(std::max(m_Width, m_Height));
+		if (m_ScreenExtent >= texelExtent) { return 0; }
+		const float mipLevel = std::floor(std::log2(texelExtent / std::max(m_ScreenExtent, 1.0f)));
+		return std::min(static_cast<uint32_t>(mipLevel), m_MipCount - 1);
+	}
+	bool was_requested_since(uint64_t frameNumber) const { return m_bRequested && m_RequestFrame >= frameNumber; }
+	float get_screen_extent() const { return m_ScreenExtent; }
+
+private:
+	friend class SETextureStreamer;
+
+	inline static std::atomic<uint32_t> s_NextSortId{1};
+
+	const std::string m_Filepath;
+	const bool m_bStreamed;
+	const uint32_t m_SortId{s_NextSortId.fetch_add(1, std::memory_order_relaxed)};
+	EAssetState m_State{EAssetState::Queued};
+	std::unique_ptr<SETexture> m_Texture{};
+	VkDescriptorSet m_DescriptorSet{VK_NULL_HANDLE};
+
+	uint32_t m_Width{0};
+	uint32_t m_Height{0};
+	uint32_t m_MipCount{0};
+
+	bool m_bRequested{false};
+	uint64_t m_RequestFrame{0};
+	float m_ScreenExtent{0.0f};
+	bool m_bLoadPending{false};		// A worker is building a texture for this handle
+	bool m_bLoadFailed{false};		// A load of the cooked file failed, residency stays as it is
+};
+
+} // namespace SE
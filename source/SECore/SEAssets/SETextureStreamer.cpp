@@ -0,0 +1,314 @@
+#include "SETextureStreamer.hpp"
+#include "SERendering/SERenderPipeline/SESwapChain.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+
+namespace SE {
+
+#pragma region Lifecycle
+SETextureStreamer::SETextureStreamer(SEGraphicsDevice& graphicsDevice, VkDeviceSize budgetBytes, uint32_t workerCount) : m_GraphicsDevice(graphicsDevice), m_BudgetBytes(budgetBytes)
+{
+	m_DescriptorSetLayout = SEDescriptorSetLayout::Builder(m_GraphicsDevice)
+		.add_binding(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT)
+		.build();
+
+	// Sets are freed one by one as textures change residency
+	m_DescriptorPool = SEDescriptorPool::Builder(m_GraphicsDevice)
+		.set_max_sets(MAX_TEXTURES)
+		.add_pool_size(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, MAX_TEXTURES)
+		.set_pool_flags(VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT)
+		.build();
+
+	const uint8_t whiteTexel[SETexture::BYTES_PER_TEXEL] = { 255, 255, 255, 255 };
+	m_DefaultTexture = add_texture("default_white", std::make_unique<SETexture>(m_GraphicsDevice, whiteTexel, 1, 1, false));
+
+	m_Workers.reserve(workerCount);
+	for (uint32_t workerIndex = 0; workerIndex < std::max(1u, workerCount); workerIndex++)
+	{
+		m_Workers.emplace_back(&SETextureStreamer::worker_loop, this);
+	}
+}
+
+SETextureStreamer::~SETextureStreamer()
+{
+	{
+		std::lock_guard<std::mutex> queueLock{m_QueueMutex};
+		m_IsStopping = true;
+		m_RequestQueue.clear();
+	}
+	m_QueueCondition.notify_all();
+
+	for (std::thread& worker : m_Workers)
+	{
+		worker.join();
+	}
+
+	// Textures go with the streamer, the device must be idle by now. Handles held elsewhere are left without one
+	for (const std::shared_ptr<SETextureHandle>& handle : m_Handles)
+	{
+		handle->m_Texture = nullptr;
+		handle->m_DescriptorSet = VK_NULL_HANDLE;
+		handle->m_State = EAssetState::Evicted;
+	}
+	m_CompletedLoads.clear();
+	m_RetiredTextures.clear();
+}
+#pragma endregion Lifecycle
+
+std::string SETextureStreamer::normalize_path(const std::string& filepath)
+{
+	return std::filesystem::path(filepath).lexically_normal().generic_string();
+}
+
+uint32_t SETextureStreamer::get_tail_mip(uint32_t width, uint32_t height, uint32_t mipCount)
+{
+	for (uint32_t mipLevel = 0; mipLevel < mipCount; mipLevel++)
+	{
+		if (SETexture::get_mip_extent(width, mipLevel) <= MIP_TAIL_EXTENT && SETexture::get_mip_extent(height, mipLevel) <= MIP_TAIL_EXTENT) { return mipLevel; }
+	}
+	return mipCount - 1;
+}
+
+std::shared_ptr<SETextureHandle> SETextureStreamer::request_texture(const std::string& filepath)
+{
+	const std::string normalizedPath = normalize_path(filepath);
+	std::shared_ptr<SETextureHandle>& pathEntry = m_PathEntries[normalizedPath];
+	if (pathEntry != nullptr) { return pathEntry; }
+
+	pathEntry = std::make_shared<SETextureHandle>(normalizedPath, true);
+	m_Handles.push_back(pathEntry);
+	enqueue(pathEntry, TAIL_MIP);
+	return pathEntry;
+}
+
+std::shared_ptr<SETextureHandle> SETextureStreamer::add_texture(const std::string& name, std::unique_ptr<SETexture> texture)
+{
+	std::shared_ptr<SETextureHandle> handle = std::make_shared<SETextureHandle>(name, false);
+	handle->m_Width = texture->get_width();
+	handle->m_Height = texture->get_height();
+	handle->m_MipCount = texture->get_resident_mip_count();
+	handle->m_DescriptorSet = allocate_descriptor_set(*texture);
+	handle->m_Texture = std::move(texture);
+	handle->m_State = EAssetState::Resident;
+	m_Handles.push_back(handle);
+	return handle;
+}
+
+void SETextureStreamer::enqueue(const std::shared_ptr<SETextureHandle>& handle, uint32_t firstMip)
+{
+	handle->m_bLoadPending = true;
+	if (handle->m_Texture == nullptr) { handle->m_State = EAssetState::Queued; }
+
+	{
+		std::lock_guard<std::mutex> queueLock{m_QueueMutex};
+		m_RequestQueue.push_back(FLoadRequest{handle, firstMip});
+		m_PendingCount++;
+	}
+	m_QueueCondition.notify_one();
+}
+
+void SETextureStreamer::wait_until_idle()
+{
+	std::unique_lock<std::mutex> queueLock{m_QueueMutex};
+	m_IdleCondition.wait(queueLock, [this]() { return m_PendingCount == 0; });
+}
+
+void SETextureStreamer::worker_loop()
+{
+	while (true)
+	{
+		FLoadRequest request{};
+		{
+			std::unique_lock<std::mutex> queueLock{m_QueueMutex};
+			m_QueueCondition.wait(queueLock, [this]() { return m_IsStopping || !m_RequestQueue.empty(); });
+			if (m_IsStopping) { break; }
+
+			request = std::move(m_RequestQueue.front());
+			m_RequestQueue.pop_front();
+		}
+
+		FCompletedLoad completedLoad = load(request);
+
+		{
+			std::lock_guard<std::mutex> queueLock{m_QueueMutex};
+			m_CompletedLoads.push_back(std::move(completedLoad));
+			m_PendingCount--;
+		}
+		m_IdleCondition.notify_all();
+	}
+
+	m_GraphicsDevice.release_thread_command_pool();
+}
+
+SETextureStreamer::FCompletedLoad SETextureStreamer::load(const FLoadRequest& request)
+{
+	FCompletedLoad completedLoad{request.handle, nullptr, 0, 0, 0};
+	try
+	{
+		// Maps the cooked chain, cooking it on the first load of the asset. Only the levels of the new residency are uploaded
+		SETexture::FTextureSourceData sourceData{};
+		SETexture::load_source_data(m_GraphicsDevice, request.handle->get_filepath(), sourceData);
+		completedLoad.width = sourceData.width;
+		completedLoad.height = sourceData.height;
+		completedLoad.mipCount = sourceData.mipCount;
+
+		const uint32_t firstMip = request.firstMip == TAIL_MIP ? get_tail_mip(sourceData.width, sourceData.height, sourceData.mipCount) : std::min(request.firstMip, sourceData.mipCount - 1);
+		completedLoad.texture = std::make_unique<SETexture>(m_GraphicsDevice, sourceData, firstMip);
+	}
+	catch (const std::exception& exception)
+	{
+		std::cerr << "Failed to stream texture " << request.handle->get_filepath() << ": " << exception.what() << '\n';
+	}
+	return completedLoad;
+}
+
+void SETextureStreamer::update(uint64_t frameNumber)
+{
+	std::vector<FCompletedLoad> completedLoads{};
+	{
+		std::lock_guard<std::mutex> queueLock{m_QueueMutex};
+		completedLoads.swap(m_CompletedLoads);
+	}
+	for (FCompletedLoad& completedLoad : completedLoads)
+	{
+		publish(completedLoad, frameNumber);
+	}
+
+	// Frames up to MAX_FRAMES_IN_FLIGHT back may still sample replaced textures
+	std::vector<VkDescriptorSet> freedDescriptorSets{};
+	auto retiredEnd = std::remove_if(m_RetiredTextures.begin(), m_RetiredTextures.end(), [frameNumber, &freedDescriptorSets](FRetiredTexture& retiredTexture)
+	{
+		if (retiredTexture.frameNumber + SESwapChain::MAX_FRAMES_IN_FLIGHT > frameNumber) { return false; }
+		freedDescriptorSets.push_back(retiredTexture.descriptorSet);
+		retiredTexture.texture = nullptr;
+		return true;
+	});
+	m_RetiredTextures.erase(retiredEnd, m_RetiredTextures.end());
+	if (!freedDescriptorSets.empty()) { m_DescriptorPool->free_descriptors(freedDescriptorSets); }
+
+	select_resident_mips(frameNumber);
+}
+
+void SETextureStreamer::publish(FCompletedLoad& completedLoad, uint64_t frameNumber)
+{
+	SETextureHandle& handle = *completedLoad.handle;
+	handle.m_bLoadPending = false;
+	if (completedLoad.texture == nullptr)
+	{
+		// Retrying would fail the same way every frame, the handle keeps the levels it has
+		m_Stats.failures++;
+		handle.m_bLoadFailed = true;
+		if (handle.m_Texture == nullptr) { handle.m_State = EAssetState::Failed; }
+		return;
+	}
+
+	handle.m_Width = completedLoad.width;
+	handle.m_Height = completedLoad.height;
+	handle.m_MipCount = completedLoad.mipCount;
+
+	if (handle.m_Texture != nullptr)
+	{
+		(completedLoad.texture->get_first_mip() < handle.m_Texture->get_first_mip() ? m_Stats.upgrades : m_Stats.downgrades)++;
+		m_RetiredTextures.push_back(FRetiredTexture{std::move(handle.m_Texture), handle.m_DescriptorSet, frameNumber});
+	}
+
+	handle.m_DescriptorSet = allocate_descriptor_set(*completedLoad.texture);
+	handle.m_Texture = std::move(completedLoad.texture);
+	handle.m_State = EAssetState::Resident;
+	m_Stats.loads++;
+}
+
+void SETextureStreamer::select_resident_mips(uint64_t frameNumber)
+{
+	struct FCandidate {
+		std::shared_ptr<SETextureHandle> handle;
+		uint32_t tailMip;
+		uint32_t wantedMip;
+		bool bRecent;
+	};
+
+	const uint64_t recentFrame = frameNumber > WANTED_FRAMES ? frameNumber - WANTED_FRAMES : 0;
+	std::vector<FCandidate> candidates{};
+	VkDeviceSize residentBytes = 0;
+	VkDeviceSize fixedBytes = 0;		// Fully resident textures and the tails of streamed ones, never given up
+	VkDeviceSize wantedBytes = 0;
+	for (const std::shared_ptr<SETextureHandle>& handle : m_Handles)
+	{
+		const VkDeviceSize handleBytes = handle->m_Texture != nullptr ? handle->m_Texture->get_resident_bytes() : 0;
+		residentBytes += handleBytes;
+		if (!handle->is_streamed())
+		{
+			fixedBytes += handleBytes;
+			wantedBytes += handleBytes;
+			continue;
+		}
+		if (handle->m_MipCount == 0) { continue; }
+
+		const uint32_t tailMip = get_tail_mip(handle->m_Width, handle->m_Height, handle->m_MipCount);
+		const bool bRecent = handle->was_requested_since(recentFrame);
+		const uint32_t wantedMip = bRecent ? std::min(handle->get_wanted_mip(), tailMip) : tailMip;
+		candidates.push_back(FCandidate{handle, tailMip, wantedMip, bRecent});
+		fixedBytes += SETexture::get_chain_bytes(handle->m_Width, handle->m_Height, tailMip);
+		wantedBytes += SETexture::get_chain_bytes(handle->m_Width, handle->m_Height, wantedMip);
+	}
+
+	// Textures drawn recently and large on screen get their levels first
+	std::sort(candidates.begin(), candidates.end(), [](const FCandidate& left, const FCandidate& right)
+	{
+		if (left.bRecent != right.bRecent) { return left.bRecent; }
+		return left.handle->get_screen_extent() > right.handle->get_screen_extent();
+	});
+
+	VkDeviceSize remainingBytes = m_BudgetBytes > fixedBytes ? m_BudgetBytes - fixedBytes : 0;
+	for (const FCandidate& candidate : candidates)
+	{
+		SETextureHandle& handle = *candidate.handle;
+		const VkDeviceSize tailBytes = SETexture::get_chain_bytes(handle.m_Width, handle.m_Height, candidate.tailMip);
+
+		// Coarsest levels are dropped until the rest fits
+		uint32_t targetMip = candidate.wantedMip;
+		while (targetMip < candidate.tailMip && SETexture::get_chain_bytes(handle.m_Width, handle.m_Height, targetMip) - tailBytes > remainingBytes)
+		{
+			targetMip++;
+		}
+		remainingBytes -= SETexture::get_chain_bytes(handle.m_Width, handle.m_Height, targetMip) - tailBytes;
+
+		if (handle.m_bLoadPending || handle.m_bLoadFailed || handle.m_Texture == nullptr) { continue; }
+
+		// Finer levels load as soon as they fit. Levels are only dropped while over budget, so textures keep detail
+		// that is not needed right now as long as there is room for it
+		const uint32_t residentMip = handle.get_resident_mip();
+		if (targetMip < residentMip || (targetMip > residentMip && residentBytes > m_BudgetBytes))
+		{
+			enqueue(candidate.handle, targetMip);
+		}
+	}
+
+	m_Stats.textures = static_cast<uint32_t>(m_Handles.size());
+	m_Stats.residentBytes = residentBytes;
+	m_Stats.wantedBytes = wantedBytes;
+	m_Stats.budgetBytes = m_BudgetBytes;
+}
+
+VkDescriptorSet SETextureStreamer::allocate_descriptor_set(const SETexture& texture)
+{
+	VkDescriptorSet descriptorSet;
+	VkDescriptorImageInfo imageInfo = texture.get_descriptor_info();
+	if (!SEDescriptorWriter(*m_DescriptorSetLayout, *m_DescriptorPool).write_image(0, &imageInfo).build(descriptorSet))
+	{
+		throw std::runtime_error("failed to allocate texture descriptor set!");
+	}
+	return descriptorSet;
+}
+
+FTextureStreamingStats SETextureStreamer::get_stats() const
+{
+	FTextureStreamingStats stats = m_Stats;
+	std::lock_guard<std::mutex> queueLock{m_QueueMutex};
+	stats.pendingLoads = m_PendingCount;
+	return stats;
+}
+
+} // namespace SE
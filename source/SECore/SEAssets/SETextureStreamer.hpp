@@ -0,0 +1,130 @@
+#pragma once
+
+#include "SECore/SEAssets/SETextureHandle.hpp"
+#include "SERendering/SEDescriptorSets/SEDescriptors.hpp"
+#include "SERendering/SEGraphicsDevice/SEGraphicsDevice.hpp"
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace SE {
+
+struct FTextureStreamingStats {
+	uint32_t textures = 0;				// Handles, streamed or fully resident
+	uint32_t pendingLoads = 0;
+	uint64_t loads = 0;					// Residency changes published since startup
+	uint64_t upgrades = 0;				// Loads that added finer levels
+	uint64_t downgrades = 0;			// Loads that dropped levels to get back under budget
+	uint64_t failures = 0;
+	VkDeviceSize residentBytes = 0;
+	VkDeviceSize wantedBytes = 0;		// What every texture at its wanted level would take
+	VkDeviceSize budgetBytes = 0;
+};
+
+// Streams texture mip levels under a memory budget. A requested texture first gets only its mip tail, the levels
+// no larger than MIP_TAIL_EXTENT. Render systems report the extent each texture covers on screen, and update picks
+// the level each texture should start at: the tails always fit, then the rest of the budget goes to the textures
+// drawn most recently and largest. Workers build a texture that starts at the new level from the cooked file, update
+// swaps it in and destroys the old one once no frame in flight samples it
+class SETextureStreamer {
+
+public:
+	static constexpr VkDeviceSize DEFAULT_BUDGET_BYTES = 256ull * 1024 * 1024;
+	static constexpr uint32_t MIP_TAIL_EXTENT = 64;
+	// Textures not drawn for this many frames fall back to their tail when the budget is short
+	static constexpr uint64_t WANTED_FRAMES = 60;
+	static constexpr uint32_t MAX_TEXTURES = 1024;
+	static constexpr uint32_t DEFAULT_WORKER_COUNT = 1;
+
+#pragma region Lifecycle
+	SETextureStreamer(SEGraphicsDevice& graphicsDevice, VkDeviceSize budgetBytes = DEFAULT_BUDGET_BYTES, uint32_t workerCount = DEFAULT_WORKER_COUNT);
+	~SETextureStreamer();
+	SETextureStreamer(const SETextureStreamer&) = delete;
+	SETextureStreamer& operator=(const SETextureStreamer&) = delete;
+#pragma endregion Lifecycle
+
+	// Handles are shared by normalized path. The mip tail is queued right away
+	std::shared_ptr<SETextureHandle> request_texture(const std::string& filepath);
+	// Publishes a texture built by the caller, such as a generated one, with all of its levels. Main thread
+	std::shared_ptr<SETextureHandle> add_texture(const std::string& name, std::unique_ptr<SETexture> texture);
+
+	// Main thread, once per frame before recording. Publishes finished loads, destroys textures no frame in flight
+	// uses, then picks resident levels under the budget and queues the loads that change them
+	void update(uint64_t frameNumber);
+
+	// Blocks until every queued load has finished, used where content must be resident (benchmarks, tools). The
+	// loads are published by the next update
+	void wait_until_idle();
+
+	// Layout of set 1 of the render pipelines, a combined image sampler at binding 0
+	VkDescriptorSetLayout get_descriptor_set_layout() const { return m_DescriptorSetLayout->get_descriptor_set_layout(); }
+	// White 1x1 texture, bound for draws without a resident texture
+	VkDescriptorSet get_default_descriptor_set() const { return m_DefaultTexture->get_descriptor_set(); }
+
+	void set_budget_bytes(VkDeviceSize budgetBytes) { m_BudgetBytes = budgetBytes; }
+	FTextureStreamingStats get_stats() const;
+
+	// Finest level of a chain that is still part of the tail
+	static uint32_t get_tail_mip(uint32_t width, uint32_t height, uint32_t mipCount);
+
+private:
+	struct FLoadRequest {
+		std::shared_ptr<SETextureHandle> handle;
+		uint32_t firstMip;			// TAIL_MIP for the first load, when the chain is not known yet
+	};
+
+	struct FCompletedLoad {
+		std::shared_ptr<SETextureHandle> handle;
+		std::unique_ptr<SETexture> texture;		// nullptr when loading failed
+		uint32_t width;
+		uint32_t height;
+		uint32_t mipCount;
+	};
+
+	struct FRetiredTexture {
+		std::unique_ptr<SETexture> texture;
+		VkDescriptorSet descriptorSet;
+		uint64_t frameNumber;				// Frame whose update replaced it
+	};
+
+	static constexpr uint32_t TAIL_MIP = UINT32_MAX;
+
+	static std::string normalize_path(const std::string& filepath);
+	void worker_loop();
+	FCompletedLoad load(const FLoadRequest& request);
+	void enqueue(const std::shared_ptr<SETextureHandle>& handle, uint32_t firstMip);
+	// Main thread
+	void publish(FCompletedLoad& completedLoad, uint64_t frameNumber);
+	void select_resident_mips(uint64_t frameNumber);
+	VkDescriptorSet allocate_descriptor_set(const SETexture& texture);
+
+
+	SEGraphicsDevice& m_GraphicsDevice;
+	std::unique_ptr<SEDescriptorSetLayout> m_DescriptorSetLayout;
+	std::unique_ptr<SEDescriptorPool> m_DescriptorPool;
+	std::shared_ptr<SETextureHandle> m_DefaultTexture;
+	VkDeviceSize m_BudgetBytes;
+
+	// Main thread
+	std::unordered_map<std::string, std::shared_ptr<SETextureHandle>> m_PathEntries;
+	std::vector<std::shared_ptr<SETextureHandle>> m_Handles;
+	std::vector<FRetiredTexture> m_RetiredTextures;
+	FTextureStreamingStats m_Stats{};
+
+	mutable std::mutex m_QueueMutex;
+	std::condition_variable m_QueueCondition;
+	std::condition_variable m_IdleCondition;
+	std::deque<FLoadRequest> m_RequestQueue;
+	std::vector<FCompletedLoad> m_CompletedLoads;
+	uint32_t m_PendingCount{0};
+	bool m_IsStopping{false};
+	std::vector<std::thread> m_Workers;
+};
+
+} // namespace SE
@@ -0,0 +1,135 @@
+#include "SETgaParser.hpp"
+#include "SECore/SEUtilities/SEMappedFile.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace SE {
+
+static constexpr size_t TGA_HEADER_SIZE = 18;
+
+enum ETgaImageType : uint8_t {
+	TGA_TRUE_COLOR = 2,
+	TGA_GRAYSCALE = 3,
+	TGA_RLE_TRUE_COLOR = 10,
+	TGA_RLE_GRAYSCALE = 11
+};
+
+// Image descriptor bits
+static constexpr uint8_t TGA_RIGHT_TO_LEFT = 1 << 4;
+static constexpr uint8_t TGA_TOP_TO_BOTTOM = 1 << 5;
+
+// Expands one stored pixel (BGR, BGRA or gray) to RGBA8
+static void expand_pixel(const uint8_t* source, uint32_t bytesPerPixel, uint8_t* destination)
+{
+	if (bytesPerPixel == 1)
+	{
+		destination[0] = destination[1] = destination[2] = source[0];
+		destination[3] = 255;
+		return;
+	}
+
+	destination[0] = source[2];
+	destination[1] = source[1];
+	destination[2] = source[0];
+	destination[3] = bytesPerPixel == 4 ? source[3] : 255;
+}
+
+void SETgaParser::load_file(const std::string& filepath, FTgaImage& image)
+{
+	SEMappedFile file{filepath};
+	if (!file.is_valid() || file.get_size() < TGA_HEADER_SIZE)
+	{
+		throw std::runtime_error("failed to open texture " + filepath + " !");
+	}
+
+	const uint8_t* header = file.get_data();
+	const uint8_t idLength = header[0];
+	const uint8_t colorMapType = header[1];
+	const uint8_t imageType = header[2];
+	const uint32_t width = header[12] | (header[13] << 8);
+	const uint32_t height = header[14] | (header[15] << 8);
+	const uint8_t pixelDepth = header[16];
+	const uint8_t descriptor = header[17];
+
+	const bool bGrayscale = imageType == TGA_GRAYSCALE || imageType == TGA_RLE_GRAYSCALE;
+	const bool bRunLength = imageType == TGA_RLE_TRUE_COLOR || imageType == TGA_RLE_GRAYSCALE;
+	if (colorMapType != 0 || (!bGrayscale && imageType != TGA_TRUE_COLOR && imageType != TGA_RLE_TRUE_COLOR))
+	{
+		throw std::runtime_error("unsupported TGA image type in " + filepath + " !");
+	}
+	if ((bGrayscale && pixelDepth != 8) || (!bGrayscale && pixelDepth != 24 && pixelDepth != 32) || (descriptor & TGA_RIGHT_TO_LEFT) != 0)
+	{
+		throw std::runtime_error("unsupported TGA pixel layout in " + filepath + " !");
+	}
+	if (width == 0 || height == 0)
+	{
+		throw std::runtime_error("empty TGA image " + filepath + " !");
+	}
+	if (file.get_size() < TGA_HEADER_SIZE + idLength)
+	{
+		throw std::runtime_error("truncated TGA image " + filepath + " !");
+	}
+
+	const uint32_t bytesPerPixel = pixelDepth / 8;
+	const size_t pixelCount = static_cast<size_t>(width) * height;
+	const uint8_t* data = file.get_data() + TGA_HEADER_SIZE + idLength;
+	const uint8_t* dataEnd = file.get_data() + file.get_size();
+
+	image.width = width;
+	image.height = height;
+	image.pixels.resize(pixelCount * 4);
+	uint8_t* output = image.pixels.data();
+
+	if (!bRunLength)
+	{
+		if (static_cast<size_t>(dataEnd - data) < pixelCount * bytesPerPixel)
+		{
+			throw std::runtime_error("truncated TGA image " + filepath + " !");
+		}
+		for (size_t pixelIndex = 0; pixelIndex < pixelCount; pixelIndex++)
+		{
+			expand_pixel(data + pixelIndex * bytesPerPixel, bytesPerPixel, output + pixelIndex * 4);
+		}
+	}
+	else
+	{
+		// Packets hold up to 128 pixels, a repeated pixel or a literal run. They may cross row boundaries
+		size_t pixelIndex = 0;
+		while (pixelIndex < pixelCount)
+		{
+			if (data >= dataEnd) { throw std::runtime_error("truncated TGA image " + filepath + " !"); }
+			const uint8_t packetHeader = *data++;
+			const size_t runLength = std::min<size_t>((packetHeader & 0x7f) + 1, pixelCount - pixelIndex);
+			const bool bRepeat = (packetHeader & 0x80) != 0;
+
+			const size_t packetBytes = bRepeat ? bytesPerPixel : runLength * bytesPerPixel;
+			if (static_cast<size_t>(dataEnd - data) < packetBytes) { throw std::runtime_error("truncated TGA image " + filepath + " !"); }
+
+			for (size_t runIndex = 0; runIndex < runLength; runIndex++)
+			{
+				expand_pixel(bRepeat ? data : data + runIndex * bytesPerPixel, bytesPerPixel, output + (pixelIndex + runIndex) * 4);
+			}
+			data += packetBytes;
+			pixelIndex += runLength;
+		}
+	}
+
+	// Bottom up is the default TGA order, images stored top down are flipped to match
+	if ((descriptor & TGA_TOP_TO_BOTTOM) != 0)
+	{
+		const size_t rowBytes = static_cast<size_t>(width) * 4;
+		std::vector<uint8_t> row(rowBytes);
+		for (uint32_t rowIndex = 0; rowIndex < height / 2; rowIndex++)
+		{
+			uint8_t* top = output + rowIndex * rowBytes;
+			uint8_t* bottom = output + (height - 1 - rowIndex) * rowBytes;
+			memcpy(row.data(), top, rowBytes);
+			memcpy(top, bottom, rowBytes);
+			memcpy(bottom, row.data(), rowBytes);
+		}
+	}
+}
+
+} // namespace SE
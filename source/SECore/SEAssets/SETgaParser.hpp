@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace SE {
+
+// TGA front end for SETexture. Reads true color and grayscale images, raw or run length encoded, and expands them
+// to RGBA8. Color mapped images are not supported
+class SETgaParser {
+
+public:
+
+	struct FTgaImage {
+		uint32_t width = 0;
+		uint32_t height = 0;
+		// RGBA8, rows bottom up. OBJ texture coordinates start at the bottom and SEMesh keeps them unflipped, so row 0
+		// is the one sampled at v = 0
+		std::vector<uint8_t> pixels;
+	};
+
+	// Throws on unsupported or truncated files
+	static void load_file(const std::string& filepath, FTgaImage& image);
+};
+
+} // namespace SE
@@ -0,0 +1,61 @@
+#include "SEVertexDedupTable.hpp"
+
+#include <algorithm>
+
+namespace SE {
+
+#pragma region Lifecycle
+SEVertexDedupTable::SEVertexDedupTable(std::vector<SEMesh::Vertex>& vertices, size_t expectedVertexCount) : m_Vertices(&vertices)
+{
+	// Power of two capacity that holds the expected count below the maximum load factor
+	expectedVertexCount = std::max(expectedVertexCount, vertices.size());
+	size_t capacity = 16;
+	while (capacity * LOAD_FACTOR_NUMERATOR / LOAD_FACTOR_DENOMINATOR < expectedVertexCount) { capacity *= 2; }
+	allocate_slots(capacity);
+	m_Vertices->reserve(expectedVertexCount);
+
+	// Index vertices that are already in the array, the first of several equal vertices wins
+	for (uint32_t vertexIndex = 0; vertexIndex < static_cast<uint32_t>(vertices.size()); vertexIndex++)
+	{
+		const uint64_t hash = hash_vertex(vertices[vertexIndex]);
+		const uint32_t hashTag = static_cast<uint32_t>(hash >> 32);
+
+		size_t slotIndex = static_cast<size_t>(hash) & m_SlotMask;
+		bool bFound = false;
+		while (m_Slots[slotIndex].vertexIndex != EMPTY_SLOT && !bFound)
+		{
+			bFound = m_Slots[slotIndex].hashTag == hashTag && vertices[m_Slots[slotIndex].vertexIndex] == vertices[vertexIndex];
+			slotIndex = (slotIndex + 1) & m_SlotMask;
+		}
+		if (bFound) { continue; }
+
+		m_Slots[slotIndex] = { hashTag, vertexIndex };
+		if (++m_Count > m_GrowThreshold) { grow(); }
+	}
+}
+#pragma endregion Lifecycle
+
+void SEVertexDedupTable::allocate_slots(size_t capacity)
+{
+	m_Slots.assign(capacity, FSlot{ 0, EMPTY_SLOT });
+	m_SlotMask = capacity - 1;
+	m_GrowThreshold = capacity * LOAD_FACTOR_NUMERATOR / LOAD_FACTOR_DENOMINATOR;
+}
+
+void SEVertexDedupTable::grow()
+{
+	std::vector<FSlot> oldSlots = std::move(m_Slots);
+	allocate_slots(oldSlots.size() * 2);
+
+	// Tags only hold the upper hash bits, so the slot position is recomputed from the vertex
+	for (const FSlot& oldSlot : oldSlots)
+	{
+		if (oldSlot.vertexIndex == EMPTY_SLOT) { continue; }
+
+		size_t slotIndex = static_cast<size_t>(hash_vertex((*m_Vertices)[oldSlot.vertexIndex])) & m_SlotMask;
+		while (m_Slots[slotIndex].vertexIndex != EMPTY_SLOT) { slotIndex = (slotIndex + 1) & m_SlotMask; }
+		m_Slots[slotIndex] = oldSlot;
+	}
+}
+
+} // namespace SE
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "SECore/SEComponents/SEMesh.hpp"
+#include "SECore/SEUtilities/SEHashUtilities.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace SE {
+
+// Open addressing table that maps vertices to their index in a vertex array. Keys are not copied, slots hold the
+// vertex index and a hash tag, the vertex itself is read from the array. One probe sequence per find_or_insert
+class SEVertexDedupTable {
+
+public:
+#pragma region Lifecycle
+	SEVertexDedupTable(std::vector<SEMesh::Vertex>& vertices, size_t expectedVertexCount);
+	~SEVertexDedupTable() = default;
+	SEVertexDedupTable(const SEVertexDedupTable&) = delete;
+	SEVertexDedupTable& operator=(const SEVertexDedupTable&) = delete;
+#pragma endregion Lifecycle
+
+	// Returns the index of an equal vertex, appending the vertex to the array when it was not seen before
+	uint32_t find_or_insert(const SEMesh::Vertex& vertex)
+	{
+		const uint64_t hash = hash_vertex(vertex);
+		const uint32_t hashTag = static_cast<uint32_t>(hash >> 32);
+
+		size_t slotIndex = static_cast<size_t>(hash) & m_SlotMask;
+		while (true)
+		{
+			FSlot& slot = m_Slots[slotIndex];
+			if (slot.vertexIndex == EMPTY_SLOT) { break; }
+			if (slot.hashTag == hashTag && (*m_Vertices)[slot.vertexIndex] == vertex) { return slot.vertexIndex; }
+			slotIndex = (slotIndex + 1) & m_SlotMask;
+		}
+
+		const uint32_t vertexIndex = static_cast<uint32_t>(m_Vertices->size());
+		m_Vertices->push_back(vertex);
+		m_Slots[slotIndex] = { hashTag, vertexIndex };
+
+		if (++m_Count > m_GrowThreshold) { grow(); }
+		return vertexIndex;
+	}
+
+	// Hashes the 11 float words of a vertex with independent multiplies, which compilers turn into vector code.
+	// Negative zero is folded into positive zero so vertices that compare equal hash equal
+	static uint64_t hash_vertex(const SEMesh::Vertex& vertex)
+	{
+		static_assert(sizeof(SEMesh::Vertex) == VERTEX_WORDS * sizeof(uint32_t), "Vertex must be tightly packed floats");
+
+		uint32_t words[VERTEX_WORDS];
+		memcpy(words, &vertex, sizeof(words));
+
+		uint64_t hash = 0;
+		for (uint32_t wordIndex = 0; wordIndex < VERTEX_WORDS; wordIndex++)
+		{
+			const uint32_t word = words[wordIndex] == 0x80000000u ? 0u : words[wordIndex];
+			hash += static_cast<uint64_t>(word ^ HASH_KEYS[wordIndex]) * HASH_MULTIPLIERS[wordIndex];
+		}
+		return hash_mix(hash);
+	}
+
+	size_t get_count() const { return m_Count; }
+	size_t get_capacity() const { return m_Slots.size(); }
+
+private:
+	struct FSlot {
+		uint32_t hashTag;
+		uint32_t vertexIndex;
+	};
+
+	void grow();
+	void allocate_slots(size_t capacity);
+
+	static constexpr uint32_t EMPTY_SLOT = 0xFFFFFFFFu;
+	static constexpr uint32_t VERTEX_WORDS = 11;
+
+	// Maximum load factor is 3/4
+	static constexpr size_t LOAD_FACTOR_NUMERATOR = 3;
+	static constexpr size_t LOAD_FACTOR_DENOMINATOR = 4;
+
+	static constexpr uint32_t HASH_KEYS[VERTEX_WORDS] = {
+		0x9e3779b9u, 0x7f4a7c15u, 0xf39cc060u, 0x5ced8a26u, 0x85ebca6bu, 0xc2b2ae35u,
+		0x27d4eb2fu, 0x165667b1u, 0xd3a2646cu, 0xfd7046c5u, 0xb55a4f09u
+	};
+	static constexpr uint64_t HASH_MULTIPLIERS[VERTEX_WORDS] = {
+		0x9fb21c651e98df25ull, 0xc2b2ae3d27d4eb4full, 0x165667b19e3779f9ull, 0xd6e8feb86659fd93ull,
+		0xa0761d6478bd642full, 0xe7037ed1a0b428dbull, 0x8ebc6af09c88c6e3ull, 0x589965cc75374cc3ull,
+		0x1d8e4e27c47d124full, 0xbf58476d1ce4e5b9ull, 0x94d049bb133111ebull
+	};
+
+	std::vector<SEMesh::Vertex>* m_Vertices;
+	std::vector<FSlot> m_Slots;
+	size_t m_SlotMask = 0;
+	size_t m_Count = 0;
+	size_t m_GrowThreshold = 0;
+};
+
+} // namespace SE
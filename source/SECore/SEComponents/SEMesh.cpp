@@ -1,12 +1,23 @@
 #include "SEMesh.hpp"
+#include "SECore/SEAssets/SEMeshOptimizer.hpp"
+#include "SECore/SEAssets/SEMeshSimplifier.hpp"
+#include "SECore/SEAssets/SEObjParser.hpp"
+#include "SECore/SEAssets/SEVertexDedupTable.hpp"
 #include "SECore/SEUtilities/SEHashUtilities.hpp"
+#include "SECore/SEUtilities/SEFileUtilities.hpp"
+#include "SECore/SEUtilities/SEMappedFile.hpp"
 
+#include <algorithm>
 #include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
 #include <iostream>
+#include <limits>
 #include <unordered_map>
 
-#define TINYOBJLOADER_IMPLEMENTATION
-#include <tinyobjloader.hpp>
+#include <glm/gtc/packing.hpp>
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/gtx/hash.hpp>
 
@@ -26,25 +37,163 @@ namespace std
 
 namespace SE {
 
+// Returns the header of a mapped cooked mesh, or nullptr when the file is not a cooked mesh of the current layout
+static const SEMesh::FCookedMeshHeader* get_cooked_mesh_header(const SEMappedFile& cookedFile)
+{
+	if (!cookedFile.is_valid() || cookedFile.get_size() < sizeof(SEMesh::FCookedMeshHeader)) { return nullptr; }
+
+	const SEMesh::FCookedMeshHeader* header = reinterpret_cast<const SEMesh::FCookedMeshHeader*>(cookedFile.get_data());
+	if (header->magic != SEMesh::COOKED_MESH_MAGIC || header->layoutVersion != SEMesh::COOKED_MESH_LAYOUT_VERSION || header->vertexStride != sizeof(SEMesh::Vertex))
+	{
+		return nullptr;
+	}
+
+	const size_t lodTableOffset = sizeof(SEMesh::FCookedMeshHeader) + static_cast<size_t>(header->vertexCount) * sizeof(SEMesh::Vertex) + static_cast<size_t>(header->indexCount) * sizeof(uint32_t);
+	const size_t meshletTableOffset = lodTableOffset + static_cast<size_t>(header->lodCount) * sizeof(SEMesh::FMeshLod);
+	const size_t expectedSize = meshletTableOffset + static_cast<size_t>(header->meshletCount) * sizeof(SEMesh::FMeshlet);
+	if (cookedFile.get_size() != expectedSize) { return nullptr; }
+
+	const SEMesh::FMeshLod* lods = reinterpret_cast<const SEMesh::FMeshLod*>(cookedFile.get_data() + lodTableOffset);
+	for (uint32_t lodIndex = 0; lodIndex < header->lodCount; lodIndex++)
+	{
+		if (static_cast<uint64_t>(lods[lodIndex].firstIndex) + lods[lodIndex].indexCount > header->indexCount) { return nullptr; }
+	}
+
+	const SEMesh::FMeshlet* meshlets = reinterpret_cast<const SEMesh::FMeshlet*>(cookedFile.get_data() + meshletTableOffset);
+	for (uint32_t meshletIndex = 0; meshletIndex < header->meshletCount; meshletIndex++)
+	{
+		if (static_cast<uint64_t>(meshlets[meshletIndex].firstIndex) + meshlets[meshletIndex].triangleCount * 3ull > header->indexCount) { return nullptr; }
+	}
+
+#ifndef NDEBUG
+	const SEMesh::Vertex* vertices = reinterpret_cast<const SEMesh::Vertex*>(cookedFile.get_data() + sizeof(SEMesh::FCookedMeshHeader));
+	const uint32_t* indices = reinterpret_cast<const uint32_t*>(vertices + header->vertexCount);
+	if (SEMesh::compute_content_hash(vertices, header->vertexCount, indices, header->indexCount) != header->contentHash)
+	{
+		std::cerr << "Cooked mesh content hash mismatch, ignoring cooked data\n";
+		return nullptr;
+	}
+#endif
+
+	return header;
+}
 
-SEMesh::SEMesh(SEGraphicsDevice& device, const SEMesh::Builder& builder) : m_GraphicsDevice(device)
+// A cooked mesh is current when it exists and is at least as new as its source asset
+static bool is_cooked_mesh_current(const std::string& filepath, const std::string& cookedFilepath)
 {
-	create_vertex_buffers(builder.vertices);
-	create_index_buffers(builder.indices);
+	std::error_code errorCode;
+	if (!std::filesystem::exists(cookedFilepath, errorCode)) { return false; }
+	if (filepath == cookedFilepath || !std::filesystem::exists(filepath, errorCode)) { return true; }
+
+	return std::filesystem::last_write_time(cookedFilepath, errorCode) >= std::filesystem::last_write_time(filepath, errorCode);
 }
 
-SEMesh::~SEMesh()
+
+// Assembles the vertex of one face corner from the parsed attribute arrays
+static SEMesh::Vertex make_vertex(const SEObjParser::FObjData& objData, const SEObjParser::FObjCorner& corner)
+{
+	SEMesh::Vertex vertex{};
+
+	if (corner.positionIndex >= 0)
+	{
+		vertex.position = 
+		{
+			objData.positions[3 * corner.positionIndex + 0],
+			objData.positions[3 * corner.positionIndex + 1],
+			objData.positions[3 * corner.positionIndex + 2]
+		};
+
+		vertex.color =
+		{
+			objData.colors[3 * corner.positionIndex + 0],
+			objData.colors[3 * corner.positionIndex + 1],
+			objData.colors[3 * corner.positionIndex + 2]
+		};
+	}
+
+	if (corner.normalIndex >= 0)
+	{
+		vertex.normal =
+		{
+			objData.normals[3 * corner.normalIndex],
+			objData.normals[3 * corner.normalIndex + 1],
+			objData.normals[3 * corner.normalIndex + 2]
+		};
+	}
+
+	if (corner.texCoordIndex >= 0)
+	{
+		vertex.texCoord =
+		{
+			objData.texCoords[2 * corner.texCoordIndex],
+			objData.texCoords[2 * corner.texCoordIndex + 1]
+		};
+	}
+
+	return vertex;
+}
+
+// Unique vertices rarely exceed the largest attribute array, which makes it a good initial table size
+static size_t get_expected_vertex_count(const SEObjParser::FObjData& objData)
+{
+	return std::max({ objData.positions.size() / 3, objData.normals.size() / 3, objData.texCoords.size() / 2 });
+}
+
+SEMesh::SEMesh(SEGraphicsDevice& device, const SEMesh::Builder& builder) 
+	: SEMesh(device, builder.vertices.data(), static_cast<uint32_t>(builder.vertices.size()), builder.indices.data(), static_cast<uint32_t>(builder.indices.size()),
+		builder.lods.data(), static_cast<uint32_t>(builder.lods.size()), builder.meshlets.data(), static_cast<uint32_t>(builder.meshlets.size()))
+{
+
+}
+
+SEMesh::SEMesh(SEGraphicsDevice& device, const Vertex* vertices, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount, const FMeshLod* lods, uint32_t lodCount,
+	const FMeshlet* meshlets, uint32_t meshletCount)
+	: m_GraphicsDevice(device)
 {
+	m_ContentHash = compute_content_hash(vertices, vertexCount, indices, indexCount);
+	compute_bounds(vertices, vertexCount);
+	create_vertex_buffers(vertices, vertexCount, sizeof(Vertex));
+	create_index_buffers(indices, indexCount);
+	set_lods(lods, lodCount);
+	if (meshlets != nullptr) { m_Meshlets.assign(meshlets, meshlets + meshletCount); }
+}
+
+SEMesh::SEMesh(SEGraphicsDevice& device, const FMeshSourceData& sourceData, EVertexFormat vertexFormat) : m_GraphicsDevice(device)
+{
+	m_ContentHash = get_format_content_hash(sourceData.contentHash, vertexFormat);
+	m_VertexFormat = vertexFormat;
+	compute_bounds(sourceData.vertices, sourceData.vertexCount);
+
+	if (vertexFormat == EVertexFormat::Packed)
+	{
+		std::vector<PackedVertex> packedVertices{};
+		m_DequantizationMatrix = pack_vertices(sourceData.vertices, sourceData.vertexCount, packedVertices);
+		create_vertex_buffers(packedVertices.data(), sourceData.vertexCount, sizeof(PackedVertex));
+	}
+	else
+	{
+		create_vertex_buffers(sourceData.vertices, sourceData.vertexCount, sizeof(Vertex));
+	}
+	create_index_buffers(sourceData.indices, sourceData.indexCount);
+	set_lods(sourceData.lods, sourceData.lodCount);
+	if (sourceData.meshlets != nullptr) { m_Meshlets.assign(sourceData.meshlets, sourceData.meshlets + sourceData.meshletCount); }
+}
 
+SEMesh::~SEMesh()
+{
+	// The mesh cache only releases meshes no frame in flight draws, so the ranges are free for reuse right away
+	SEGeometryPool& geometryPool = m_GraphicsDevice.get_geometry_pool();
+	geometryPool.free_vertices(m_VertexRange);
+	geometryPool.free_indices(m_IndexRange);
 }
 
-std::unique_ptr<SEMesh> SEMesh::create_model_from_file(SEGraphicsDevice& device, const std::string& filepath)
+std::unique_ptr<SEMesh> SEMesh::create_model_from_file(SEGraphicsDevice& device, const std::string& filepath, EVertexFormat vertexFormat)
 {
 	try 
 	{
-		Builder builder{};
-		load_mesh_from_file(builder, filepath);
-		return std::make_unique<SEMesh>(device, builder);
+		FMeshSourceData sourceData{};
+		load_source_data(filepath, sourceData);
+		return std::make_unique<SEMesh>(device, sourceData, vertexFormat);
 	}
 	catch (const std::exception& exception) 
 	{
@@ -53,135 +202,681 @@ std::unique_ptr<SEMesh> SEMesh::create_model_from_file(SEGraphicsDevice& device,
 	}
 }
 
-
-void SEMesh::load_mesh_from_file(Builder& builder, const std::string& filepath)
+void SEMesh::load_source_data(const std::string& filepath, FMeshSourceData& sourceData)
 {
-	tinyobj::attrib_t attrib;
-	std::vector<tinyobj::shape_t> shapes;
-	std::vector<tinyobj::material_t> materials;
-	std::string warn, err;
+	const std::string cookedFilepath = get_cooked_filepath(filepath);
 
-	if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, filepath.c_str()))
+	if (is_cooked_mesh_current(filepath, cookedFilepath))
 	{
-		throw std::runtime_error(warn + err);
+		// Zero parse path, the mapped vertex and index arrays are copied straight into the staging buffers
+		sourceData.cookedFile = std::make_unique<SEMappedFile>(cookedFilepath);
+		if (const FCookedMeshHeader* header = get_cooked_mesh_header(*sourceData.cookedFile))
+		{
+			sourceData.vertices = reinterpret_cast<const Vertex*>(sourceData.cookedFile->get_data() + sizeof(FCookedMeshHeader));
+			sourceData.vertexCount = header->vertexCount;
+			sourceData.indices = reinterpret_cast<const uint32_t*>(sourceData.vertices + header->vertexCount);
+			sourceData.indexCount = header->indexCount;
+			sourceData.lods = reinterpret_cast<const FMeshLod*>(sourceData.indices + header->indexCount);
+			sourceData.lodCount = header->lodCount;
+			sourceData.meshlets = reinterpret_cast<const FMeshlet*>(sourceData.lods + header->lodCount);
+			sourceData.meshletCount = header->meshletCount;
+			sourceData.contentHash = header->contentHash;
+			return;
+		}
+		sourceData.cookedFile = nullptr;
+	}
+
+	load_mesh_from_file(sourceData.builder, filepath);
+	sourceData.builder.build_lod_chain();
+	sourceData.builder.optimize();
+	sourceData.builder.build_meshlets();
+
+	if (!save_cooked_mesh(sourceData.builder, cookedFilepath))
+	{
+		std::cerr << "Failed to write cooked mesh: " << cookedFilepath << '\n';
 	}
 
+	sourceData.vertices = sourceData.builder.vertices.data();
+	sourceData.vertexCount = static_cast<uint32_t>(sourceData.builder.vertices.size());
+	sourceData.indices = sourceData.builder.indices.data();
+	sourceData.indexCount = static_cast<uint32_t>(sourceData.builder.indices.size());
+	sourceData.lods = sourceData.builder.lods.data();
+	sourceData.lodCount = static_cast<uint32_t>(sourceData.builder.lods.size());
+	sourceData.meshlets = sourceData.builder.meshlets.data();
+	sourceData.meshletCount = static_cast<uint32_t>(sourceData.builder.meshlets.size());
+	sourceData.contentHash = compute_content_hash(sourceData.vertices, sourceData.vertexCount, sourceData.indices, sourceData.indexCount);
+}
+
+
+void SEMesh::load_mesh_from_file(Builder& builder, const std::string& filepath)
+{
+	SEObjParser::FObjData objData{};
+	SEObjParser::load_file(filepath, objData);
+
 	builder.vertices.clear();
 	builder.indices.clear();
+	builder.indices.reserve(objData.corners.size());
 
-	std::unordered_map<Vertex, uint32_t> uniqueVertices{};
+	SEVertexDedupTable uniqueVertices{builder.vertices, get_expected_vertex_count(objData)};
+	for (const SEObjParser::FObjCorner& corner : objData.corners)
+	{
+		builder.indices.push_back(uniqueVertices.find_or_insert(make_vertex(objData, corner)));
+	}
+}
 
-	for (const auto& shape : shapes)
+void SEMesh::Builder::build_lod_chain()
+{
+	const uint32_t vertexCount = static_cast<uint32_t>(vertices.size());
+	const uint32_t indexCount = static_cast<uint32_t>(indices.size());
+	lods.assign(1, FMeshLod{0, indexCount, 0.0f});
+	if (vertexCount == 0 || indexCount < 3) { return; }
+
+	// Every level is simplified from the previous one, which keeps the chain cheap to build. Errors add up, so a
+	// level's error is a bound on its distance from the full detail surface
+	std::vector<uint32_t> lodIndices{};
+	while (lods.size() < MAX_LOD_COUNT)
 	{
-		for (const auto& index : shape.mesh.indices)
+		const FMeshLod previousLod = lods.back();
+		const uint32_t targetIndexCount = static_cast<uint32_t>(previousLod.indexCount / 3 * LOD_TRIANGLE_RATIO) * 3;
+		if (targetIndexCount / 3 < MIN_LOD_TRIANGLES) { break; }
+
+		const float error = SEMeshSimplifier::simplify(&indices[previousLod.firstIndex], previousLod.indexCount, &vertices[0].position.x, sizeof(Vertex), vertexCount,
+			targetIndexCount, MAX_LOD_ERROR, lodIndices);
+
+		// Less than a quarter fewer triangles is not worth the extra index memory
+		if (lodIndices.size() * 4 > static_cast<size_t>(previousLod.indexCount) * 3) { break; }
+
+		lods.push_back(FMeshLod{static_cast<uint32_t>(indices.size()), static_cast<uint32_t>(lodIndices.size()), previousLod.error + error});
+		indices.insert(indices.end(), lodIndices.begin(), lodIndices.end());
+	}
+}
+
+void SEMesh::Builder::optimize()
+{
+	const uint32_t vertexCount = static_cast<uint32_t>(vertices.size());
+	const uint32_t indexCount = static_cast<uint32_t>(indices.size());
+	if (vertexCount == 0 || indexCount < 3) { return; }
+	if (lods.empty()) { lods.push_back(FMeshLod{0, indexCount, 0.0f}); }
+
+	for (const FMeshLod& lod : lods)
+	{
+		SEMeshOptimizer::optimize_vertex_cache(&indices[lod.firstIndex], lod.indexCount, vertexCount);
+		SEMeshOptimizer::optimize_overdraw(&indices[lod.firstIndex], lod.indexCount, &vertices[0].position.x, sizeof(Vertex), vertexCount);
+	}
+
+	// The full detail level comes first, so vertex order follows its triangles
+
+	std::vector<uint32_t> remap{};
+	const uint32_t fetchVertexCount = SEMeshOptimizer::build_vertex_fetch_remap(indices.data(), indexCount, vertexCount, remap);
+
+	std::vector<Vertex> fetchOrderedVertices(fetchVertexCount);
+	for (uint32_t vertexIndex = 0; vertexIndex < vertexCount; vertexIndex++)
+	{
+		if (remap[vertexIndex] != SEMeshOptimizer::UNUSED_VERTEX) { fetchOrderedVertices[remap[vertexIndex]] = vertices[vertexIndex]; }
+	}
+	vertices = std::move(fetchOrderedVertices);
+
+	for (uint32_t& index : indices)
+	{
+		index = remap[index];
+	}
+}
+
+void SEMesh::Builder::build_meshlets()
+{
+	meshlets.clear();
+	const uint32_t indexCount = lods.empty() ? static_cast<uint32_t>(indices.size()) : lods[0].indexCount;
+	if (indexCount / 3 < MIN_MESHLET_MESH_TRIANGLES) { return; }
+
+	// Meshlet a vertex was last added to, so each vertex counts once per meshlet
+	std::vector<uint32_t> vertexMeshlets(vertices.size(), std::numeric_limits<uint32_t>::max());
+	uint32_t meshletVertexCount = 0;
+
+	auto finish_meshlet = [this](FMeshlet& meshlet)
+	{
+		const uint32_t* meshletIndices = &indices[meshlet.firstIndex];
+		const uint32_t meshletIndexCount = meshlet.triangleCount * 3;
+
+		glm::vec3 boundsMin{vertices[meshletIndices[0]].position};
+		glm::vec3 boundsMax{boundsMin};
+		for (uint32_t index = 1; index < meshletIndexCount; index++)
 		{
-			Vertex vertex{};
-	
-			if (index.vertex_index >= 0)
+			boundsMin = glm::min(boundsMin, vertices[meshletIndices[index]].position);
+			boundsMax = glm::max(boundsMax, vertices[meshletIndices[index]].position);
+		}
+		const glm::vec3 center = (boundsMin + boundsMax) * 0.5f;
+		float radiusSquared = 0.0f;
+		for (uint32_t index = 0; index < meshletIndexCount; index++)
+		{
+			const glm::vec3 offset = vertices[meshletIndices[index]].position - center;
+			radiusSquared = std::max(radiusSquared, glm::dot(offset, offset));
+		}
+		meshlet.boundingSphere = glm::vec4{center, std::sqrt(radiusSquared)};
+
+		// Normal cone from the winding, the spread is the largest angle between a triangle normal and the axis
+		std::vector<glm::vec3> normals{};
+		normals.reserve(meshlet.triangleCount);
+		glm::vec3 normalSum{0.0f};
+		for (uint32_t index = 0; index < meshletIndexCount; index += 3)
+		{
+			const glm::vec3& p0 = vertices[meshletIndices[index + 0]].position;
+			const glm::vec3 normal = glm::cross(vertices[meshletIndices[index + 1]].position - p0, vertices[meshletIndices[index + 2]].position - p0);
+			const float normalLength = glm::length(normal);
+			if (normalLength == 0.0f) { continue; }
+			normals.push_back(normal / normalLength);
+			normalSum += normals.back();
+		}
+
+		const float axisLength = glm::length(normalSum);
+		meshlet.coneAxis = axisLength > 0.0f ? normalSum / axisLength : glm::vec3{0.0f, 0.0f, 1.0f};
+		float minimumDot = axisLength > 0.0f ? 1.0f : -1.0f;
+		for (const glm::vec3& normal : normals)
+		{
+			minimumDot = std::min(minimumDot, glm::dot(normal, meshlet.coneAxis));
+		}
+		meshlet.coneCutoff = minimumDot <= MESHLET_CONE_MIN_DOT ? 1.0f : std::sqrt(1.0f - minimumDot * minimumDot);
+	};
+
+	FMeshlet meshlet{};
+	meshlet.firstIndex = 0;
+	for (uint32_t index = 0; index + 2 < indexCount; index += 3)
+	{
+		uint32_t newVertexCount = 0;
+		for (uint32_t corner = 0; corner < 3; corner++)
+		{
+			newVertexCount += vertexMeshlets[indices[index + corner]] != static_cast<uint32_t>(meshlets.size()) ? 1 : 0;
+		}
+
+		if (meshlet.triangleCount == MAX_MESHLET_TRIANGLES || meshletVertexCount + newVertexCount > MAX_MESHLET_VERTICES)
+		{
+			finish_meshlet(meshlet);
+			meshlets.push_back(meshlet);
+			meshlet = FMeshlet{};
+			meshlet.firstIndex = index;
+			meshletVertexCount = 0;
+		}
+
+		for (uint32_t corner = 0; corner < 3; corner++)
+		{
+			uint32_t& vertexMeshlet = vertexMeshlets[indices[index + corner]];
+			if (vertexMeshlet != static_cast<uint32_t>(meshlets.size()))
 			{
-				vertex.position = 
-				{
-					attrib.vertices[3 * index.vertex_index + 0],
-					attrib.vertices[3 * index.vertex_index + 1],
-					attrib.vertices[3 * index.vertex_index + 2]
-				};
-
-				vertex.color =
-				{
-					attrib.colors[3 * index.vertex_index + 0],
-					attrib.colors[3 * index.vertex_index + 1],
-					attrib.colors[3 * index.vertex_index + 2]
-				};
+				vertexMeshlet = static_cast<uint32_t>(meshlets.size());
+				meshletVertexCount++;
 			}
+		}
+		meshlet.triangleCount++;
+	}
+
+	if (meshlet.triangleCount > 0)
+	{
+		finish_meshlet(meshlet);
+		meshlets.push_back(meshlet);
+	}
+}
+
+std::string SEMesh::get_cooked_filepath(const std::string& filepath)
+{
+	return std::filesystem::path(filepath).replace_extension(COOKED_MESH_EXTENSION).string();
+}
+
+uint64_t SEMesh::compute_content_hash(const Vertex* vertices, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount)
+{
+	const uint64_t vertexHash = hash_bytes(vertices, static_cast<size_t>(vertexCount) * sizeof(Vertex));
+	return hash_bytes(indices, static_cast<size_t>(indexCount) * sizeof(uint32_t), vertexHash);
+}
+
+bool SEMesh::save_cooked_mesh(const Builder& builder, const std::string& cookedFilepath)
+{
+	FCookedMeshHeader header{};
+	header.magic = COOKED_MESH_MAGIC;
+	header.layoutVersion = COOKED_MESH_LAYOUT_VERSION;
+	header.vertexStride = sizeof(Vertex);
+	header.vertexCount = static_cast<uint32_t>(builder.vertices.size());
+	header.indexCount = static_cast<uint32_t>(builder.indices.size());
+	header.lodCount = static_cast<uint32_t>(builder.lods.size());
+	header.meshletCount = static_cast<uint32_t>(builder.meshlets.size());
+	header.contentHash = compute_content_hash(builder.vertices.data(), header.vertexCount, builder.indices.data(), header.indexCount);
+
+	return write_file_atomically(cookedFilepath, {
+		{&header, sizeof(header)},
+		{builder.vertices.data(), builder.vertices.size() * sizeof(Vertex)},
+		{builder.indices.data(), builder.indices.size() * sizeof(uint32_t)},
+		{builder.lods.data(), builder.lods.size() * sizeof(FMeshLod)},
+		{builder.meshlets.data(), builder.meshlets.size() * sizeof(FMeshlet)}});
+}
+
+bool SEMesh::load_cooked_mesh(Builder& builder, const std::string& cookedFilepath)
+{
+	SEMappedFile cookedFile{cookedFilepath};
+	const FCookedMeshHeader* header = get_cooked_mesh_header(cookedFile);
+	if (header == nullptr) { return false; }
+
+	const Vertex* vertices = reinterpret_cast<const Vertex*>(cookedFile.get_data() + sizeof(FCookedMeshHeader));
+	const uint32_t* indices = reinterpret_cast<const uint32_t*>(vertices + header->vertexCount);
+	builder.vertices.assign(vertices, vertices + header->vertexCount);
+	builder.indices.assign(indices, indices + header->indexCount);
+	const FMeshLod* lods = reinterpret_cast<const FMeshLod*>(indices + header->indexCount);
+	builder.lods.assign(lods, lods + header->lodCount);
+	const FMeshlet* meshlets = reinterpret_cast<const FMeshlet*>(lods + header->lodCount);
+	builder.meshlets.assign(meshlets, meshlets + header->meshletCount);
+	return true;
+}
+
+void SEMesh::benchmark_load_paths(const std::string& filepath, uint32_t iterations)
+{
+	const std::string cookedFilepath = get_cooked_filepath(filepath);
+	Builder builder{};
+
+	const auto parseStart = std::chrono::steady_clock::now();
+	for (uint32_t iteration = 0; iteration < iterations; iteration++)
+	{
+		load_mesh_from_file(builder, filepath);
+	}
+	const float parseMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - parseStart).count() / iterations;
+
+	if (!save_cooked_mesh(builder, cookedFilepath))
+	{
+		std::cerr << "Failed to write cooked mesh: " << cookedFilepath << '\n';
+		return;
+	}
+
+	// The cooked path maps the file and copies both arrays out, which is what the staging upload does
+	const auto cookedStart = std::chrono::steady_clock::now();
+	for (uint32_t iteration = 0; iteration < iterations; iteration++)
+	{
+		load_cooked_mesh(builder, cookedFilepath);
+	}
+	const float cookedMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - cookedStart).count() / iterations;
+
+	std::cout << "Mesh load benchmark for " << filepath << " (" << builder.vertices.size() << " vertices, " << builder.indices.size() << " indices)\n"
+		<< "   OBJ parse: " << parseMilliseconds << " ms\n"
+		<< "   Cooked:    " << cookedMilliseconds << " ms\n"
+		<< "   Speedup:   " << (cookedMilliseconds > 0.0f ? parseMilliseconds / cookedMilliseconds : 0.0f) << "x\n";
+}
+
+void SEMesh::benchmark_vertex_dedup(const std::string& filepath, uint32_t iterations)
+{
+	SEObjParser::FObjData objData{};
+	SEObjParser::load_file(filepath, objData);
+
+	std::vector<Vertex> corners{};
+	corners.reserve(objData.corners.size());
+	for (const SEObjParser::FObjCorner& corner : objData.corners)
+	{
+		corners.push_back(make_vertex(objData, corner));
+	}
 
-			if (index.normal_index >= 0)
+	// Reference, the node based map with a count and an insert lookup per corner
+	Builder mapBuilder{};
+	const auto mapStart = std::chrono::steady_clock::now();
+	for (uint32_t iteration = 0; iteration < iterations; iteration++)
+	{
+		mapBuilder.vertices.clear();
+		mapBuilder.indices.clear();
+		std::unordered_map<Vertex, uint32_t> uniqueVertices{};
+		for (const Vertex& vertex : corners)
+		{
+			if (uniqueVertices.count(vertex) == 0)
 			{
-				vertex.normal =
-				{
-					attrib.normals[3 * index.normal_index],
-					attrib.normals[3 * index.normal_index + 1],
-					attrib.normals[3 * index.normal_index + 2]
-				};
+				uniqueVertices[vertex] = static_cast<uint32_t>(mapBuilder.vertices.size());
+				mapBuilder.vertices.push_back(vertex);
 			}
+			mapBuilder.indices.push_back(uniqueVertices[vertex]);
+		}
+	}
+	const float mapMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - mapStart).count() / iterations;
+
+	Builder tableBuilder{};
+	const auto tableStart = std::chrono::steady_clock::now();
+	for (uint32_t iteration = 0; iteration < iterations; iteration++)
+	{
+		tableBuilder.vertices.clear();
+		tableBuilder.indices.clear();
+		tableBuilder.indices.reserve(corners.size());
+		SEVertexDedupTable uniqueVertices{tableBuilder.vertices, get_expected_vertex_count(objData)};
+		for (const Vertex& vertex : corners)
+		{
+			tableBuilder.indices.push_back(uniqueVertices.find_or_insert(vertex));
+		}
+	}
+	const float tableMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - tableStart).count() / iterations;
+
+	const bool bIdentical = mapBuilder.indices == tableBuilder.indices && mapBuilder.vertices.size() == tableBuilder.vertices.size()
+		&& memcmp(mapBuilder.vertices.data(), tableBuilder.vertices.data(), mapBuilder.vertices.size() * sizeof(Vertex)) == 0;
+
+	std::cout << "Vertex dedup benchmark for " << filepath << " (" << corners.size() << " corners, " << tableBuilder.vertices.size() << " unique vertices)\n"
+		<< "   std::unordered_map: " << mapMilliseconds << " ms\n"
+		<< "   Flat table:         " << tableMilliseconds << " ms\n"
+		<< "   Speedup:            " << (tableMilliseconds > 0.0f ? mapMilliseconds / tableMilliseconds : 0.0f) << "x\n"
+		<< "   Identical output:   " << (bIdentical ? "yes" : "no") << '\n';
+}
+
+void SEMesh::benchmark_mesh_optimization(const std::string& filepath)
+{
+	Builder builder{};
+	load_mesh_from_file(builder, filepath);
+
+	const uint32_t vertexCount = static_cast<uint32_t>(builder.vertices.size());
+	const uint32_t indexCount = static_cast<uint32_t>(builder.indices.size());
+	if (vertexCount == 0 || indexCount < 3)
+	{
+		std::cerr << "Mesh optimization benchmark needs an indexed mesh: " << filepath << '\n';
+		return;
+	}
+
+	auto print_acmr = [&builder, vertexCount, indexCount](const char* passName, float milliseconds)
+	{
+		std::cout << "   " << passName << " ACMR " << SEMeshOptimizer::compute_acmr(builder.indices.data(), indexCount, vertexCount, 16)
+			<< " (16 entries), " << SEMeshOptimizer::compute_acmr(builder.indices.data(), indexCount, vertexCount, 32) << " (32 entries)";
+		if (milliseconds >= 0.0f) { std::cout << ", " << milliseconds << " ms"; }
+		std::cout << '\n';
+	};
+
+	std::cout << "Mesh optimization benchmark for " << filepath << " (" << vertexCount << " vertices, " << indexCount / 3 << " triangles)\n";
+	print_acmr("File order:   ", -1.0f);
+
+	auto passStart = std::chrono::steady_clock::now();
+	SEMeshOptimizer::optimize_vertex_cache(builder.indices.data(), indexCount, vertexCount);
+	print_acmr("Vertex cache: ", std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - passStart).count());
+
+	passStart = std::chrono::steady_clock::now();
+	SEMeshOptimizer::optimize_overdraw(builder.indices.data(), indexCount, &builder.vertices[0].position.x, sizeof(Vertex), vertexCount);
+	print_acmr("Overdraw:     ", std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - passStart).count());
+
+	// Fetch locality, how far the vertex fetch jumps on average between consecutive new vertices
+	auto get_average_fetch_jump = [&builder]()
+	{
+		std::vector<bool> fetchedVertices(builder.vertices.size(), false);
+		uint64_t totalJump = 0;
+		uint32_t fetchCount = 0;
+		uint32_t previousVertex = 0;
+		for (uint32_t index : builder.indices)
+		{
+			if (fetchedVertices[index]) { continue; }
+			fetchedVertices[index] = true;
+			totalJump += index > previousVertex ? index - previousVertex : previousVertex - index;
+			previousVertex = index;
+			fetchCount++;
+		}
+		return static_cast<float>(totalJump) / static_cast<float>(std::max(fetchCount, 1u));
+	};
+	const float fetchJumpBefore = get_average_fetch_jump();
+
+	passStart = std::chrono::steady_clock::now();
+	std::vector<uint32_t> remap{};
+	SEMeshOptimizer::build_vertex_fetch_remap(builder.indices.data(), indexCount, vertexCount, remap);
+	for (uint32_t& index : builder.indices) { index = remap[index]; }
+	const float fetchMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - passStart).count();
+
+	std::cout << "   Vertex fetch: average jump " << fetchJumpBefore << " -> " << get_average_fetch_jump() << " vertices, " << fetchMilliseconds << " ms\n"
+		<< "   Index type:   " << (vertexCount <= MAX_UINT16_INDEXED_VERTICES ? "uint16" : "uint32") << '\n';
+
+	// LOD chain of the file order mesh, what load_source_data builds before optimizing
+	Builder lodBuilder{};
+	load_mesh_from_file(lodBuilder, filepath);
+	passStart = std::chrono::steady_clock::now();
+	lodBuilder.build_lod_chain();
+	std::cout << "   LOD chain:    " << lodBuilder.lods.size() << " levels, " << std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - passStart).count() << " ms\n";
+	for (size_t lodIndex = 0; lodIndex < lodBuilder.lods.size(); lodIndex++)
+	{
+		std::cout << "      LOD " << lodIndex << ": " << lodBuilder.lods[lodIndex].indexCount / 3 << " triangles, error " << lodBuilder.lods[lodIndex].error << '\n';
+	}
+}
 
-			if (index.texcoord_index >= 0)
+void SEMesh::benchmark_upload_paths(SEGraphicsDevice& device, const std::string& filepath, uint32_t iterations)
+{
+	FMeshSourceData sourceData{};
+	load_source_data(filepath, sourceData);
+
+	SEGeometryPool& geometryPool = device.get_geometry_pool();
+	SEStagingRing& stagingRing = device.get_staging_ring();
+	const VkDeviceSize vertexBytes = static_cast<VkDeviceSize>(sourceData.vertexCount) * sizeof(Vertex);
+	const VkDeviceSize indexBytes = static_cast<VkDeviceSize>(sourceData.indexCount) * sizeof(uint32_t);
+	const double megabytes = static_cast<double>((vertexBytes + indexBytes) * iterations) / (1024.0 * 1024.0);
+
+	// Each iteration allocates fresh ranges and waits until the data is usable, the way a mesh load would
+	auto time_uploads = [&](bool bDirect) {
+		const auto startTime = std::chrono::steady_clock::now();
+		for (uint32_t iteration = 0; iteration < iterations; iteration++)
+		{
+			FGeometryRange vertexRange{};
+			FGeometryRange indexRange{};
+			if (!geometryPool.allocate_vertices(sourceData.vertexCount, sizeof(Vertex), vertexRange) ||
+				!geometryPool.allocate_indices(sourceData.indexCount, sizeof(uint32_t), indexRange))
 			{
-				vertex.texCoord =
-				{
-					attrib.texcoords[2 * index.texcoord_index],
-					attrib.texcoords[2 * index.texcoord_index + 1]
-				};
+				geometryPool.free_vertices(vertexRange);
+				return -1.0;
 			}
 
-			if (uniqueVertices.count(vertex) == 0)
+			const VkDeviceSize vertexOffset = SEGeometryPool::get_byte_offset(vertexRange, sizeof(Vertex));
+			const VkDeviceSize indexOffset = SEGeometryPool::get_byte_offset(indexRange, sizeof(uint32_t));
+			if (bDirect)
+			{
+				memcpy(static_cast<char*>(geometryPool.get_vertex_memory()) + vertexOffset, sourceData.vertices, vertexBytes);
+				memcpy(static_cast<char*>(geometryPool.get_index_memory()) + indexOffset, sourceData.indices, indexBytes);
+			}
+			else
 			{
-				uniqueVertices[vertex] = static_cast<uint32_t>(builder.vertices.size());
-				builder.vertices.push_back(vertex);
+				stagingRing.upload_to_buffer(sourceData.vertices, vertexBytes, geometryPool.get_vertex_buffer(), vertexOffset);
+				stagingRing.upload_to_buffer(sourceData.indices, indexBytes, geometryPool.get_index_buffer(), indexOffset);
+				stagingRing.wait_idle();
 			}
-			builder.indices.push_back(uniqueVertices[vertex]);
+
+			geometryPool.free_vertices(vertexRange);
+			geometryPool.free_indices(indexRange);
 		}
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+	};
+
+	std::cout << "Mesh upload benchmark for " << filepath << " (" << sourceData.vertexCount << " vertices, " << sourceData.indexCount << " indices, "
+		<< (vertexBytes + indexBytes) / 1024 << " KB)\n";
+
+	const double stagedSeconds = time_uploads(false);
+	if (stagedSeconds < 0.0)
+	{
+		std::cout << "   Mesh does not fit the geometry pool\n";
+		return;
+	}
+	std::cout << "   Staging ring: " << stagedSeconds * 1000.0 / iterations << " ms, " << megabytes / stagedSeconds << " MB/s\n";
+
+	if (!device.has_unified_memory())
+	{
+		std::cout << "   Direct write: unavailable, the device has no host visible device local heap\n";
+		return;
 	}
+	const double directSeconds = time_uploads(true);
+	std::cout << "   Direct write: " << directSeconds * 1000.0 / iterations << " ms, " << megabytes / directSeconds << " MB/s\n"
+		<< "   Speedup:      " << (directSeconds > 0.0 ? stagedSeconds / directSeconds : 0.0) << "x\n";
 }
 
 void SEMesh::bind_command_buffer(VkCommandBuffer commandBuffer)
 {
-	VkBuffer buffers[] = { m_VertexBuffer->get_buffer() };
+	VkBuffer buffers[] = { get_vertex_buffer() };
 	VkDeviceSize offsets[] = { 0 };
 	vkCmdBindVertexBuffers(commandBuffer, 0, 1, buffers, offsets);
 
 	if (m_HasIndexBuffer)
 	{
-		vkCmdBindIndexBuffer(commandBuffer, m_IndexBuffer->get_buffer(), 0, VK_INDEX_TYPE_UINT32);
+		vkCmdBindIndexBuffer(commandBuffer, get_index_buffer(), 0, m_IndexType);
 	}
 }
 
-void SEMesh::draw(VkCommandBuffer commandBuffer)
+void SEMesh::draw(VkCommandBuffer commandBuffer, uint32_t lodIndex, uint32_t instanceCount, uint32_t firstInstance)
 {
 	if (m_HasIndexBuffer)
 	{
-		vkCmdDrawIndexed(commandBuffer, m_IndexCount, 1, 0, 0, 0);
+		const FMeshLod& lod = m_Lods[lodIndex];
+		vkCmdDrawIndexed(commandBuffer, lod.indexCount, instanceCount, m_IndexRange.first + lod.firstIndex, static_cast<int32_t>(m_VertexRange.first), firstInstance);
 		return;
 	}
-	vkCmdDraw(commandBuffer, m_VertexCount, 1, 0, 0);
+	vkCmdDraw(commandBuffer, m_VertexCount, instanceCount, m_VertexRange.first, firstInstance);
 }
 
-void SEMesh::create_vertex_buffers(const std::vector<Vertex>& vertices)
+VkDrawIndexedIndirectCommand SEMesh::get_draw_command(uint32_t lodIndex, uint32_t instanceCount, uint32_t firstInstance) const
 {
-	m_VertexCount = static_cast<uint32_t>(vertices.size());
-	assert(m_VertexCount >= 3 && "Vertex count must be at least 3");
+	if (m_HasIndexBuffer)
+	{
+		const FMeshLod& lod = m_Lods[lodIndex];
+		return VkDrawIndexedIndirectCommand{lod.indexCount, instanceCount, m_IndexRange.first + lod.firstIndex, static_cast<int32_t>(m_VertexRange.first), firstInstance};
+	}
+	return VkDrawIndexedIndirectCommand{m_VertexCount, instanceCount, m_VertexRange.first, 0, firstInstance};
+}
+
+VkDrawIndexedIndirectCommand SEMesh::get_index_range_command(uint32_t firstIndex, uint32_t indexCount, uint32_t instanceCount, uint32_t firstInstance) const
+{
+	return VkDrawIndexedIndirectCommand{indexCount, instanceCount, m_IndexRange.first + firstIndex, static_cast<int32_t>(m_VertexRange.first), firstInstance};
+}
+
+VkBuffer SEMesh::get_vertex_buffer() const
+{
+	return m_VertexBuffer ? m_VertexBuffer->get_buffer() : m_GraphicsDevice.get_geometry_pool().get_vertex_buffer();
+}
+
+VkBuffer SEMesh::get_index_buffer() const
+{
+	if (!m_HasIndexBuffer) { return VK_NULL_HANDLE; }
+	return m_IndexBuffer ? m_IndexBuffer->get_buffer() : m_GraphicsDevice.get_geometry_pool().get_index_buffer();
+}
 
-	VkDeviceSize bufferSize = sizeof(vertices[0]) * m_VertexCount;
+void SEMesh::create_vertex_buffers(const void* vertexData, uint32_t vertexCount, uint32_t vertexSize)
+{
+	m_VertexCount = vertexCount;
+	assert(m_VertexCount >= 3 && "Vertex count must be at least 3");
 
-	// Create staging buffer
-	uint32_t vertexSize = sizeof(vertices[0]);
-	SEBuffer stagingBuffer{ m_GraphicsDevice, vertexSize, m_VertexCount, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT };
-	stagingBuffer.map();
-	stagingBuffer.write_to_buffer((void*)vertices.data());
+	VkDeviceSize bufferSize = static_cast<VkDeviceSize>(vertexSize) * m_VertexCount;
 
-	// Create vertex buffer
-	m_VertexBuffer = std::make_unique<SEBuffer>(m_GraphicsDevice, vertexSize, m_VertexCount, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+	// Vertices go to the shared pool, a mesh only gets its own vertex buffer when the pool is full
+	SEGeometryPool& geometryPool = m_GraphicsDevice.get_geometry_pool();
+	VkBuffer dstBuffer;
+	VkDeviceSize dstOffset = 0;
+	char* dstMemory = nullptr;
+	if (geometryPool.allocate_vertices(m_VertexCount, vertexSize, m_VertexRange))
+	{
+		dstBuffer = geometryPool.get_vertex_buffer();
+		dstOffset = SEGeometryPool::get_byte_offset(m_VertexRange, vertexSize);
+		dstMemory = static_cast<char*>(geometryPool.get_vertex_memory());
+	}
+	else
+	{
+		m_VertexBuffer = create_static_buffer(vertexSize, m_VertexCount, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
+		dstBuffer = m_VertexBuffer->get_buffer();
+		dstMemory = static_cast<char*>(m_VertexBuffer->get_mapped_memory());
+	}
 
-	m_GraphicsDevice.copy_buffer(stagingBuffer.get_buffer(), m_VertexBuffer->get_buffer(), bufferSize);
+	// Unified memory is written in place, the next queue submission makes the coherent writes visible
+	if (dstMemory != nullptr)
+	{
+		memcpy(dstMemory + dstOffset, vertexData, bufferSize);
+		return;
+	}
+	m_UploadTicket = m_GraphicsDevice.get_staging_ring().upload_to_buffer(vertexData, bufferSize, dstBuffer, dstOffset);
 }
 
-void SEMesh::create_index_buffers(const std::vector<uint32_t>& indices)
+void SEMesh::create_index_buffers(const uint32_t* indices, uint32_t indexCount)
 {
-	m_IndexCount = static_cast<uint32_t>(indices.size());
+	m_IndexCount = indexCount;
 	m_HasIndexBuffer = (m_IndexCount > 0);
 	if (!m_HasIndexBuffer) { return; }
 
-	VkDeviceSize bufferSize = sizeof(indices[0]) * m_IndexCount;
+	// 16-bit indices halve the index buffer and the index fetch whenever every vertex is addressable
+	m_IndexType = m_VertexCount <= MAX_UINT16_INDEXED_VERTICES ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+	uint32_t indexSize = get_index_size(m_IndexType);
+	VkDeviceSize bufferSize = static_cast<VkDeviceSize>(indexSize) * m_IndexCount;
 
-	// Create staging buffer
-	uint32_t indexSize = sizeof(indices[0]);
-	SEBuffer stagingBuffer{ m_GraphicsDevice, indexSize, m_IndexCount, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT };
-	stagingBuffer.map();
-	stagingBuffer.write_to_buffer((void*)indices.data());
+	SEGeometryPool& geometryPool = m_GraphicsDevice.get_geometry_pool();
+	VkBuffer dstBuffer;
+	VkDeviceSize dstOffset = 0;
+	char* dstMemory = nullptr;
+	if (geometryPool.allocate_indices(m_IndexCount, indexSize, m_IndexRange))
+	{
+		dstBuffer = geometryPool.get_index_buffer();
+		dstOffset = SEGeometryPool::get_byte_offset(m_IndexRange, indexSize);
+		dstMemory = static_cast<char*>(geometryPool.get_index_memory());
+	}
+	else
+	{
+		m_IndexBuffer = create_static_buffer(indexSize, m_IndexCount, VK_BUFFER_USAGE_INDEX_BUFFER_BIT);
+		dstBuffer = m_IndexBuffer->get_buffer();
+		dstMemory = static_cast<char*>(m_IndexBuffer->get_mapped_memory());
+	}
 
-	// Create index buffer
-	m_IndexBuffer = std::make_unique<SEBuffer>(m_GraphicsDevice, indexSize, m_IndexCount, VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+	if (m_IndexType == VK_INDEX_TYPE_UINT32)
+	{
+		if (dstMemory != nullptr)
+		{
+			memcpy(dstMemory + dstOffset, indices, bufferSize);
+			return;
+		}
+		m_UploadTicket = m_GraphicsDevice.get_staging_ring().upload_to_buffer(indices, bufferSize, dstBuffer, dstOffset);
+		return;
+	}
 
-	m_GraphicsDevice.copy_buffer(stagingBuffer.get_buffer(), m_IndexBuffer->get_buffer(), bufferSize);
+	// Narrowed straight into unified memory, or into a temporary for the staging ring
+	std::vector<uint16_t> shortIndices{};
+	uint16_t* shortIndexData = reinterpret_cast<uint16_t*>(dstMemory + dstOffset);
+	if (dstMemory == nullptr)
+	{
+		shortIndices.resize(m_IndexCount);
+		shortIndexData = shortIndices.data();
+	}
+	for (uint32_t index = 0; index < m_IndexCount; index++)
+	{
+		shortIndexData[index] = static_cast<uint16_t>(indices[index]);
+	}
+	if (dstMemory == nullptr)
+	{
+		m_UploadTicket = m_GraphicsDevice.get_staging_ring().upload_to_buffer(shortIndices.data(), bufferSize, dstBuffer, dstOffset);
+	}
+}
+
+std::unique_ptr<SEBuffer> SEMesh::create_static_buffer(uint32_t elementSize, uint32_t elementCount, VkBufferUsageFlags usage)
+{
+	const VkMemoryPropertyFlags memoryProperties = m_GraphicsDevice.get_static_buffer_memory_properties();
+	std::unique_ptr<SEBuffer> buffer = std::make_unique<SEBuffer>(m_GraphicsDevice, elementSize, elementCount, usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT, memoryProperties, EMemoryCategory::Geometry);
+	if (memoryProperties & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+	{
+		buffer->map();
+	}
+	return buffer;
+}
+
+void SEMesh::draw_index_range(VkCommandBuffer commandBuffer, uint32_t firstIndex, uint32_t indexCount, uint32_t instanceCount, uint32_t firstInstance)
+{
+	vkCmdDrawIndexed(commandBuffer, indexCount, instanceCount, m_IndexRange.first + firstIndex, static_cast<int32_t>(m_VertexRange.first), firstInstance);
+}
+
+void SEMesh::set_lods(const FMeshLod* lods, uint32_t lodCount)
+{
+	if (lods != nullptr && lodCount > 0)
+	{
+		m_Lods.assign(lods, lods + lodCount);
+		return;
+	}
+	m_Lods.assign(1, FMeshLod{0, m_IndexCount, 0.0f});
+}
+
+void SEMesh::compute_bounds(const Vertex* vertices, uint32_t vertexCount)
+{
+	if (vertexCount == 0) { return; }
+
+	m_BoundsMin = vertices[0].position;
+	m_BoundsMax = vertices[0].position;
+	for (uint32_t vertexIndex = 1; vertexIndex < vertexCount; vertexIndex++)
+	{
+		m_BoundsMin = glm::min(m_BoundsMin, vertices[vertexIndex].position);
+		m_BoundsMax = glm::max(m_BoundsMax, vertices[vertexIndex].position);
+	}
+
+	// Centered on the bounding box, not minimal but cheap and stable
+	const glm::vec3 center = (m_BoundsMin + m_BoundsMax) * 0.5f;
+	float radiusSquared = 0.0f;
+	for (uint32_t vertexIndex = 0; vertexIndex < vertexCount; vertexIndex++)
+	{
+		const glm::vec3 offset = vertices[vertexIndex].position - center;
+		radiusSquared = std::max(radiusSquared, glm::dot(offset, offset));
+	}
+	m_BoundingSphere = glm::vec4{center, std::sqrt(radiusSquared)};
 }
 
 std::vector<VkVertexInputBindingDescription> SEMesh::Vertex::get_binding_descriptions()
@@ -205,4 +900,124 @@ std::vector<VkVertexInputAttributeDescription> SEMesh::Vertex::get_attribute_des
 	return attributeDescriptions;
 }
 
+std::vector<VkVertexInputBindingDescription> SEMesh::PackedVertex::get_binding_descriptions()
+{
+	std::vector<VkVertexInputBindingDescription> bindingDescriptions(1);
+	bindingDescriptions[0].binding = 0;
+	bindingDescriptions[0].stride = sizeof(PackedVertex);
+	bindingDescriptions[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+	return bindingDescriptions;
+}
+
+std::vector<VkVertexInputAttributeDescription> SEMesh::PackedVertex::get_attribute_descriptions()
+{
+	std::vector<VkVertexInputAttributeDescription> attributeDescriptions{};
+
+	attributeDescriptions.push_back({ 0, 0, VK_FORMAT_R16G16B16A16_SNORM, offsetof(PackedVertex, position) });
+	attributeDescriptions.push_back({ 1, 0, VK_FORMAT_R8G8B8A8_UNORM, offsetof(PackedVertex, color) });
+	attributeDescriptions.push_back({ 2, 0, VK_FORMAT_R16G16_SNORM, offsetof(PackedVertex, normal) });
+	attributeDescriptions.push_back({ 3, 0, VK_FORMAT_R16G16_SFLOAT, offsetof(PackedVertex, texCoord) });
+
+	return attributeDescriptions;
+}
+
+std::vector<VkVertexInputBindingDescription> SEMesh::get_binding_descriptions(EVertexFormat vertexFormat)
+{
+	return vertexFormat == EVertexFormat::Packed ? PackedVertex::get_binding_descriptions() : Vertex::get_binding_descriptions();
+}
+
+std::vector<VkVertexInputAttributeDescription> SEMesh::get_attribute_descriptions(EVertexFormat vertexFormat)
+{
+	return vertexFormat == EVertexFormat::Packed ? PackedVertex::get_attribute_descriptions() : Vertex::get_attribute_descriptions();
+}
+
+uint32_t SEMesh::get_vertex_stride(EVertexFormat vertexFormat)
+{
+	return vertexFormat == EVertexFormat::Packed ? sizeof(PackedVertex) : sizeof(Vertex);
+}
+
+uint64_t SEMesh::get_format_content_hash(uint64_t contentHash, EVertexFormat vertexFormat)
+{
+	return vertexFormat == EVertexFormat::Full ? contentHash : hash_mix(contentHash + static_cast<uint64_t>(vertexFormat));
+}
+
+static int16_t quantize_snorm16(float value)
+{
+	return static_cast<int16_t>(std::lround(std::clamp(value, -1.0f, 1.0f) * 32767.0f));
+}
+
+static uint8_t quantize_unorm8(float value)
+{
+	return static_cast<uint8_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * 255.0f));
+}
+
+// Octahedral mapping of a unit vector onto [-1, 1]^2, decoded by basic_shader_packed.vert
+static glm::vec2 encode_octahedral(glm::vec3 normal)
+{
+	const float length = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+	if (length == 0.0f) { return glm::vec2{0.0f}; }
+
+	glm::vec2 encoded{normal.x / length, normal.y / length};
+	if (normal.z < 0.0f)
+	{
+		encoded = glm::vec2{
+			(1.0f - std::abs(encoded.y)) * (encoded.x >= 0.0f ? 1.0f : -1.0f),
+			(1.0f - std::abs(encoded.x)) * (encoded.y >= 0.0f ? 1.0f : -1.0f)
+		};
+	}
+	return encoded;
+}
+
+glm::mat4 SEMesh::pack_vertices(const Vertex* vertices, uint32_t vertexCount, std::vector<PackedVertex>& packedVertices)
+{
+	glm::vec3 boundsMin{std::numeric_limits<float>::max()};
+	glm::vec3 boundsMax{std::numeric_limits<float>::lowest()};
+	for (uint32_t vertexIndex = 0; vertexIndex < vertexCount; vertexIndex++)
+	{
+		boundsMin = glm::min(boundsMin, vertices[vertexIndex].position);
+		boundsMax = glm::max(boundsMax, vertices[vertexIndex].position);
+	}
+	if (vertexCount == 0) { boundsMin = boundsMax = glm::vec3{0.0f}; }
+
+	// Flat axes keep a unit extent so the division below stays finite
+	const glm::vec3 center = (boundsMin + boundsMax) * 0.5f;
+	glm::vec3 halfExtent = (boundsMax - boundsMin) * 0.5f;
+	for (int axis = 0; axis < 3; axis++)
+	{
+		if (halfExtent[axis] <= 0.0f) { halfExtent[axis] = 1.0f; }
+	}
+
+	packedVertices.resize(vertexCount);
+	for (uint32_t vertexIndex = 0; vertexIndex < vertexCount; vertexIndex++)
+	{
+		const Vertex& vertex = vertices[vertexIndex];
+		PackedVertex& packedVertex = packedVertices[vertexIndex];
+
+		const glm::vec3 position = (vertex.position - center) / halfExtent;
+		packedVertex.position[0] = quantize_snorm16(position.x);
+		packedVertex.position[1] = quantize_snorm16(position.y);
+		packedVertex.position[2] = quantize_snorm16(position.z);
+		packedVertex.position[3] = 0;
+
+		packedVertex.color[0] = quantize_unorm8(vertex.color.x);
+		packedVertex.color[1] = quantize_unorm8(vertex.color.y);
+		packedVertex.color[2] = quantize_unorm8(vertex.color.z);
+		packedVertex.color[3] = 255;
+
+		const glm::vec2 normal = encode_octahedral(vertex.normal);
+		packedVertex.normal[0] = quantize_snorm16(normal.x);
+		packedVertex.normal[1] = quantize_snorm16(normal.y);
+
+		packedVertex.texCoord[0] = glm::packHalf1x16(vertex.texCoord.x);
+		packedVertex.texCoord[1] = glm::packHalf1x16(vertex.texCoord.y);
+	}
+
+	glm::mat4 dequantizationMatrix{1.0f};
+	dequantizationMatrix[0][0] = halfExtent.x;
+	dequantizationMatrix[1][1] = halfExtent.y;
+	dequantizationMatrix[2][2] = halfExtent.z;
+	dequantizationMatrix[3] = glm::vec4{center, 1.0f};
+	return dequantizationMatrix;
+}
+
 } // end namespace SE
\ No newline at end of file
@@ -2,16 +2,29 @@
 
 #include "SERendering/SEGraphicsDevice/SEGraphicsDevice.hpp"
 #include "SERendering/SEBuffer.hpp"
+#include "SERendering/SEGeometryPool.hpp"
+#include "SERendering/SEStagingRing.hpp"
+#include "SECore/SEUtilities/SEMappedFile.hpp"
 
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
 #include <glm/glm.hpp>
 
+#include <atomic>
 #include <vector>
 #include <memory>
+#include <string>
 
 namespace SE {
 
+	// Layout of a mesh's vertex buffer, render systems keep one pipeline per format
+	enum class EVertexFormat : uint8_t {
+		Full,		// SEMesh::Vertex, 44 bytes of floats
+		Packed		// SEMesh::PackedVertex, 20 bytes
+	};
+
+	static constexpr uint32_t VERTEX_FORMAT_COUNT = 2;
+
 	class SEMesh {
 
 	public:
@@ -31,42 +44,226 @@ namespace SE {
 			}
 		};
 
+		// Quantized vertex. Positions are snorm16 inside the mesh bounds and expanded by the dequantization matrix,
+		// normals are octahedral snorm16, colors unorm8 and texture coordinates half floats
+		struct PackedVertex {
+			int16_t position[4];	// w unused, keeps the normal 4 byte aligned
+			uint8_t color[4];		// alpha unused
+			int16_t normal[2];
+			uint16_t texCoord[2];
+
+			static std::vector<VkVertexInputBindingDescription> get_binding_descriptions();
+			static std::vector<VkVertexInputAttributeDescription> get_attribute_descriptions();
+		};
+
+		// Range of the index buffer drawn for one level of detail. All levels share the vertex buffer
+		struct FMeshLod {
+			uint32_t firstIndex;
+			uint32_t indexCount;
+			float error;	// Simplification error in mesh space units, 0 for the full detail level
+		};
+
+		// Cluster of at most MAX_MESHLET_VERTICES vertices and MAX_MESHLET_TRIANGLES triangles of the full detail level,
+		// a contiguous range of the index buffer. Bounds are in mesh space
+		struct FMeshlet {
+			glm::vec4 boundingSphere;	// xyz is the center and w the radius
+			glm::vec3 coneAxis;			// Average triangle normal
+			float coneCutoff;			// 1 when the triangles face too many directions to be back-facing together
+			uint32_t firstIndex;
+			uint32_t triangleCount;
+		};
+
 		struct Builder {
 			std::vector<Vertex> vertices;
 			std::vector<uint32_t> indices;
+			std::vector<FMeshLod> lods;	// Empty means one level covering all indices
+			std::vector<FMeshlet> meshlets;
+
+			// Appends simplified index lists for coarser levels of detail to indices, each targeting half the
+			// triangles of the previous level. Stops early once simplification stalls on borders and seams
+			void build_lod_chain();
+
+			// Post-process for loaded meshes. Reorders the triangles of each level for the post-transform vertex cache
+			// and less overdraw, then renumbers vertices in first use order for fetch locality. Drops unreferenced vertices
+			void optimize();
+
+			// Splits the full detail level into meshlets in its current triangle order, so run it after optimize.
+			// Only meshes with at least MIN_MESHLET_MESH_TRIANGLES triangles are split
+			void build_meshlets();
+		};
+
+		// Header of a cooked .semesh file. The vertex array follows the header, the index array follows the vertices
+		struct FCookedMeshHeader {
+			uint32_t magic;
+			uint32_t layoutVersion;
+			uint32_t vertexStride;
+			uint32_t vertexCount;
+			uint32_t indexCount;
+			uint32_t lodCount;	// The LOD table follows the indices
+			uint64_t contentHash;
+			uint32_t meshletCount;	// The meshlet table follows the LOD table
+			uint32_t reserved;
+		};
+
+		// CPU side of a mesh load, either a mapped cooked file or a freshly parsed builder. The arrays point into one of them
+		struct FMeshSourceData {
+			std::unique_ptr<SEMappedFile> cookedFile{};
+			Builder builder{};
+			const Vertex* vertices = nullptr;
+			uint32_t vertexCount = 0;
+			const uint32_t* indices = nullptr;
+			uint32_t indexCount = 0;
+			const FMeshLod* lods = nullptr;
+			uint32_t lodCount = 0;
+			const FMeshlet* meshlets = nullptr;
+			uint32_t meshletCount = 0;
+			uint64_t contentHash = 0;
 		};
 
+		static constexpr uint32_t COOKED_MESH_MAGIC = 0x48534553; // "SESH"
+		static constexpr uint32_t COOKED_MESH_LAYOUT_VERSION = 4;	// 2: optimized triangle and vertex order, 3: LOD table, 4: meshlets
+
+		// LOD chain generation
+		static constexpr uint32_t MAX_LOD_COUNT = 5;
+		static constexpr float LOD_TRIANGLE_RATIO = 0.5f;
+		static constexpr uint32_t MIN_LOD_TRIANGLES = 64;
+		static constexpr float MAX_LOD_ERROR = 0.05f;		// Relative to the mesh extent
+
+		// Meshlet generation
+		static constexpr uint32_t MAX_MESHLET_VERTICES = 64;
+		static constexpr uint32_t MAX_MESHLET_TRIANGLES = 124;
+		static constexpr uint32_t MIN_MESHLET_MESH_TRIANGLES = 4096;
+		// Cones wider than this (cosine of the spread) are never culled
+		static constexpr float MESHLET_CONE_MIN_DOT = 0.1f;
+		static constexpr const char* COOKED_MESH_EXTENSION = ".semesh";
+
 #pragma region Lifecycle
 		SEMesh(SEGraphicsDevice& device, const SEMesh::Builder& builder);
+		SEMesh(SEGraphicsDevice& device, const Vertex* vertices, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount, const FMeshLod* lods = nullptr, uint32_t lodCount = 0,
+			const FMeshlet* meshlets = nullptr, uint32_t meshletCount = 0);
+		SEMesh(SEGraphicsDevice& device, const FMeshSourceData& sourceData, EVertexFormat vertexFormat = EVertexFormat::Full);
 		~SEMesh();
 		SEMesh(const SEMesh&) = delete;
 		SEMesh& operator=(const SEMesh&) = delete;
 #pragma endregion Lifecycle
 
-		// Load a model from a file
-		static std::unique_ptr<SEMesh> create_model_from_file(SEGraphicsDevice& device, const std::string& filepath);
+		// Load a model from a file, using the cooked .semesh next to it when it is up to date
+		static std::unique_ptr<SEMesh> create_model_from_file(SEGraphicsDevice& device, const std::string& filepath, EVertexFormat vertexFormat = EVertexFormat::Full);
+		// Loads the vertex and index data of a model without touching the GPU. Throws on parse errors
+		static void load_source_data(const std::string& filepath, FMeshSourceData& sourceData);
 		static void load_mesh_from_file(Builder& builder, const std::string& filepath);
 
+		// Cooked mesh format
+		static std::string get_cooked_filepath(const std::string& filepath);
+		static bool save_cooked_mesh(const Builder& builder, const std::string& cookedFilepath);
+		static bool load_cooked_mesh(Builder& builder, const std::string& cookedFilepath);
+		static uint64_t compute_content_hash(const Vertex* vertices, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount);
+
+		// Vertex input layout of a format, used by SERenderPipeline
+		static std::vector<VkVertexInputBindingDescription> get_binding_descriptions(EVertexFormat vertexFormat);
+		static std::vector<VkVertexInputAttributeDescription> get_attribute_descriptions(EVertexFormat vertexFormat);
+		static uint32_t get_vertex_stride(EVertexFormat vertexFormat);
+
+		// Quantizes vertices into the packed format. Returns the matrix that maps packed positions back to mesh space
+		static glm::mat4 pack_vertices(const Vertex* vertices, uint32_t vertexCount, std::vector<PackedVertex>& packedVertices);
+
+		// Content hash that also identifies the vertex format, so caches keep packed and full copies apart
+		static uint64_t get_format_content_hash(uint64_t contentHash, EVertexFormat vertexFormat);
+
+		// Times the OBJ parse path against the cooked path for the same asset and prints the results
+		static void benchmark_load_paths(const std::string& filepath, uint32_t iterations = 10);
+
+		// Times vertex deduplication of an asset with std::unordered_map against SEVertexDedupTable and prints the results
+		static void benchmark_vertex_dedup(const std::string& filepath, uint32_t iterations = 10);
+
+		// Runs each Builder::optimize pass on an asset and prints the time and average cache miss ratio after each pass,
+		// then the levels Builder::build_lod_chain generates
+		static void benchmark_mesh_optimization(const std::string& filepath);
+
+		// Times uploads of an asset's vertices and indices into the geometry pool through the staging ring, and with
+		// unified memory through direct writes, then prints the throughput of each path
+		static void benchmark_upload_paths(SEGraphicsDevice& device, const std::string& filepath, uint32_t iterations = 20);
+
 		void bind_command_buffer(VkCommandBuffer commandBuffer);
-		void draw(VkCommandBuffer commandBuffer);
+		// Instances read their per-instance vertex attributes from firstInstance onwards
+		void draw(VkCommandBuffer commandBuffer, uint32_t lodIndex = 0, uint32_t instanceCount = 1, uint32_t firstInstance = 0);
+		// Draws part of the index buffer, used for the meshlet ranges that survive culling
+		void draw_index_range(VkCommandBuffer commandBuffer, uint32_t firstIndex, uint32_t indexCount, uint32_t instanceCount = 1, uint32_t firstInstance = 0);
+
+		// Parameters of the draw and draw_index_range calls above, for indirect submission. Meshes without an index buffer
+		// hold the vertex count in indexCount and the first vertex in firstIndex, they are drawn with vkCmdDraw
+		VkDrawIndexedIndirectCommand get_draw_command(uint32_t lodIndex, uint32_t instanceCount, uint32_t firstInstance) const;
+		VkDrawIndexedIndirectCommand get_index_range_command(uint32_t firstIndex, uint32_t indexCount, uint32_t instanceCount, uint32_t firstInstance) const;
+		bool has_index_buffer() const { return m_HasIndexBuffer; }
+
+		uint32_t get_lod_count() const { return static_cast<uint32_t>(m_Lods.size()); }
+		const FMeshLod& get_lod(uint32_t lodIndex) const { return m_Lods[lodIndex]; }
+		uint32_t get_triangle_count(uint32_t lodIndex = 0) const { return m_HasIndexBuffer ? m_Lods[lodIndex].indexCount / 3 : m_VertexCount / 3; }
+		// Empty for meshes that were not split, meshlets only cover the full detail level
+		const std::vector<FMeshlet>& get_meshlets() const { return m_Meshlets; }
+		// Mesh space bounding sphere, xyz is the center and w the radius
+		const glm::vec4& get_bounding_sphere() const { return m_BoundingSphere; }
+		// Mesh space axis aligned bounding box
+		const glm::vec3& get_bounds_min() const { return m_BoundsMin; }
+		const glm::vec3& get_bounds_max() const { return m_BoundsMax; }
+
+		uint64_t get_content_hash() const { return m_ContentHash; }
+		// Sequential number given at creation, orders draws by mesh in sort keys
+		uint32_t get_sort_id() const { return m_SortId; }
+		EVertexFormat get_vertex_format() const { return m_VertexFormat; }
+		// Identity for full vertices, applied to the mesh matrix for packed vertices
+		const glm::mat4& get_dequantization_matrix() const { return m_DequantizationMatrix; }
+		VkIndexType get_index_type() const { return m_IndexType; }
+		// False until the staging ring has submitted the mesh's upload, drawing before then reads stale memory. Always
+		// true for meshes written in place on unified memory devices
+		bool is_upload_submitted() const { return m_GraphicsDevice.get_staging_ring().is_submitted(m_UploadTicket); }
+		// Buffers the mesh draws from, the geometry pool's unless the pool was full at load
+		VkBuffer get_vertex_buffer() const;
+		VkBuffer get_index_buffer() const;
+		// Bytes of device memory held by the vertex and index buffers
+		VkDeviceSize get_resident_bytes() const { return static_cast<VkDeviceSize>(m_VertexCount) * get_vertex_stride(m_VertexFormat) + static_cast<VkDeviceSize>(m_IndexCount) * get_index_size(m_IndexType); }
+
+		static uint32_t get_index_size(VkIndexType indexType) { return indexType == VK_INDEX_TYPE_UINT16 ? sizeof(uint16_t) : sizeof(uint32_t); }
+		// Primitive restart is off, so every 16-bit value is a usable index
+		static constexpr uint32_t MAX_UINT16_INDEXED_VERTICES = 1u << 16;
 
 
 	private:
 
-		void create_vertex_buffers(const std::vector<Vertex>& verticies);
-		void create_index_buffers(const std::vector<uint32_t>& indicies);
+		void create_vertex_buffers(const void* vertexData, uint32_t vertexCount, uint32_t vertexSize);
+		void create_index_buffers(const uint32_t* indices, uint32_t indexCount);
+		// Own buffer of a mesh that did not fit the geometry pool, mapped on unified memory devices
+		std::unique_ptr<SEBuffer> create_static_buffer(uint32_t elementSize, uint32_t elementCount, VkBufferUsageFlags usage);
+		void set_lods(const FMeshLod* lods, uint32_t lodCount);
+		void compute_bounds(const Vertex* vertices, uint32_t vertexCount);
 
 
 		// Graphics Device
-		SEGraphicsDevice m_GraphicsDevice;
+		SEGraphicsDevice& m_GraphicsDevice;
 
-		// Vertex Buffer
+		// Vertex Buffer, null while the vertices live in the geometry pool
 		std::unique_ptr<SEBuffer> m_VertexBuffer;
+		FGeometryRange m_VertexRange{};
 		uint32_t m_VertexCount;
 
 		// Index Buffer
 		bool m_HasIndexBuffer{false};
 		std::unique_ptr<SEBuffer> m_IndexBuffer;
+		FGeometryRange m_IndexRange{};
 		uint32_t m_IndexCount;
+		VkIndexType m_IndexType{VK_INDEX_TYPE_UINT32};
+		std::vector<FMeshLod> m_Lods{};
+		std::vector<FMeshlet> m_Meshlets{};
+		glm::vec4 m_BoundingSphere{0.0f};
+		glm::vec3 m_BoundsMin{0.0f};
+		glm::vec3 m_BoundsMax{0.0f};
+
+		uint64_t m_ContentHash{0};
+		uint64_t m_UploadTicket{0};
+		EVertexFormat m_VertexFormat{EVertexFormat::Full};
+		glm::mat4 m_DequantizationMatrix{1.0f};
+
+		inline static std::atomic<uint32_t> s_NextSortId{0};
+		const uint32_t m_SortId{s_NextSortId.fetch_add(1, std::memory_order_relaxed)};
 	};
 } // end namespace SE
\ No newline at end of file
@@ -0,0 +1,362 @@
+#include "SETexture.hpp"
+#include "SECore/SEAssets/SETgaParser.hpp"
+#include "SECore/SEUtilities/SEFileUtilities.hpp"
+#include "SERendering/SEBuffer.hpp"
+
+#include <cassert>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+
+namespace SE {
+
+// Returns the header of a mapped cooked texture, or nullptr when the file is not a cooked texture of the current layout
+static const SETexture::FCookedTextureHeader* get_cooked_texture_header(const SEMappedFile& cookedFile)
+{
+	if (!cookedFile.is_valid() || cookedFile.get_size() < sizeof(SETexture::FCookedTextureHeader)) { return nullptr; }
+
+	const SETexture::FCookedTextureHeader* header = reinterpret_cast<const SETexture::FCookedTextureHeader*>(cookedFile.get_data());
+	if (header->magic != SETexture::COOKED_TEXTURE_MAGIC || header->layoutVersion != SETexture::COOKED_TEXTURE_LAYOUT_VERSION || header->format != static_cast<uint32_t>(SETexture::TEXTURE_FORMAT)
+		|| header->width == 0 || header->height == 0 || header->mipCount != SETexture::get_mip_count(header->width, header->height))
+	{
+		return nullptr;
+	}
+
+	const size_t mipTableEnd = sizeof(SETexture::FCookedTextureHeader) + static_cast<size_t>(header->mipCount) * sizeof(SETexture::FCookedMip);
+	if (cookedFile.get_size() < mipTableEnd) { return nullptr; }
+
+	const SETexture::FCookedMip* mips = reinterpret_cast<const SETexture::FCookedMip*>(cookedFile.get_data() + sizeof(SETexture::FCookedTextureHeader));
+	for (uint32_t mipLevel = 0; mipLevel < header->mipCount; mipLevel++)
+	{
+		const SETexture::FCookedMip& mip = mips[mipLevel];
+		if (mip.width != SETexture::get_mip_extent(header->width, mipLevel) || mip.height != SETexture::get_mip_extent(header->height, mipLevel)
+			|| mip.size != static_cast<uint64_t>(mip.width) * mip.height * SETexture::BYTES_PER_TEXEL || mip.offset < mipTableEnd || mip.offset + mip.size > cookedFile.get_size())
+		{
+			return nullptr;
+		}
+	}
+	return header;
+}
+
+static bool is_cooked_texture_current(const std::string& filepath, const std::string& cookedFilepath)
+{
+	std::error_code errorCode;
+	if (!std::filesystem::exists(cookedFilepath, errorCode)) { return false; }
+	if (filepath == cookedFilepath || !std::filesystem::exists(filepath, errorCode)) { return true; }
+
+	return std::filesystem::last_write_time(cookedFilepath, errorCode) >= std::filesystem::last_write_time(filepath, errorCode);
+}
+
+static void transition_mip_levels(VkCommandBuffer commandBuffer, VkImage image, uint32_t baseMip, uint32_t mipCount, VkImageLayout oldLayout, VkImageLayout newLayout,
+	VkAccessFlags srcAccessMask, VkAccessFlags dstAccessMask, VkPipelineStageFlags srcStageMask, VkPipelineStageFlags dstStageMask)
+{
+	VkImageMemoryBarrier barrier{};
+	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	barrier.srcAccessMask = srcAccessMask;
+	barrier.dstAccessMask = dstAccessMask;
+	barrier.oldLayout = oldLayout;
+	barrier.newLayout = newLayout;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.image = image;
+	barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	barrier.subresourceRange.baseMipLevel = baseMip;
+	barrier.subresourceRange.levelCount = mipCount;
+	barrier.subresourceRange.baseArrayLayer = 0;
+	barrier.subresourceRange.layerCount = 1;
+
+	vkCmdPipelineBarrier(commandBuffer, srcStageMask, dstStageMask, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+}
+
+static VkBufferImageCopy make_mip_copy(VkDeviceSize bufferOffset, uint32_t mipLevel, uint32_t width, uint32_t height)
+{
+	VkBufferImageCopy region{};
+	region.bufferOffset = bufferOffset;
+	region.bufferRowLength = 0;
+	region.bufferImageHeight = 0;
+	region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	region.imageSubresource.mipLevel = mipLevel;
+	region.imageSubresource.baseArrayLayer = 0;
+	region.imageSubresource.layerCount = 1;
+	region.imageOffset = { 0, 0, 0 };
+	region.imageExtent = { width, height, 1 };
+	return region;
+}
+
+#pragma region Lifecycle
+SETexture::SETexture(SEGraphicsDevice& device, const FTextureSourceData& sourceData, uint32_t firstMip, const FSamplerDesc& samplerDesc) : m_GraphicsDevice(device)
+{
+	assert(firstMip < sourceData.mipCount && "First mip outside the chain");
+
+	m_FirstMip = firstMip;
+	create_image(sourceData.mips[firstMip].width, sourceData.mips[firstMip].height, sourceData.mipCount - firstMip, VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT);
+
+	// Levels are tightly packed in the cooked file, so they are staged in one copy and uploaded with one region each
+	const uint64_t firstOffset = sourceData.mips[firstMip].offset;
+	const uint64_t lastOffset = sourceData.mips[sourceData.mipCount - 1].offset + sourceData.mips[sourceData.mipCount - 1].size;
+	SEBuffer stagingBuffer{m_GraphicsDevice, 1, static_cast<uint32_t>(lastOffset - firstOffset), VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, EMemoryCategory::Staging};
+	stagingBuffer.map();
+	stagingBuffer.write_to_buffer(const_cast<uint8_t*>(sourceData.get_mip_data(firstMip)));
+
+	std::vector<VkBufferImageCopy> regions{};
+	regions.reserve(m_MipCount);
+	for (uint32_t mipLevel = firstMip; mipLevel < sourceData.mipCount; mipLevel++)
+	{
+		const FCookedMip& mip = sourceData.mips[mipLevel];
+		regions.push_back(make_mip_copy(mip.offset - firstOffset, mipLevel - firstMip, mip.width, mip.height));
+	}
+
+	VkCommandBuffer commandBuffer = m_GraphicsDevice.begin_single_time_commands();
+	transition_mip_levels(commandBuffer, m_Image, 0, m_MipCount, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+		0, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+	vkCmdCopyBufferToImage(commandBuffer, stagingBuffer.get_buffer(), m_Image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, static_cast<uint32_t>(regions.size()), regions.data());
+	transition_mip_levels(commandBuffer, m_Image, 0, m_MipCount, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+		VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+	m_GraphicsDevice.end_single_time_commands(commandBuffer);
+
+	create_image_view();
+	m_Sampler = m_GraphicsDevice.get_sampler_cache().get_sampler(samplerDesc);
+}
+
+SETexture::SETexture(SEGraphicsDevice& device, const uint8_t* texels, uint32_t width, uint32_t height, bool bGenerateMips, const FSamplerDesc& samplerDesc) : m_GraphicsDevice(device)
+{
+	// Blits read the previous level of the same image, and cooking reads the chain back
+	create_image(width, height, bGenerateMips ? get_mip_count(width, height) : 1, VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT);
+
+	const VkDeviceSize levelBytes = static_cast<VkDeviceSize>(width) * height * BYTES_PER_TEXEL;
+	SEBuffer stagingBuffer{m_GraphicsDevice, 1, static_cast<uint32_t>(levelBytes), VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, EMemoryCategory::Staging};
+	stagingBuffer.map();
+	stagingBuffer.write_to_buffer(const_cast<uint8_t*>(texels));
+
+	const VkBufferImageCopy region = make_mip_copy(0, 0, width, height);
+
+	VkCommandBuffer commandBuffer = m_GraphicsDevice.begin_single_time_commands();
+	transition_mip_levels(commandBuffer, m_Image, 0, m_MipCount, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+		0, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+	vkCmdCopyBufferToImage(commandBuffer, stagingBuffer.get_buffer(), m_Image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+	generate_mipmaps(m_GraphicsDevice, commandBuffer, m_Image, width, height, m_MipCount);
+	m_GraphicsDevice.end_single_time_commands(commandBuffer);
+
+	create_image_view();
+	m_Sampler = m_GraphicsDevice.get_sampler_cache().get_sampler(samplerDesc);
+}
+
+SETexture::~SETexture()
+{
+	vkDestroyImageView(m_GraphicsDevice.device(), m_ImageView, nullptr);
+	vkDestroyImage(m_GraphicsDevice.device(), m_Image, nullptr);
+	m_GraphicsDevice.free_memory(m_Allocation);
+}
+#pragma endregion Lifecycle
+
+void SETexture::create_image(uint32_t width, uint32_t height, uint32_t mipCount, VkImageUsageFlags usage)
+{
+	m_Width = width;
+	m_Height = height;
+	m_MipCount = mipCount;
+
+	VkImageCreateInfo imageInfo{};
+	imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+	imageInfo.imageType = VK_IMAGE_TYPE_2D;
+	imageInfo.extent.width = width;
+	imageInfo.extent.height = height;
+	imageInfo.extent.depth = 1;
+	imageInfo.mipLevels = mipCount;
+	imageInfo.arrayLayers = 1;
+	imageInfo.format = TEXTURE_FORMAT;
+	imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+	imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	imageInfo.usage = usage;
+	imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+	imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+	m_GraphicsDevice.create_image_with_info(imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, EMemoryCategory::Textures, m_Image, m_Allocation);
+	m_ResidentBytes = m_Allocation.size;
+}
+
+void SETexture::create_image_view()
+{
+	VkImageViewCreateInfo viewInfo{};
+	viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+	viewInfo.image = m_Image;
+	viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+	viewInfo.format = TEXTURE_FORMAT;
+	viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	viewInfo.subresourceRange.baseMipLevel = 0;
+	viewInfo.subresourceRange.levelCount = m_MipCount;
+	viewInfo.subresourceRange.baseArrayLayer = 0;
+	viewInfo.subresourceRange.layerCount = 1;
+
+	if (vkCreateImageView(m_GraphicsDevice.device(), &viewInfo, nullptr, &m_ImageView) != VK_SUCCESS)
+	{
+		throw std::runtime_error("failed to create texture image view!");
+	}
+}
+
+uint32_t SETexture::get_mip_count(uint32_t width, uint32_t height)
+{
+	uint32_t mipCount = 1;
+	for (uint32_t extent = std::max(width, height); extent > 1; extent >>= 1)
+	{
+		mipCount++;
+	}
+	return mipCount;
+}
+
+VkDeviceSize SETexture::get_chain_bytes(uint32_t width, uint32_t height, uint32_t firstMip)
+{
+	VkDeviceSize chainBytes = 0;
+	const uint32_t mipCount = get_mip_count(width, height);
+	for (uint32_t mipLevel = firstMip; mipLevel < mipCount; mipLevel++)
+	{
+		chainBytes += static_cast<VkDeviceSize>(get_mip_extent(width, mipLevel)) * get_mip_extent(height, mipLevel) * BYTES_PER_TEXEL;
+	}
+	return chainBytes;
+}
+
+void SETexture::generate_mipmaps(SEGraphicsDevice& device, VkCommandBuffer commandBuffer, VkImage image, uint32_t width, uint32_t height, uint32_t mipCount)
+{
+	const VkFormatFeatureFlags requiredFeatures = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+	if (mipCount > 1 && device.find_supported_format({ TEXTURE_FORMAT }, VK_IMAGE_TILING_OPTIMAL, requiredFeatures) != TEXTURE_FORMAT)
+	{
+		throw std::runtime_error("texture format does not support linear blitting!");
+	}
+
+	// Each level is filtered from the one above it, which turns into a blit source once it is written
+	for (uint32_t mipLevel = 1; mipLevel < mipCount; mipLevel++)
+	{
+		transition_mip_levels(commandBuffer, image, mipLevel - 1, 1, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+			VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+		VkImageBlit blit{};
+		blit.srcOffsets[0] = { 0, 0, 0 };
+		blit.srcOffsets[1] = { static_cast<int32_t>(get_mip_extent(width, mipLevel - 1)), static_cast<int32_t>(get_mip_extent(height, mipLevel - 1)), 1 };
+		blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		blit.srcSubresource.mipLevel = mipLevel - 1;
+		blit.srcSubresource.baseArrayLayer = 0;
+		blit.srcSubresource.layerCount = 1;
+		blit.dstOffsets[0] = { 0, 0, 0 };
+		blit.dstOffsets[1] = { static_cast<int32_t>(get_mip_extent(width, mipLevel)), static_cast<int32_t>(get_mip_extent(height, mipLevel)), 1 };
+		blit.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		blit.dstSubresource.mipLevel = mipLevel;
+		blit.dstSubresource.baseArrayLayer = 0;
+		blit.dstSubresource.layerCount = 1;
+		vkCmdBlitImage(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit, VK_FILTER_LINEAR);
+
+		transition_mip_levels(commandBuffer, image, mipLevel - 1, 1, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+			VK_ACCESS_TRANSFER_READ_BIT, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+	}
+
+	// The last level is only ever written
+	transition_mip_levels(commandBuffer, image, mipCount - 1, 1, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+		VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+}
+
+void SETexture::read_back(std::vector<uint8_t>& texels, std::vector<FCookedMip>& mips)
+{
+	mips.clear();
+	std::vector<VkBufferImageCopy> regions{};
+	VkDeviceSize totalBytes = 0;
+	for (uint32_t mipLevel = 0; mipLevel < m_MipCount; mipLevel++)
+	{
+		const uint32_t mipWidth = get_mip_extent(m_Width, mipLevel);
+		const uint32_t mipHeight = get_mip_extent(m_Height, mipLevel);
+		const VkDeviceSize mipBytes = static_cast<VkDeviceSize>(mipWidth) * mipHeight * BYTES_PER_TEXEL;
+		mips.push_back(FCookedMip{totalBytes, mipBytes, mipWidth, mipHeight});
+		regions.push_back(make_mip_copy(totalBytes, mipLevel, mipWidth, mipHeight));
+		totalBytes += mipBytes;
+	}
+
+	SEBuffer readbackBuffer{m_GraphicsDevice, 1, static_cast<uint32_t>(totalBytes), VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, EMemoryCategory::Staging};
+	readbackBuffer.map();
+
+	VkCommandBuffer commandBuffer = m_GraphicsDevice.begin_single_time_commands();
+	// The chain was written by a submission that has completed, only the layout changes
+	transition_mip_levels(commandBuffer, m_Image, 0, m_MipCount, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+		0, VK_ACCESS_TRANSFER_READ_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+	vkCmdCopyImageToBuffer(commandBuffer, m_Image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, readbackBuffer.get_buffer(), static_cast<uint32_t>(regions.size()), regions.data());
+	transition_mip_levels(commandBuffer, m_Image, 0, m_MipCount, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+		VK_ACCESS_TRANSFER_READ_BIT, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+
+	// Makes the copy visible to the host once the fence wait in end_single_time_commands returns
+	VkMemoryBarrier hostBarrier{};
+	hostBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	hostBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	hostBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 1, &hostBarrier, 0, nullptr, 0, nullptr);
+	m_GraphicsDevice.end_single_time_commands(commandBuffer);
+
+	readbackBuffer.invalidate();
+	const uint8_t* mappedTexels = static_cast<const uint8_t*>(readbackBuffer.get_mapped_memory());
+	texels.assign(mappedTexels, mappedTexels + totalBytes);
+}
+
+std::string SETexture::get_cooked_filepath(const std::string& filepath)
+{
+	return std::filesystem::path(filepath).replace_extension(COOKED_TEXTURE_EXTENSION).string();
+}
+
+bool SETexture::cook_texture(SEGraphicsDevice& device, const std::string& filepath, const std::string& cookedFilepath)
+{
+	SETgaParser::FTgaImage image{};
+	SETgaParser::load_file(filepath, image);
+
+	// The chain is generated by the same blits a runtime texture would use, then stored so streaming can upload any
+	// suffix of it without touching the other levels
+	SETexture texture{device, image.pixels.data(), image.width, image.height, true};
+	std::vector<uint8_t> texels{};
+	std::vector<FCookedMip> mips{};
+	texture.read_back(texels, mips);
+
+	FCookedTextureHeader header{};
+	header.magic = COOKED_TEXTURE_MAGIC;
+	header.layoutVersion = COOKED_TEXTURE_LAYOUT_VERSION;
+	header.format = static_cast<uint32_t>(TEXTURE_FORMAT);
+	header.width = image.width;
+	header.height = image.height;
+	header.mipCount = static_cast<uint32_t>(mips.size());
+
+	const uint64_t texelOffset = sizeof(FCookedTextureHeader) + mips.size() * sizeof(FCookedMip);
+	for (FCookedMip& mip : mips)
+	{
+		mip.offset += texelOffset;
+	}
+
+	return write_file_atomically(cookedFilepath, {{&header, sizeof(header)}, {mips.data(), mips.size() * sizeof(FCookedMip)}, {texels.data(), texels.size()}});
+}
+
+void SETexture::load_source_data(SEGraphicsDevice& device, const std::string& filepath, FTextureSourceData& sourceData)
+{
+	const std::string cookedFilepath = get_cooked_filepath(filepath);
+
+	// Files of an older layout are cooked again like stale ones
+	const FCookedTextureHeader* header = nullptr;
+	if (is_cooked_texture_current(filepath, cookedFilepath))
+	{
+		sourceData.cookedFile = std::make_unique<SEMappedFile>(cookedFilepath);
+		header = get_cooked_texture_header(*sourceData.cookedFile);
+	}
+	if (header == nullptr)
+	{
+		sourceData.cookedFile = nullptr;
+		if (!cook_texture(device, filepath, cookedFilepath))
+		{
+			throw std::runtime_error("failed to write cooked texture " + cookedFilepath + " !");
+		}
+		sourceData.cookedFile = std::make_unique<SEMappedFile>(cookedFilepath);
+		header = get_cooked_texture_header(*sourceData.cookedFile);
+		if (header == nullptr)
+		{
+			sourceData.cookedFile = nullptr;
+			throw std::runtime_error("invalid cooked texture " + cookedFilepath + " !");
+		}
+	}
+
+	sourceData.mips = reinterpret_cast<const FCookedMip*>(sourceData.cookedFile->get_data() + sizeof(FCookedTextureHeader));
+	sourceData.width = header->width;
+	sourceData.height = header->height;
+	sourceData.mipCount = header->mipCount;
+}
+
+} // namespace SE
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "SERendering/SEGraphicsDevice/SEGraphicsDevice.hpp"
+#include "SERendering/SESamplerCache.hpp"
+#include "SECore/SEUtilities/SEMappedFile.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace SE {
+
+	// Sampled RGBA8 image with a mip chain. A texture holds a suffix of its asset's chain, from firstMip down to the
+	// 1x1 level, so streaming changes residency by replacing the texture with one that starts at another level
+	class SETexture {
+
+	public:
+		// One level of a cooked texture. offset is from the start of the file
+		struct FCookedMip {
+			uint64_t offset;
+			uint64_t size;
+			uint32_t width;
+			uint32_t height;
+		};
+
+		// Header of a cooked .setex file. The mip table follows the header, level 0 first, then the texels of each level
+		struct FCookedTextureHeader {
+			uint32_t magic;
+			uint32_t layoutVersion;
+			uint32_t format;
+			uint32_t width;
+			uint32_t height;
+			uint32_t mipCount;
+		};
+
+		// CPU side of a texture load, the levels point into the mapped cooked file
+		struct FTextureSourceData {
+			std::unique_ptr<SEMappedFile> cookedFile{};
+			const FCookedMip* mips = nullptr;
+			uint32_t width = 0;
+			uint32_t height = 0;
+			uint32_t mipCount = 0;
+
+			const uint8_t* get_mip_data(uint32_t mipLevel) const { return cookedFile->get_data() + mips[mipLevel].offset; }
+		};
+
+		static constexpr uint32_t COOKED_TEXTURE_MAGIC = 0x58544553; // "SETX"
+		static constexpr uint32_t COOKED_TEXTURE_LAYOUT_VERSION = 1;
+		static constexpr const char* COOKED_TEXTURE_EXTENSION = ".setex";
+		// Blits filter sRGB levels in linear space, so generated mips keep their brightness
+		static constexpr VkFormat TEXTURE_FORMAT = VK_FORMAT_R8G8B8A8_SRGB;
+		static constexpr uint32_t BYTES_PER_TEXEL = 4;
+
+#pragma region Lifecycle
+		// Uploads levels firstMip to the end of the chain of a cooked texture, only those levels take device memory
+		SETexture(SEGraphicsDevice& device, const FTextureSourceData& sourceData, uint32_t firstMip, const FSamplerDesc& samplerDesc = FSamplerDesc{});
+		// Uploads RGBA8 texels as level 0. With bGenerateMips the rest of the chain is generated on the GPU with blits
+		SETexture(SEGraphicsDevice& device, const uint8_t* texels, uint32_t width, uint32_t height, bool bGenerateMips = true, const FSamplerDesc& samplerDesc = FSamplerDesc{});
+		~SETexture();
+		SETexture(const SETexture&) = delete;
+		SETexture& operator=(const SETexture&) = delete;
+#pragma endregion Lifecycle
+
+		// Maps the cooked .setex next to a TGA file, cooking it first when it is missing or older than the source. Throws
+		// when neither can be loaded
+		static void load_source_data(SEGraphicsDevice& device, const std::string& filepath, FTextureSourceData& sourceData);
+		// Decodes the TGA, generates its mip chain with blits, reads the chain back and writes it to cookedFilepath
+		static bool cook_texture(SEGraphicsDevice& device, const std::string& filepath, const std::string& cookedFilepath);
+		static std::string get_cooked_filepath(const std::string& filepath);
+
+		static uint32_t get_mip_count(uint32_t width, uint32_t height);
+		static uint32_t get_mip_extent(uint32_t extent, uint32_t mipLevel) { return std::max(extent >> mipLevel, 1u); }
+		// Device bytes of the levels from firstMip to the end of the chain
+		static VkDeviceSize get_chain_bytes(uint32_t width, uint32_t height, uint32_t firstMip);
+
+		// Records blits that fill levels 1 to mipCount - 1 from level 0. Every level must be in TRANSFER_DST_OPTIMAL,
+		// all of them end in SHADER_READ_ONLY_OPTIMAL. Throws when the format can not be blitted with linear filtering
+		static void generate_mipmaps(SEGraphicsDevice& device, VkCommandBuffer commandBuffer, VkImage image, uint32_t width, uint32_t height, uint32_t mipCount);
+
+		VkImage get_image() const { return m_Image; }
+		VkImageView get_image_view() const { return m_ImageView; }
+		VkSampler get_sampler() const { return m_Sampler; }
+		VkDescriptorImageInfo get_descriptor_info() const { return VkDescriptorImageInfo{m_Sampler, m_ImageView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL}; }
+
+		// Level of the asset's chain that is level 0 of this image, 0 when the whole chain is resident
+		uint32_t get_first_mip() const { return m_FirstMip; }
+		uint32_t get_width() const { return m_Width; }
+		uint32_t get_height() const { return m_Height; }
+		uint32_t get_resident_mip_count() const { return m_MipCount; }
+		VkDeviceSize get_resident_bytes() const { return m_ResidentBytes; }
+
+	private:
+		void create_image(uint32_t width, uint32_t height, uint32_t mipCount, VkImageUsageFlags usage);
+		void create_image_view();
+		// Copies every level into a host visible buffer, used for cooking. The image stays in SHADER_READ_ONLY_OPTIMAL
+		void read_back(std::vector<uint8_t>& texels, std::vector<FCookedMip>& mips);
+
+
+		SEGraphicsDevice& m_GraphicsDevice;
+		VkImage m_Image = VK_NULL_HANDLE;
+		FMemoryAllocation m_Allocation{};
+		VkImageView m_ImageView = VK_NULL_HANDLE;
+		VkSampler m_Sampler = VK_NULL_HANDLE;		// Owned by the device's sampler cache
+
+		uint32_t m_Width = 0;
+		uint32_t m_Height = 0;
+		uint32_t m_MipCount = 0;
+		uint32_t m_FirstMip = 0;
+		VkDeviceSize m_ResidentBytes = 0;
+	};
+
+} // end SE namespace
@@ -3,7 +3,8 @@
 #include <cstdint>
 #include <memory>
 
-#include "SECore/SEComponents/SEMesh.hpp"
+#include "SECore/SEAssets/SEMeshHandle.hpp"
+#include "SECore/SEAssets/SETextureHandle.hpp"
 #include "glm/gtc/matrix_transform.hpp"
 #include "glm/gtx/euler_angles.hpp"
 
@@ -43,7 +44,12 @@ namespace SE {
 	void rotate_using_delta(const glm::vec3& rotationDelta);
 	void translate_using_delta(const glm::vec3& translationDelta);
 
-	std::shared_ptr<SEMesh> m_Mesh{};
+	// Mesh may still be streaming in, render systems skip the object until it is resident
+	std::shared_ptr<SEMeshHandle> m_Mesh{};
+	// Level of detail drawn last frame, LOD selection keeps it unless the projected error moves past the hysteresis band
+	uint32_t m_LodIndex{0};
+	// Sampled by the fragment shader, white while nothing is resident. The projected size drives its mip streaming
+	std::shared_ptr<SETextureHandle> m_Texture{};
 	glm::vec3 m_Color{};
 	TransformComponent m_TransformComponent{};
 
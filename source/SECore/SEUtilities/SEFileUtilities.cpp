@@ -0,0 +1,36 @@
+#include "SEFileUtilities.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+
+namespace SE {
+
+bool write_file_atomically(const std::string& filepath, std::initializer_list<FFileSpan> spans)
+{
+	const std::string temporaryFilepath = filepath + ".tmp";
+	bool bWritten = false;
+	{
+		std::ofstream fileOut(temporaryFilepath, std::ios::binary | std::ios::trunc);
+		if (fileOut.is_open())
+		{
+			for (const FFileSpan& span : spans)
+			{
+				fileOut.write(static_cast<const char*>(span.data), static_cast<std::streamsize>(span.size));
+			}
+			fileOut.close();
+			bWritten = fileOut.good();
+		}
+	}
+
+	std::error_code errorCode;
+	if (bWritten)
+	{
+		std::filesystem::rename(temporaryFilepath, filepath, errorCode);
+		if (!errorCode) { return true; }
+	}
+	std::filesystem::remove(temporaryFilepath, errorCode);
+	return false;
+}
+
+} // namespace SE
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstddef>
+#include <initializer_list>
+#include <string>
+
+namespace SE {
+
+// Bytes written in sequence by write_file_atomically
+struct FFileSpan {
+	const void* data;
+	size_t size;
+};
+
+// Writes the spans to a temporary file next to filepath and renames it over filepath, so readers never see a partially
+// written file. Returns false and removes the temporary file when any step fails
+bool write_file_atomically(const std::string& filepath, std::initializer_list<FFileSpan> spans);
+
+} // namespace SE
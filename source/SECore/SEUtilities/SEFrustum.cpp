@@ -0,0 +1,60 @@
+#include "SEFrustum.hpp"
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define SE_FRUSTUM_SSE 1
+#include <xmmintrin.h>
+#endif
+
+namespace SE {
+
+void FFrustum::intersects_spheres(const float* centersX, const float* centersY, const float* centersZ, const float* radii, uint32_t count, uint8_t* visible) const
+{
+	uint32_t sphereIndex = 0;
+
+#ifdef SE_FRUSTUM_SSE
+	// Plane components splatted once, each iteration tests four spheres against all six planes
+	__m128 planeX[PlaneCount];
+	__m128 planeY[PlaneCount];
+	__m128 planeZ[PlaneCount];
+	__m128 planeW[PlaneCount];
+	for (uint32_t planeIndex = 0; planeIndex < PlaneCount; planeIndex++)
+	{
+		planeX[planeIndex] = _mm_set1_ps(planes[planeIndex].x);
+		planeY[planeIndex] = _mm_set1_ps(planes[planeIndex].y);
+		planeZ[planeIndex] = _mm_set1_ps(planes[planeIndex].z);
+		planeW[planeIndex] = _mm_set1_ps(planes[planeIndex].w);
+	}
+
+	const __m128 zero = _mm_setzero_ps();
+	for (; sphereIndex + 4 <= count; sphereIndex += 4)
+	{
+		const __m128 x = _mm_loadu_ps(centersX + sphereIndex);
+		const __m128 y = _mm_loadu_ps(centersY + sphereIndex);
+		const __m128 z = _mm_loadu_ps(centersZ + sphereIndex);
+		const __m128 negativeRadius = _mm_sub_ps(zero, _mm_loadu_ps(radii + sphereIndex));
+
+		__m128 inside = _mm_cmpeq_ps(zero, zero);
+		for (uint32_t planeIndex = 0; planeIndex < PlaneCount; planeIndex++)
+		{
+			__m128 distance = _mm_add_ps(_mm_mul_ps(planeX[planeIndex], x), planeW[planeIndex]);
+			distance = _mm_add_ps(distance, _mm_mul_ps(planeY[planeIndex], y));
+			distance = _mm_add_ps(distance, _mm_mul_ps(planeZ[planeIndex], z));
+			inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negativeRadius));
+		}
+
+		const int insideMask = _mm_movemask_ps(inside);
+		visible[sphereIndex + 0] = static_cast<uint8_t>(insideMask & 1);
+		visible[sphereIndex + 1] = static_cast<uint8_t>((insideMask >> 1) & 1);
+		visible[sphereIndex + 2] = static_cast<uint8_t>((insideMask >> 2) & 1);
+		visible[sphereIndex + 3] = static_cast<uint8_t>((insideMask >> 3) & 1);
+	}
+#endif
+
+	for (; sphereIndex < count; sphereIndex++)
+	{
+		const glm::vec3 center{centersX[sphereIndex], centersY[sphereIndex], centersZ[sphereIndex]};
+		visible[sphereIndex] = intersects_sphere(center, radii[sphereIndex]) ? 1 : 0;
+	}
+}
+
+} // namespace SE
@@ -0,0 +1,67 @@
+#pragma once
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+#include <cstdint>
+
+namespace SE {
+
+// View frustum as six inward facing planes, xyz is the unit normal and w the distance. A point p is inside a plane
+// when dot(plane.xyz, p) + plane.w >= 0
+struct FFrustum {
+	enum EPlane { Left, Right, Bottom, Top, Near, Far, PlaneCount };
+
+	glm::vec4 planes[PlaneCount];
+
+	// Planes of a projection * view (or projection * view * model) matrix, clip depth runs from 0 to 1
+	static FFrustum from_matrix(const glm::mat4& matrix)
+	{
+		const glm::vec4 row0{matrix[0][0], matrix[1][0], matrix[2][0], matrix[3][0]};
+		const glm::vec4 row1{matrix[0][1], matrix[1][1], matrix[2][1], matrix[3][1]};
+		const glm::vec4 row2{matrix[0][2], matrix[1][2], matrix[2][2], matrix[3][2]};
+		const glm::vec4 row3{matrix[0][3], matrix[1][3], matrix[2][3], matrix[3][3]};
+
+		FFrustum frustum{};
+		frustum.planes[Left] = row3 + row0;
+		frustum.planes[Right] = row3 - row0;
+		frustum.planes[Bottom] = row3 + row1;
+		frustum.planes[Top] = row3 - row1;
+		frustum.planes[Near] = row2;
+		frustum.planes[Far] = row3 - row2;
+
+		for (glm::vec4& plane : frustum.planes)
+		{
+			const float normalLength = glm::length(glm::vec3{plane});
+			if (normalLength > 0.0f) { plane /= normalLength; }
+		}
+		return frustum;
+	}
+
+	bool intersects_sphere(const glm::vec3& center, float radius) const
+	{
+		for (const glm::vec4& plane : planes)
+		{
+			if (glm::dot(glm::vec3{plane}, center) + plane.w < -radius) { return false; }
+		}
+		return true;
+	}
+
+	// Box given by its center and half extents along the axes of the frustum space
+	bool intersects_box(const glm::vec3& center, const glm::vec3& extents) const
+	{
+		for (const glm::vec4& plane : planes)
+		{
+			const glm::vec3 normal{plane};
+			if (glm::dot(normal, center) + plane.w < -glm::dot(glm::abs(normal), extents)) { return false; }
+		}
+		return true;
+	}
+
+	// Sphere test over arrays of bounds, four spheres at a time where SSE is available. Writes 1 to visible for each
+	// sphere that intersects the frustum and 0 otherwise
+	void intersects_spheres(const float* centersX, const float* centersY, const float* centersZ, const float* radii, uint32_t count, uint8_t* visible) const;
+};
+
+} // namespace SE
@@ -1,5 +1,10 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+
 namespace SE {
 
 template <typename T, typename... Rest>
@@ -9,4 +14,39 @@ void hash_combine(std::size_t& seed, const T& v, const Rest&... rest)
 	(hash_combine(seed, rest), ...);
 };
 
-} // namespace SE
\ No newline at end of file
+// 64 bit finalizer (splitmix64), spreads every input bit across the whole word
+inline uint64_t hash_mix(uint64_t value)
+{
+	value ^= value >> 30;
+	value *= 0xbf58476d1ce4e5b9ull;
+	value ^= value >> 27;
+	value *= 0x94d049bb133111ebull;
+	value ^= value >> 31;
+	return value;
+}
+
+// Hashes a block of raw bytes eight bytes at a time. Used for content hashes of cooked assets
+inline uint64_t hash_bytes(const void* data, std::size_t size, uint64_t seed = 0)
+{
+	const uint8_t* bytes = static_cast<const uint8_t*>(data);
+	uint64_t hash = seed ^ (static_cast<uint64_t>(size) * 0x9e3779b97f4a7c15ull);
+
+	std::size_t offset = 0;
+	for (; offset + sizeof(uint64_t) <= size; offset += sizeof(uint64_t))
+	{
+		uint64_t word;
+		memcpy(&word, bytes + offset, sizeof(uint64_t));
+		hash = (hash ^ hash_mix(word)) * 0x9fb21c651e98df25ull;
+	}
+
+	if (offset < size)
+	{
+		uint64_t tail = 0;
+		memcpy(&tail, bytes + offset, size - offset);
+		hash = (hash ^ hash_mix(tail)) * 0x9fb21c651e98df25ull;
+	}
+
+	return hash_mix(hash);
+}
+
+} // namespace SE
@@ -0,0 +1,86 @@
+#include "SEMappedFile.hpp"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace SE {
+
+#pragma region Lifecycle
+SEMappedFile::SEMappedFile(const std::string& filepath)
+{
+#ifdef _WIN32
+	HANDLE fileHandle = CreateFileA(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (fileHandle == INVALID_HANDLE_VALUE) { return; }
+	m_FileHandle = fileHandle;
+
+	LARGE_INTEGER fileSize{};
+	if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart == 0)
+	{
+		unmap();
+		return;
+	}
+
+	m_MappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (m_MappingHandle == nullptr)
+	{
+		unmap();
+		return;
+	}
+
+	m_Data = static_cast<const uint8_t*>(MapViewOfFile(m_MappingHandle, FILE_MAP_READ, 0, 0, 0));
+	m_Size = m_Data != nullptr ? static_cast<size_t>(fileSize.QuadPart) : 0;
+#else
+	m_FileDescriptor = open(filepath.c_str(), O_RDONLY);
+	if (m_FileDescriptor < 0) { return; }
+
+	struct stat fileStat{};
+	if (fstat(m_FileDescriptor, &fileStat) != 0 || fileStat.st_size == 0)
+	{
+		unmap();
+		return;
+	}
+
+	void* mapped = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, m_FileDescriptor, 0);
+	if (mapped == MAP_FAILED)
+	{
+		unmap();
+		return;
+	}
+
+	m_Data = static_cast<const uint8_t*>(mapped);
+	m_Size = static_cast<size_t>(fileStat.st_size);
+#endif
+}
+
+SEMappedFile::~SEMappedFile()
+{
+	unmap();
+}
+#pragma endregion Lifecycle
+
+void SEMappedFile::unmap()
+{
+#ifdef _WIN32
+	if (m_Data) { UnmapViewOfFile(m_Data); }
+	if (m_MappingHandle) { CloseHandle(m_MappingHandle); }
+	if (m_FileHandle) { CloseHandle(m_FileHandle); }
+	m_MappingHandle = nullptr;
+	m_FileHandle = nullptr;
+#else
+	if (m_Data) { munmap(const_cast<uint8_t*>(m_Data), m_Size); }
+	if (m_FileDescriptor >= 0) { close(m_FileDescriptor); }
+	m_FileDescriptor = -1;
+#endif
+	m_Data = nullptr;
+	m_Size = 0;
+}
+
+} // namespace SE
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace SE {
+
+// Read-only memory mapping of a whole file. The mapping is released when the object is destroyed.
+class SEMappedFile {
+
+public:
+#pragma region Lifecycle
+	SEMappedFile(const std::string& filepath);
+	~SEMappedFile();
+	SEMappedFile(const SEMappedFile&) = delete;
+	SEMappedFile& operator=(const SEMappedFile&) = delete;
+#pragma endregion Lifecycle
+
+	bool is_valid() const { return m_Data != nullptr; }
+	const uint8_t* get_data() const { return m_Data; }
+	size_t get_size() const { return m_Size; }
+
+private:
+	void unmap();
+
+	const uint8_t* m_Data = nullptr;
+	size_t m_Size = 0;
+
+#ifdef _WIN32
+	void* m_FileHandle = nullptr;
+	void* m_MappingHandle = nullptr;
+#else
+	int m_FileDescriptor = -1;
+#endif
+};
+
+} // namespace SE
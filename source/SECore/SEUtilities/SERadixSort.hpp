@@ -0,0 +1,67 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace SE {
+
+// Sort key with the index of the item it orders
+struct FSortItem {
+	uint64_t key;
+	uint32_t index;
+};
+
+// Stable least significant digit radix sort by key, eight bits per pass. The histograms of all passes are counted in
+// one read, and passes whose digit is the same for every key are skipped, so keys with unused high bits cost fewer
+// passes. scratch is only used for its capacity, which carries over between calls
+inline void radix_sort(std::vector<FSortItem>& items, std::vector<FSortItem>& scratch)
+{
+	constexpr uint32_t DIGIT_BITS = 8;
+	constexpr uint32_t DIGIT_COUNT = 1u << DIGIT_BITS;
+	constexpr uint32_t PASS_COUNT = 64 / DIGIT_BITS;
+
+	const size_t itemCount = items.size();
+	if (itemCount < 2) { return; }
+
+	std::array<std::array<uint32_t, DIGIT_COUNT>, PASS_COUNT> histograms{};
+	for (const FSortItem& item : items)
+	{
+		for (uint32_t pass = 0; pass < PASS_COUNT; pass++)
+		{
+			histograms[pass][(item.key >> (pass * DIGIT_BITS)) & (DIGIT_COUNT - 1)]++;
+		}
+	}
+
+	scratch.resize(itemCount);
+	FSortItem* source = items.data();
+	FSortItem* destination = scratch.data();
+	for (uint32_t pass = 0; pass < PASS_COUNT; pass++)
+	{
+		const uint32_t shift = pass * DIGIT_BITS;
+		std::array<uint32_t, DIGIT_COUNT>& histogram = histograms[pass];
+		if (histogram[(source[0].key >> shift) & (DIGIT_COUNT - 1)] == itemCount) { continue; }
+
+		// Exclusive prefix sums turn the counts into each digit's first slot
+		uint32_t firstSlot = 0;
+		for (uint32_t& digitCount : histogram)
+		{
+			const uint32_t count = digitCount;
+			digitCount = firstSlot;
+			firstSlot += count;
+		}
+
+		for (size_t itemIndex = 0; itemIndex < itemCount; itemIndex++)
+		{
+			destination[histogram[(source[itemIndex].key >> shift) & (DIGIT_COUNT - 1)]++] = source[itemIndex];
+		}
+		std::swap(source, destination);
+	}
+
+	// An odd number of passes leaves the result in scratch
+	if (source != items.data()) { items.swap(scratch); }
+}
+
+} // namespace SE
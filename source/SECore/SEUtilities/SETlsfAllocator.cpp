@@ -0,0 +1,262 @@
+#include "SETlsfAllocator.hpp"
+
+#include <cassert>
+#include <stdexcept>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace SE {
+
+// Index of the highest set bit, value must not be 0
+static uint32_t find_msb(uint64_t value)
+{
+#ifdef _MSC_VER
+	unsigned long bitIndex;
+	_BitScanReverse64(&bitIndex, value);
+	return static_cast<uint32_t>(bitIndex);
+#else
+	return 63u - static_cast<uint32_t>(__builtin_clzll(value));
+#endif
+}
+
+// Index of the lowest set bit, value must not be 0
+static uint32_t find_lsb(uint64_t value)
+{
+#ifdef _MSC_VER
+	unsigned long bitIndex;
+	_BitScanForward64(&bitIndex, value);
+	return static_cast<uint32_t>(bitIndex);
+#else
+	return static_cast<uint32_t>(__builtin_ctzll(value));
+#endif
+}
+
+static uint64_t align_up(uint64_t value, uint64_t alignment)
+{
+	return (value + alignment - 1) & ~(alignment - 1);
+}
+
+#pragma region Lifecycle
+SETlsfAllocator::SETlsfAllocator(uint64_t capacity) : m_Capacity{capacity & ~(ALLOCATION_GRANULE - 1)}
+{
+	if (m_Capacity == 0 || find_msb(m_Capacity) >= FIRST_LEVEL_COUNT + SMALL_BLOCK_SHIFT - 1)
+	{
+		throw std::runtime_error("TLSF allocator capacity out of range!");
+	}
+
+	m_FreeHeads.fill(INVALID_NODE);
+	insert_free(create_node(0, m_Capacity));
+}
+#pragma endregion Lifecycle
+
+void SETlsfAllocator::mapping(uint64_t size, uint32_t& firstLevel, uint32_t& secondLevel)
+{
+	if (size < SMALL_BLOCK_SIZE)
+	{
+		firstLevel = 0;
+		secondLevel = static_cast<uint32_t>(size / (SMALL_BLOCK_SIZE / SECOND_LEVEL_COUNT));
+		return;
+	}
+
+	const uint32_t mostSignificantBit = find_msb(size);
+	firstLevel = mostSignificantBit - (SMALL_BLOCK_SHIFT - 1);
+	secondLevel = static_cast<uint32_t>(size >> (mostSignificantBit - SECOND_LEVEL_SHIFT)) - SECOND_LEVEL_COUNT;
+}
+
+bool SETlsfAllocator::allocate(uint64_t size, uint64_t alignment, FAllocation& allocation)
+{
+	assert((alignment & (alignment - 1)) == 0 && "Alignment must be a power of two");
+
+	size = align_up(size == 0 ? 1 : size, ALLOCATION_GRANULE);
+	alignment = alignment < ALLOCATION_GRANULE ? ALLOCATION_GRANULE : alignment;
+	if (size > m_Capacity) { return false; }
+
+	// Regions start on a granule, so the aligned start is at most alignment - granule bytes in. Try the exact size
+	// class first and only pay for the padding when its region cannot be aligned
+	uint32_t node = find_free(size);
+	if (node != INVALID_NODE && align_up(m_Nodes[node].offset, alignment) + size > m_Nodes[node].offset + m_Nodes[node].size)
+	{
+		node = INVALID_NODE;
+	}
+	if (node == INVALID_NODE && alignment > ALLOCATION_GRANULE)
+	{
+		node = find_free(size + alignment - ALLOCATION_GRANULE);
+	}
+	if (node == INVALID_NODE) { return false; }
+
+	remove_free(node);
+
+	// Padding in front of the aligned start becomes a free region of its own. The previous region is in use,
+	// free neighbours are always merged
+	const uint64_t padding = align_up(m_Nodes[node].offset, alignment) - m_Nodes[node].offset;
+	if (padding > 0)
+	{
+		const uint32_t paddingNode = create_node(m_Nodes[node].offset, padding);
+		m_Nodes[paddingNode].previousPhysical = m_Nodes[node].previousPhysical;
+		m_Nodes[paddingNode].nextPhysical = node;
+		if (m_Nodes[node].previousPhysical != INVALID_NODE) { m_Nodes[m_Nodes[node].previousPhysical].nextPhysical = paddingNode; }
+		m_Nodes[node].previousPhysical = paddingNode;
+		m_Nodes[node].offset += padding;
+		m_Nodes[node].size -= padding;
+		insert_free(paddingNode);
+	}
+
+	if (m_Nodes[node].size - size >= ALLOCATION_GRANULE) { split_tail(node, size); }
+
+	m_Nodes[node].bFree = false;
+	m_UsedBytes += m_Nodes[node].size;
+	m_AllocationCount++;
+
+	allocation.offset = m_Nodes[node].offset;
+	allocation.size = m_Nodes[node].size;
+	allocation.node = node;
+	return true;
+}
+
+void SETlsfAllocator::free(uint32_t node)
+{
+	assert(node < m_Nodes.size() && !m_Nodes[node].bFree && "Freeing an invalid TLSF allocation");
+
+	m_UsedBytes -= m_Nodes[node].size;
+	m_AllocationCount--;
+	m_Nodes[node].bFree = true;
+
+	const uint32_t previousNode = m_Nodes[node].previousPhysical;
+	if (previousNode != INVALID_NODE && m_Nodes[previousNode].bFree)
+	{
+		remove_free(previousNode);
+		m_Nodes[node].offset = m_Nodes[previousNode].offset;
+		m_Nodes[node].size += m_Nodes[previousNode].size;
+		m_Nodes[node].previousPhysical = m_Nodes[previousNode].previousPhysical;
+		if (m_Nodes[node].previousPhysical != INVALID_NODE) { m_Nodes[m_Nodes[node].previousPhysical].nextPhysical = node; }
+		release_node(previousNode);
+	}
+
+	const uint32_t nextNode = m_Nodes[node].nextPhysical;
+	if (nextNode != INVALID_NODE && m_Nodes[nextNode].bFree)
+	{
+		remove_free(nextNode);
+		m_Nodes[node].size += m_Nodes[nextNode].size;
+		m_Nodes[node].nextPhysical = m_Nodes[nextNode].nextPhysical;
+		if (m_Nodes[node].nextPhysical != INVALID_NODE) { m_Nodes[m_Nodes[node].nextPhysical].previousPhysical = node; }
+		release_node(nextNode);
+	}
+
+	insert_free(node);
+}
+
+uint64_t SETlsfAllocator::get_largest_free_region() const
+{
+	if (m_FirstLevelBitmap == 0) { return 0; }
+
+	const uint32_t firstLevel = find_msb(m_FirstLevelBitmap);
+	const uint32_t secondLevel = find_msb(m_SecondLevelBitmaps[firstLevel]);
+
+	uint64_t largestSize = 0;
+	for (uint32_t node = m_FreeHeads[firstLevel * SECOND_LEVEL_COUNT + secondLevel]; node != INVALID_NODE; node = m_Nodes[node].nextFree)
+	{
+		largestSize = m_Nodes[node].size > largestSize ? m_Nodes[node].size : largestSize;
+	}
+	return largestSize;
+}
+
+uint32_t SETlsfAllocator::create_node(uint64_t offset, uint64_t size)
+{
+	uint32_t node;
+	if (!m_UnusedNodes.empty())
+	{
+		node = m_UnusedNodes.back();
+		m_UnusedNodes.pop_back();
+	} else {
+		node = static_cast<uint32_t>(m_Nodes.size());
+		m_Nodes.emplace_back();
+	}
+
+	m_Nodes[node] = FNode{offset, size, INVALID_NODE, INVALID_NODE, INVALID_NODE, INVALID_NODE, false};
+	return node;
+}
+
+void SETlsfAllocator::release_node(uint32_t node)
+{
+	m_UnusedNodes.push_back(node);
+}
+
+void SETlsfAllocator::insert_free(uint32_t node)
+{
+	uint32_t firstLevel;
+	uint32_t secondLevel;
+	mapping(m_Nodes[node].size, firstLevel, secondLevel);
+
+	uint32_t& head = m_FreeHeads[firstLevel * SECOND_LEVEL_COUNT + secondLevel];
+	m_Nodes[node].bFree = true;
+	m_Nodes[node].previousFree = INVALID_NODE;
+	m_Nodes[node].nextFree = head;
+	if (head != INVALID_NODE) { m_Nodes[head].previousFree = node; }
+	head = node;
+
+	m_FirstLevelBitmap |= 1ull << firstLevel;
+	m_SecondLevelBitmaps[firstLevel] |= 1u << secondLevel;
+	m_FreeRegionCount++;
+}
+
+void SETlsfAllocator::remove_free(uint32_t node)
+{
+	uint32_t firstLevel;
+	uint32_t secondLevel;
+	mapping(m_Nodes[node].size, firstLevel, secondLevel);
+
+	const uint32_t previousFree = m_Nodes[node].previousFree;
+	const uint32_t nextFree = m_Nodes[node].nextFree;
+	if (previousFree != INVALID_NODE) { m_Nodes[previousFree].nextFree = nextFree; }
+	if (nextFree != INVALID_NODE) { m_Nodes[nextFree].previousFree = previousFree; }
+
+	uint32_t& head = m_FreeHeads[firstLevel * SECOND_LEVEL_COUNT + secondLevel];
+	if (head == node)
+	{
+		head = nextFree;
+		if (head == INVALID_NODE)
+		{
+			m_SecondLevelBitmaps[firstLevel] &= ~(1u << secondLevel);
+			if (m_SecondLevelBitmaps[firstLevel] == 0) { m_FirstLevelBitmap &= ~(1ull << firstLevel); }
+		}
+	}
+	m_FreeRegionCount--;
+}
+
+uint32_t SETlsfAllocator::find_free(uint64_t size) const
+{
+	// Round up to the next class boundary, so any region of the class found is large enough
+	if (size >= SMALL_BLOCK_SIZE) { size += (1ull << (find_msb(size) - SECOND_LEVEL_SHIFT)) - 1; }
+	if (size >= (1ull << (FIRST_LEVEL_COUNT + SMALL_BLOCK_SHIFT - 1))) { return INVALID_NODE; }
+
+	uint32_t firstLevel;
+	uint32_t secondLevel;
+	mapping(size, firstLevel, secondLevel);
+
+	uint32_t secondLevelMap = m_SecondLevelBitmaps[firstLevel] & (~0u << secondLevel);
+	if (secondLevelMap == 0)
+	{
+		const uint64_t firstLevelMap = m_FirstLevelBitmap & (~0ull << (firstLevel + 1));
+		if (firstLevelMap == 0) { return INVALID_NODE; }
+
+		firstLevel = find_lsb(firstLevelMap);
+		secondLevelMap = m_SecondLevelBitmaps[firstLevel];
+	}
+	secondLevel = find_lsb(secondLevelMap);
+	return m_FreeHeads[firstLevel * SECOND_LEVEL_COUNT + secondLevel];
+}
+
+void SETlsfAllocator::split_tail(uint32_t node, uint64_t size)
+{
+	const uint32_t tailNode = create_node(m_Nodes[node].offset + size, m_Nodes[node].size - size);
+	m_Nodes[tailNode].previousPhysical = node;
+	m_Nodes[tailNode].nextPhysical = m_Nodes[node].nextPhysical;
+	if (m_Nodes[node].nextPhysical != INVALID_NODE) { m_Nodes[m_Nodes[node].nextPhysical].previousPhysical = tailNode; }
+	m_Nodes[node].nextPhysical = tailNode;
+	m_Nodes[node].size = size;
+	insert_free(tailNode);
+}
+
+} // namespace SE
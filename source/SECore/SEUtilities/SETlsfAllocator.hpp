@@ -0,0 +1,87 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace SE {
+
+// Two level segregated fit allocator over an abstract range of bytes. Only offsets are managed, the memory itself lives
+// elsewhere (a VkDeviceMemory block, a shared buffer). Allocation and free are O(1): free regions are kept in lists
+// bucketed by size class, found through two bitmaps, and neighbouring free regions merge on free
+class SETlsfAllocator {
+
+public:
+	static constexpr uint32_t INVALID_NODE = UINT32_MAX;
+	// Offsets and sizes are multiples of this, smaller alignments are free
+	static constexpr uint64_t ALLOCATION_GRANULE = 16;
+
+	struct FAllocation {
+		uint64_t offset = 0;
+		uint64_t size = 0;
+		uint32_t node = INVALID_NODE;	// Handle passed back to free
+	};
+
+#pragma region Lifecycle
+	SETlsfAllocator(uint64_t capacity);
+	~SETlsfAllocator() = default;
+	SETlsfAllocator(const SETlsfAllocator&) = delete;
+	SETlsfAllocator& operator=(const SETlsfAllocator&) = delete;
+#pragma endregion Lifecycle
+
+	// Alignment must be a power of two. Returns false when no free region fits
+	bool allocate(uint64_t size, uint64_t alignment, FAllocation& allocation);
+	void free(uint32_t node);
+
+	uint64_t get_capacity() const { return m_Capacity; }
+	uint64_t get_used_bytes() const { return m_UsedBytes; }
+	uint32_t get_allocation_count() const { return m_AllocationCount; }
+	uint32_t get_free_region_count() const { return m_FreeRegionCount; }
+	bool is_empty() const { return m_AllocationCount == 0; }
+	// Walks the list of the highest occupied size class, so not O(1)
+	uint64_t get_largest_free_region() const;
+
+private:
+	// Sizes below SMALL_BLOCK_SIZE share the first level and are split linearly, larger sizes get one first level per
+	// power of two, split into SECOND_LEVEL_COUNT classes
+	static constexpr uint32_t SECOND_LEVEL_SHIFT = 5;
+	static constexpr uint32_t SECOND_LEVEL_COUNT = 1u << SECOND_LEVEL_SHIFT;
+	static constexpr uint32_t SMALL_BLOCK_SHIFT = 8;
+	static constexpr uint64_t SMALL_BLOCK_SIZE = 1ull << SMALL_BLOCK_SHIFT;
+	static constexpr uint32_t FIRST_LEVEL_COUNT = 40;	// Capacities below 2^46 bytes
+
+	struct FNode {
+		uint64_t offset;
+		uint64_t size;
+		uint32_t previousPhysical;
+		uint32_t nextPhysical;
+		uint32_t previousFree;
+		uint32_t nextFree;
+		bool bFree;
+	};
+
+	static void mapping(uint64_t size, uint32_t& firstLevel, uint32_t& secondLevel);
+
+	uint32_t create_node(uint64_t offset, uint64_t size);
+	void release_node(uint32_t node);
+	void insert_free(uint32_t node);
+	void remove_free(uint32_t node);
+	// Head of the first non-empty list whose every region is at least size bytes
+	uint32_t find_free(uint64_t size) const;
+	// Splits the region after size bytes off node as a new free region
+	void split_tail(uint32_t node, uint64_t size);
+
+	uint64_t m_Capacity;
+	uint64_t m_UsedBytes = 0;
+	uint32_t m_AllocationCount = 0;
+	uint32_t m_FreeRegionCount = 0;
+
+	std::vector<FNode> m_Nodes{};
+	std::vector<uint32_t> m_UnusedNodes{};
+
+	uint64_t m_FirstLevelBitmap = 0;
+	std::array<uint32_t, FIRST_LEVEL_COUNT> m_SecondLevelBitmaps{};
+	std::array<uint32_t, FIRST_LEVEL_COUNT * SECOND_LEVEL_COUNT> m_FreeHeads{};
+};
+
+} // namespace SE
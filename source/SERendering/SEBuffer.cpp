@@ -6,19 +6,19 @@
 
 namespace SE {
 
-SEBuffer::SEBuffer(SEGraphicsDevice& device, VkDeviceSize instanceSize, uint32_t instanceCount, VkBufferUsageFlags usageFlags, VkMemoryPropertyFlags memoryPropertyFlags, VkDeviceSize minOffsetAlignment)
+SEBuffer::SEBuffer(SEGraphicsDevice& device, VkDeviceSize instanceSize, uint32_t instanceCount, VkBufferUsageFlags usageFlags, VkMemoryPropertyFlags memoryPropertyFlags, EMemoryCategory category, VkDeviceSize minOffsetAlignment)
     : m_GraphicsDevice{ device }, m_InstanceSize{ instanceSize }, m_InstanceCount{ instanceCount }, m_UsageFlags{ usageFlags }, m_MemoryPropertyFlags{ memoryPropertyFlags } 
 {
     m_AlignmentSize = get_alignment(instanceSize, minOffsetAlignment);
     m_BufferSize = m_AlignmentSize * instanceCount;
-    device.create_buffer(m_BufferSize, usageFlags, memoryPropertyFlags, m_Buffer, m_Memory);
+    device.create_buffer(m_BufferSize, usageFlags, memoryPropertyFlags, category, m_Buffer, m_Allocation);
 }
 
 SEBuffer::~SEBuffer() 
 {
     unmap();
     vkDestroyBuffer(m_GraphicsDevice.device(), m_Buffer, nullptr);
-    vkFreeMemory(m_GraphicsDevice.device(), m_Memory, nullptr);
+    m_GraphicsDevice.free_memory(m_Allocation);
 }
 
 // Returns the minimum instance size required to be compatible with devices minOffsetAlignment
@@ -32,22 +32,28 @@ VkDeviceSize SEBuffer::get_alignment(VkDeviceSize instanceSize, VkDeviceSize min
 }
 
 // Map a memory range of this buffer. If successful, mapped points to the specified buffer range.
+// The allocator keeps host visible blocks mapped, so this only points into the block's mapping, the range must lie in the buffer
 VkResult SEBuffer::map(VkDeviceSize size, VkDeviceSize offset)
 {
-    return vkMapMemory(m_GraphicsDevice.device(), m_Memory, offset, size, 0, &m_MappedData);
+    const bool bInBuffer = offset <= m_BufferSize && (size == VK_WHOLE_SIZE || size <= m_BufferSize - offset);
+    assert(bInBuffer && "Mapped range exceeds the buffer");
+    if (m_Allocation.mappedData == nullptr || !bInBuffer) 
+    {
+        return VK_ERROR_MEMORY_MAP_FAILED;
+    }
+    m_MappedData = static_cast<char*>(m_Allocation.mappedData) + offset;
+    m_MappedOffset = offset;
+    return VK_SUCCESS;
 }
 
-// Unmap a mapped memory range
+// Unmap a mapped memory range. The block stays mapped, other buffers may share it
 void SEBuffer::unmap()
 {
-    if (m_MappedData) 
-    {
-        vkUnmapMemory(m_GraphicsDevice.device(), m_Memory);
-        m_MappedData = nullptr;
-    }
+    m_MappedData = nullptr;
+    m_MappedOffset = 0;
 }
 
-// Copies the specified data to the mapped buffer. Default value writes whole buffer range
+// Copies the specified data to the mapped buffer and marks the range dirty. Default value writes whole buffer range
 void SEBuffer::write_to_buffer(void* data, VkDeviceSize size, VkDeviceSize offset)
 {
     assert(m_MappedData && "Cannot copy to unmapped buffer");
@@ -55,32 +61,41 @@ void SEBuffer::write_to_buffer(void* data, VkDeviceSize size, VkDeviceSize offse
     if (size == VK_WHOLE_SIZE) 
     {
         memcpy(m_MappedData, data, m_BufferSize);
+        mark_dirty(m_BufferSize, 0);
     } else {
         char* memOffset = (char*)m_MappedData;
         memOffset += offset;
         memcpy(memOffset, data, size);
+        mark_dirty(size, offset);
     }
 }
 
-// Flush a memory range of the buffer to make it visible to the device. Only required for non-coherent memory
+// Records a range written through the mapped pointer, offset is relative to the mapping. The device's per frame flush
+// makes it visible, nothing is recorded for coherent memory
+void SEBuffer::mark_dirty(VkDeviceSize size, VkDeviceSize offset)
+{
+    m_GraphicsDevice.get_memory_allocator().mark_dirty(m_Allocation, m_MappedOffset + offset, size);
+}
+
+// Flush a memory range of the buffer to make it visible to the device right away, instead of with the per frame flush.
+// Only required for non-coherent memory, skipped for coherent memory
 VkResult SEBuffer::flush(VkDeviceSize size, VkDeviceSize offset)
 {
-    VkMappedMemoryRange mappedRange = {};
-    mappedRange.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
-    mappedRange.memory = m_Memory;
-    mappedRange.offset = offset;
-    mappedRange.size = size;
+    SEMemoryAllocator& memoryAllocator = m_GraphicsDevice.get_memory_allocator();
+    if (memoryAllocator.is_coherent(m_Allocation)) { return VK_SUCCESS; }
+
+    const VkMappedMemoryRange mappedRange = memoryAllocator.get_mapped_range(m_Allocation, offset, size);
     return vkFlushMappedMemoryRanges(m_GraphicsDevice.device(), 1, &mappedRange);
 }
 
-// Invalidate a memory range of the buffer to make it visible to the host. Only required for non-coherent memory
+// Invalidate a memory range of the buffer to make it visible to the host. Only required for non-coherent memory,
+// skipped for coherent memory
 VkResult SEBuffer::invalidate(VkDeviceSize size, VkDeviceSize offset)
 {
-    VkMappedMemoryRange mappedRange = {};
-    mappedRange.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
-    mappedRange.memory = m_Memory;
-    mappedRange.offset = offset;
-    mappedRange.size = size;
+    SEMemoryAllocator& memoryAllocator = m_GraphicsDevice.get_memory_allocator();
+    if (memoryAllocator.is_coherent(m_Allocation)) { return VK_SUCCESS; }
+
+    const VkMappedMemoryRange mappedRange = memoryAllocator.get_mapped_range(m_Allocation, offset, size);
     return vkInvalidateMappedMemoryRanges(m_GraphicsDevice.device(), 1, &mappedRange);
 }
 
@@ -8,7 +8,7 @@ class SEBuffer {
 
 public:
 #pragma region Lifecycle
-	SEBuffer(SEGraphicsDevice& device, VkDeviceSize instanceSize, uint32_t instanceCount, VkBufferUsageFlags usageFlags, VkMemoryPropertyFlags memoryPropertyFlags, VkDeviceSize minOffsetAlignment = 1);
+	SEBuffer(SEGraphicsDevice& device, VkDeviceSize instanceSize, uint32_t instanceCount, VkBufferUsageFlags usageFlags, VkMemoryPropertyFlags memoryPropertyFlags, EMemoryCategory category, VkDeviceSize minOffsetAlignment = 1);
 	~SEBuffer();
 
 	SEBuffer(const SEBuffer&) = delete;
@@ -18,6 +18,7 @@ public:
 	VkResult map(VkDeviceSize size = VK_WHOLE_SIZE, VkDeviceSize offset = 0);
 	void unmap();
 	void write_to_buffer(void* data, VkDeviceSize size = VK_WHOLE_SIZE, VkDeviceSize offset = 0);
+	void mark_dirty(VkDeviceSize size = VK_WHOLE_SIZE, VkDeviceSize offset = 0);
 	VkResult flush(VkDeviceSize size = VK_WHOLE_SIZE, VkDeviceSize offset = 0);
 	VkResult invalidate(VkDeviceSize size = VK_WHOLE_SIZE, VkDeviceSize offset = 0);
 
@@ -43,8 +44,9 @@ private:
 
 	SEGraphicsDevice& m_GraphicsDevice;
 	void* m_MappedData = nullptr;
+	VkDeviceSize m_MappedOffset = 0;
 	VkBuffer m_Buffer = VK_NULL_HANDLE;
-	VkDeviceMemory m_Memory = VK_NULL_HANDLE;
+	FMemoryAllocation m_Allocation{};
 
 	VkDeviceSize m_BufferSize;
 	uint32_t m_InstanceCount;
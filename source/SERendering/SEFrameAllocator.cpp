@@ -0,0 +1,53 @@
+#include "SEFrameAllocator.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace SE {
+
+#pragma region Lifecycle
+SEFrameAllocator::SEFrameAllocator(SEGraphicsDevice& device, uint32_t frameCount, VkDeviceSize frameCapacity)
+	: m_FrameCapacity{frameCapacity}
+{
+	const VkPhysicalDeviceLimits& limits = device.properties.limits;
+	m_UniformAlignment = std::max<VkDeviceSize>(limits.minUniformBufferOffsetAlignment, 1);
+	m_StorageAlignment = std::max<VkDeviceSize>(limits.minStorageBufferOffsetAlignment, 1);
+
+	const VkBufferUsageFlags usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT |
+		VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+	m_Buffer = std::make_unique<SEBuffer>(device, frameCapacity, frameCount, usage, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, EMemoryCategory::Uniforms, m_UniformAlignment);
+	if (m_Buffer->map() != VK_SUCCESS)
+	{
+		throw std::runtime_error("failed to map frame allocator!");
+	}
+
+	m_FrameEnd = m_FrameCapacity;
+}
+#pragma endregion Lifecycle
+
+void SEFrameAllocator::begin_frame(uint32_t frameIndex)
+{
+	m_PeakFrameBytes = std::max(m_PeakFrameBytes, get_frame_used_bytes());
+
+	m_FrameStart = frameIndex * m_Buffer->get_alignment_size();
+	m_FrameEnd = m_FrameStart + m_FrameCapacity;
+	m_Head.store(m_FrameStart, std::memory_order_relaxed);
+}
+
+bool SEFrameAllocator::allocate(VkDeviceSize size, VkDeviceSize alignment, FFrameAllocation& allocation)
+{
+	VkDeviceSize head = m_Head.load(std::memory_order_relaxed);
+	VkDeviceSize start;
+	do
+	{
+		start = (head + alignment - 1) / alignment * alignment;
+		if (start + size > m_FrameEnd) { return false; }
+	} while (!m_Head.compare_exchange_weak(head, start + size, std::memory_order_relaxed));
+
+	allocation.data = static_cast<char*>(m_Buffer->get_mapped_memory()) + start;
+	allocation.offset = start;
+	allocation.size = size;
+	return true;
+}
+
+} // namespace SE
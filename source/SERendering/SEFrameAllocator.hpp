@@ -0,0 +1,65 @@
+#pragma once
+
+#include "SERendering/SEGraphicsDevice/SEGraphicsDevice.hpp"
+#include "SERendering/SEBuffer.hpp"
+
+#include <atomic>
+#include <memory>
+
+namespace SE {
+
+// Sub-range of the frame allocator's buffer, valid until the frame that allocated it is recorded again
+struct FFrameAllocation {
+	void* data = nullptr;			// Mapped, coherent memory
+	VkDeviceSize offset = 0;		// From the start of the buffer, the dynamic offset of descriptors bound to it
+	VkDeviceSize size = 0;
+};
+
+// Bump allocator for data written once per frame, such as uniforms, instance data and dynamic vertices. One persistently
+// mapped buffer is split into a region per frame in flight. Allocations advance the region's head, begin_frame rewinds
+// it once the frame's fence has signaled, so nothing is freed individually. Shaders reach the data through dynamic
+// descriptor offsets or buffer binding offsets, copies read it as a staging buffer. allocate is thread safe
+class SEFrameAllocator {
+
+public:
+	static constexpr VkDeviceSize DEFAULT_FRAME_CAPACITY = 4ull * 1024 * 1024;
+
+#pragma region Lifecycle
+	SEFrameAllocator(SEGraphicsDevice& device, uint32_t frameCount, VkDeviceSize frameCapacity = DEFAULT_FRAME_CAPACITY);
+	~SEFrameAllocator() = default;
+	SEFrameAllocator(const SEFrameAllocator&) = delete;
+	SEFrameAllocator& operator=(const SEFrameAllocator&) = delete;
+#pragma endregion Lifecycle
+
+	// Rewinds the region of frameIndex. The frame that used it last must have completed
+	void begin_frame(uint32_t frameIndex);
+
+	// Returns false when the frame's region is full
+	bool allocate(VkDeviceSize size, VkDeviceSize alignment, FFrameAllocation& allocation);
+	bool allocate_uniform(VkDeviceSize size, FFrameAllocation& allocation) { return allocate(size, m_UniformAlignment, allocation); }
+	bool allocate_storage(VkDeviceSize size, FFrameAllocation& allocation) { return allocate(size, m_StorageAlignment, allocation); }
+
+	VkBuffer get_buffer() const { return m_Buffer->get_buffer(); }
+	// For dynamic descriptors, range is the size the shader reads at each dynamic offset
+	VkDescriptorBufferInfo get_descriptor_info(VkDeviceSize range) const { return VkDescriptorBufferInfo{m_Buffer->get_buffer(), 0, range}; }
+
+	VkDeviceSize get_frame_capacity() const { return m_FrameCapacity; }
+	// Bytes allocated in the current frame, and the most any frame has used
+	VkDeviceSize get_frame_used_bytes() const { return m_Head.load(std::memory_order_relaxed) - m_FrameStart; }
+	VkDeviceSize get_frame_free_bytes() const { return m_FrameCapacity - get_frame_used_bytes(); }
+	VkDeviceSize get_peak_frame_bytes() const { return m_PeakFrameBytes; }
+
+private:
+
+	std::unique_ptr<SEBuffer> m_Buffer;
+	VkDeviceSize m_FrameCapacity;
+	VkDeviceSize m_UniformAlignment;
+	VkDeviceSize m_StorageAlignment;
+
+	VkDeviceSize m_FrameStart = 0;
+	VkDeviceSize m_FrameEnd = 0;
+	std::atomic<VkDeviceSize> m_Head{0};
+	VkDeviceSize m_PeakFrameBytes = 0;
+};
+
+} // namespace SE
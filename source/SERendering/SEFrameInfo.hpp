@@ -14,6 +14,9 @@ struct FFrameInfo
 	VkCommandBuffer commandBuffer;
 	SECamera& camera;
 	VkDescriptorSet descriptorSet;
+	uint64_t frameNumber{0};	// Frames recorded since startup, unlike frameIndex it never wraps
+	uint32_t globalUniformOffset{0};	// Dynamic offset of the global uniforms in descriptorSet
+	VkExtent2D viewportExtent{};		// Pixels covered by the render pass, for screen space metrics
 };
 
 }
\ No newline at end of file
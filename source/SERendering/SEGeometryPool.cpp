@@ -0,0 +1,88 @@
+#include "SEGeometryPool.hpp"
+
+namespace SE {
+
+#pragma region Lifecycle
+SEGeometryPool::SEGeometryPool(SEGraphicsDevice& device, VkDeviceSize vertexCapacity, VkDeviceSize indexCapacity)
+	: m_VertexRanges{vertexCapacity}, m_IndexRanges{indexCapacity}
+{
+	const VkMemoryPropertyFlags memoryProperties = device.get_static_buffer_memory_properties();
+	m_VertexBuffer = std::make_unique<SEBuffer>(device, vertexCapacity, 1, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, memoryProperties, EMemoryCategory::Geometry);
+	m_IndexBuffer = std::make_unique<SEBuffer>(device, indexCapacity, 1, VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, memoryProperties, EMemoryCategory::Geometry);
+
+	// Stays mapped for the lifetime of the pool
+	if (memoryProperties & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+	{
+		m_VertexBuffer->map();
+		m_IndexBuffer->map();
+	}
+}
+#pragma endregion Lifecycle
+
+bool SEGeometryPool::allocate_vertices(uint32_t vertexCount, uint32_t vertexStride, FGeometryRange& range)
+{
+	std::lock_guard<std::mutex> poolLock{m_Mutex};
+
+	// Strides are not powers of two, so the range is padded by one stride and its start rounded up to a multiple
+	SETlsfAllocator::FAllocation allocation{};
+	if (!m_VertexRanges.allocate((static_cast<uint64_t>(vertexCount) + 1) * vertexStride, 1, allocation))
+	{
+		m_FailedAllocations++;
+		return false;
+	}
+
+	range.first = static_cast<uint32_t>((allocation.offset + vertexStride - 1) / vertexStride);
+	range.node = allocation.node;
+	return true;
+}
+
+bool SEGeometryPool::allocate_indices(uint32_t indexCount, uint32_t indexSize, FGeometryRange& range)
+{
+	std::lock_guard<std::mutex> poolLock{m_Mutex};
+
+	SETlsfAllocator::FAllocation allocation{};
+	if (!m_IndexRanges.allocate(static_cast<uint64_t>(indexCount) * indexSize, indexSize, allocation))
+	{
+		m_FailedAllocations++;
+		return false;
+	}
+
+	range.first = static_cast<uint32_t>(allocation.offset / indexSize);
+	range.node = allocation.node;
+	return true;
+}
+
+void SEGeometryPool::free_vertices(FGeometryRange& range)
+{
+	if (!range.is_valid()) { return; }
+
+	std::lock_guard<std::mutex> poolLock{m_Mutex};
+	m_VertexRanges.free(range.node);
+	range = FGeometryRange{};
+}
+
+void SEGeometryPool::free_indices(FGeometryRange& range)
+{
+	if (!range.is_valid()) { return; }
+
+	std::lock_guard<std::mutex> poolLock{m_Mutex};
+	m_IndexRanges.free(range.node);
+	range = FGeometryRange{};
+}
+
+FGeometryPoolStats SEGeometryPool::get_stats()
+{
+	std::lock_guard<std::mutex> poolLock{m_Mutex};
+
+	FGeometryPoolStats stats{};
+	stats.vertexBytesUsed = m_VertexRanges.get_used_bytes();
+	stats.vertexCapacity = m_VertexRanges.get_capacity();
+	stats.indexBytesUsed = m_IndexRanges.get_used_bytes();
+	stats.indexCapacity = m_IndexRanges.get_capacity();
+	stats.vertexRanges = m_VertexRanges.get_allocation_count();
+	stats.indexRanges = m_IndexRanges.get_allocation_count();
+	stats.failedAllocations = m_FailedAllocations;
+	return stats;
+}
+
+} // namespace SE
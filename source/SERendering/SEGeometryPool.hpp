@@ -0,0 +1,77 @@
+#pragma once
+
+#include "SERendering/SEGraphicsDevice/SEGraphicsDevice.hpp"
+#include "SERendering/SEBuffer.hpp"
+#include "SECore/SEUtilities/SETlsfAllocator.hpp"
+
+#include <memory>
+#include <mutex>
+
+namespace SE {
+
+// Range of a geometry pool buffer holding one mesh's vertices or indices. first is in elements of the mesh's vertex
+// stride or index size, ready for the vertexOffset and firstIndex of a draw
+struct FGeometryRange {
+	uint32_t first = 0;
+	uint32_t node = SETlsfAllocator::INVALID_NODE;
+
+	bool is_valid() const { return node != SETlsfAllocator::INVALID_NODE; }
+};
+
+struct FGeometryPoolStats {
+	VkDeviceSize vertexBytesUsed = 0;
+	VkDeviceSize vertexCapacity = 0;
+	VkDeviceSize indexBytesUsed = 0;
+	VkDeviceSize indexCapacity = 0;
+	uint32_t vertexRanges = 0;
+	uint32_t indexRanges = 0;
+	uint32_t failedAllocations = 0;	// Requests that did not fit, those meshes own their buffers
+};
+
+// One device local vertex buffer and one index buffer shared by all meshes, so a frame binds geometry once instead of
+// per object. Vertices of every format live in the same buffer, each range starts on a multiple of its stride. 16 and
+// 32-bit indices share the index buffer, each range starts on a multiple of its index size. Thread safe
+class SEGeometryPool {
+
+public:
+	static constexpr VkDeviceSize DEFAULT_VERTEX_CAPACITY = 128ull * 1024 * 1024;
+	static constexpr VkDeviceSize DEFAULT_INDEX_CAPACITY = 64ull * 1024 * 1024;
+
+#pragma region Lifecycle
+	SEGeometryPool(SEGraphicsDevice& device, VkDeviceSize vertexCapacity = DEFAULT_VERTEX_CAPACITY, VkDeviceSize indexCapacity = DEFAULT_INDEX_CAPACITY);
+	~SEGeometryPool() = default;
+	SEGeometryPool(const SEGeometryPool&) = delete;
+	SEGeometryPool& operator=(const SEGeometryPool&) = delete;
+#pragma endregion Lifecycle
+
+	// Return false when the pool has no free range large enough
+	bool allocate_vertices(uint32_t vertexCount, uint32_t vertexStride, FGeometryRange& range);
+	bool allocate_indices(uint32_t indexCount, uint32_t indexSize, FGeometryRange& range);
+	// Callers make sure no frame in flight still reads the range
+	void free_vertices(FGeometryRange& range);
+	void free_indices(FGeometryRange& range);
+
+	// Byte offsets of ranges, for upload copies
+	static VkDeviceSize get_byte_offset(const FGeometryRange& range, uint32_t elementSize) { return static_cast<VkDeviceSize>(range.first) * elementSize; }
+
+	VkBuffer get_vertex_buffer() const { return m_VertexBuffer->get_buffer(); }
+	VkBuffer get_index_buffer() const { return m_IndexBuffer->get_buffer(); }
+	// Mapped pool memory on unified memory devices, ranges are written in place. nullptr otherwise, ranges are
+	// written through the staging ring
+	void* get_vertex_memory() const { return m_VertexBuffer->get_mapped_memory(); }
+	void* get_index_memory() const { return m_IndexBuffer->get_mapped_memory(); }
+
+	FGeometryPoolStats get_stats();
+
+private:
+
+	std::unique_ptr<SEBuffer> m_VertexBuffer;
+	std::unique_ptr<SEBuffer> m_IndexBuffer;
+
+	std::mutex m_Mutex;
+	SETlsfAllocator m_VertexRanges;
+	SETlsfAllocator m_IndexRanges;
+	uint32_t m_FailedAllocations = 0;
+};
+
+} // namespace SE
@@ -1,4 +1,9 @@
 #include "SEGraphicsDevice.hpp"
+#include "SERendering/SEGeometryPool.hpp"
+#include "SERendering/SESamplerCache.hpp"
+#include "SERendering/SEPipelineCache.hpp"
+#include "SERendering/SEStagingRing.hpp"
+#include <algorithm>
 #include <cstring>
 #include <iostream>
 #include <set>
@@ -44,12 +49,27 @@ namespace SE {
 		create_surface();
 		pick_physical_device();
 		create_logical_device();
+		create_memory_allocator();
 		create_command_pool();
+		create_geometry_pool();
+		create_staging_ring();
+		create_sampler_cache();
+		create_pipeline_cache();
 	}
 
 	SEGraphicsDevice::~SEGraphicsDevice() 
 	{
+		for (const auto& [threadId, commandPool] : m_ThreadCommandPools)
+		{
+			vkDestroyCommandPool(m_GraphicsDevice, commandPool, nullptr);
+		}
 		vkDestroyCommandPool(m_GraphicsDevice, m_CommandPool, nullptr);
+		// Saves the cache for the next run
+		m_PipelineCache.reset();
+		m_SamplerCache.reset();
+		m_StagingRing.reset();
+		m_GeometryPool.reset();
+		m_MemoryAllocator.reset();
 		vkDestroyDevice(m_GraphicsDevice, nullptr);
 
 		if (ENABLE_VALIDATION_LAYERS) 
@@ -74,7 +94,8 @@ namespace SE {
 		appInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
 		appInfo.pEngineName = "No Engine";
 		appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
-		appInfo.apiVersion = VK_API_VERSION_1_0;
+		// 1.1 for vkGetPhysicalDeviceMemoryProperties2, used by the memory budget query
+		appInfo.apiVersion = VK_API_VERSION_1_1;
 
 		VkInstanceCreateInfo createInfo = {};
 		createInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
@@ -142,7 +163,7 @@ namespace SE {
 		QueueFamilyIndices indices = find_queue_families(m_PhysicalDevice);
 
 		std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
-		std::set<uint32_t> uniqueQueueFamilies = { indices.graphicsFamily, indices.presentFamily };
+		std::set<uint32_t> uniqueQueueFamilies = { indices.graphicsFamily, indices.presentFamily, indices.transferFamily };
 
 		float queuePriority = 1.0f;
 
@@ -156,8 +177,16 @@ namespace SE {
 			queueCreateInfos.push_back(queueCreateInfo);
 		}
 
+		VkPhysicalDeviceFeatures supportedFeatures;
+		vkGetPhysicalDeviceFeatures(m_PhysicalDevice, &supportedFeatures);
+
+		// Indirect submission batches draws when the device can, render systems fall back to direct draws otherwise
+		m_bMultiDrawIndirect = supportedFeatures.multiDrawIndirect && supportedFeatures.drawIndirectFirstInstance;
+
 		VkPhysicalDeviceFeatures deviceFeatures = {};
 		deviceFeatures.samplerAnisotropy = VK_TRUE;
+		deviceFeatures.multiDrawIndirect = m_bMultiDrawIndirect ? VK_TRUE : VK_FALSE;
+		deviceFeatures.drawIndirectFirstInstance = m_bMultiDrawIndirect ? VK_TRUE : VK_FALSE;
 
 		VkDeviceCreateInfo createInfo = {};
 		createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
@@ -165,9 +194,16 @@ namespace SE {
 		createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
 		createInfo.pQueueCreateInfos = queueCreateInfos.data();
 
+		// Optional extensions are enabled when the device has them
+		std::vector<const char*> enabledExtensions = m_DeviceExtensions;
+		m_bMemoryBudget = properties.apiVersion >= VK_API_VERSION_1_1 && is_device_extension_supported(m_PhysicalDevice, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+		if (m_bMemoryBudget) { enabledExtensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME); }
+		const bool bDrawIndirectCount = m_bMultiDrawIndirect && is_device_extension_supported(m_PhysicalDevice, VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+		if (bDrawIndirectCount) { enabledExtensions.push_back(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME); }
+
 		createInfo.pEnabledFeatures = &deviceFeatures;
-		createInfo.enabledExtensionCount = static_cast<uint32_t>(m_DeviceExtensions.size());
-		createInfo.ppEnabledExtensionNames = m_DeviceExtensions.data();
+		createInfo.enabledExtensionCount = static_cast<uint32_t>(enabledExtensions.size());
+		createInfo.ppEnabledExtensionNames = enabledExtensions.data();
 
 		// might not really be necessary anymore because device specific validation layers
 		// have been deprecated
@@ -184,8 +220,17 @@ namespace SE {
 			throw std::runtime_error("failed to create logical device!");
 		}
 
+		if (bDrawIndirectCount)
+		{
+			m_CmdDrawIndexedIndirectCount = reinterpret_cast<PFN_vkCmdDrawIndexedIndirectCountKHR>(vkGetDeviceProcAddr(m_GraphicsDevice, "vkCmdDrawIndexedIndirectCountKHR"));
+		}
+
 		vkGetDeviceQueue(m_GraphicsDevice, indices.graphicsFamily, 0, &m_GraphicsQueue);
 		vkGetDeviceQueue(m_GraphicsDevice, indices.presentFamily, 0, &m_PresentQueue);
+		vkGetDeviceQueue(m_GraphicsDevice, indices.transferFamily, 0, &m_TransferQueue);
+		m_bSeparateTransferQueue = indices.has_separate_transfer_family();
+
+		std::cout << "transfer queue family: " << indices.transferFamily << (m_bSeparateTransferQueue ? "" : " (shared with graphics)") << std::endl;
 	}
 
 	void SEGraphicsDevice::create_command_pool() 
@@ -203,6 +248,60 @@ namespace SE {
 		}
 	}
 
+	void SEGraphicsDevice::create_memory_allocator()
+	{
+		PFN_vkGetPhysicalDeviceMemoryProperties2 getMemoryProperties2 = nullptr;
+		if (m_bMemoryBudget)
+		{
+			getMemoryProperties2 = reinterpret_cast<PFN_vkGetPhysicalDeviceMemoryProperties2>(vkGetInstanceProcAddr(m_Instance, "vkGetPhysicalDeviceMemoryProperties2"));
+		}
+		m_MemoryAllocator = std::make_unique<SEMemoryAllocator>(m_GraphicsDevice, m_PhysicalDevice, getMemoryProperties2);
+
+		// Discrete GPUs often expose a small host visible window of video memory as well. Only a host visible type on
+		// the largest device local heap counts, anything smaller would run out long before the geometry pool fits
+		const VkPhysicalDeviceMemoryProperties& memoryProperties = m_MemoryAllocator->get_memory_properties();
+		VkDeviceSize largestDeviceLocalHeap = 0;
+		for (uint32_t heapIndex = 0; heapIndex < memoryProperties.memoryHeapCount; heapIndex++)
+		{
+			if (memoryProperties.memoryHeaps[heapIndex].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)
+			{
+				largestDeviceLocalHeap = std::max(largestDeviceLocalHeap, memoryProperties.memoryHeaps[heapIndex].size);
+			}
+		}
+		for (uint32_t typeIndex = 0; typeIndex < memoryProperties.memoryTypeCount; typeIndex++)
+		{
+			const VkMemoryType& memoryType = memoryProperties.memoryTypes[typeIndex];
+			if ((memoryType.propertyFlags & UNIFIED_MEMORY_PROPERTIES) == UNIFIED_MEMORY_PROPERTIES &&
+				memoryProperties.memoryHeaps[memoryType.heapIndex].size >= largestDeviceLocalHeap)
+			{
+				m_bUnifiedMemory = true;
+				break;
+			}
+		}
+
+		std::cout << "unified memory: " << (m_bUnifiedMemory ? "yes, static buffers skip staging" : "no") << std::endl;
+	}
+
+	void SEGraphicsDevice::create_geometry_pool()
+	{
+		m_GeometryPool = std::make_unique<SEGeometryPool>(*this);
+	}
+
+	void SEGraphicsDevice::create_staging_ring()
+	{
+		m_StagingRing = std::make_unique<SEStagingRing>(*this);
+	}
+
+	void SEGraphicsDevice::create_sampler_cache()
+	{
+		m_SamplerCache = std::make_unique<SESamplerCache>(*this);
+	}
+
+	void SEGraphicsDevice::create_pipeline_cache()
+	{
+		m_PipelineCache = std::make_unique<SEPipelineCache>(*this);
+	}
+
 	void SEGraphicsDevice::create_surface() 
 	{ 
 		m_Window.create_window_surface(m_Instance, &m_Surface); 
@@ -370,6 +469,17 @@ namespace SE {
 		return requiredExtensions.empty();
 	}
 
+	bool SEGraphicsDevice::is_device_extension_supported(VkPhysicalDevice device, const char* extensionName)
+	{
+		uint32_t extensionCount;
+		vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
+
+		std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+		vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, availableExtensions.data());
+
+		return std::any_of(availableExtensions.begin(), availableExtensions.end(), [extensionName](const VkExtensionProperties& extension) { return strcmp(extension.extensionName, extensionName) == 0; });
+	}
+
 	QueueFamilyIndices SEGraphicsDevice::find_queue_families(VkPhysicalDevice device) 
 	{
 		QueueFamilyIndices indices;
@@ -402,6 +512,28 @@ namespace SE {
 			}
 			i++;
 		}
+
+		// Prefer a transfer only family, usually backed by the copy engines, then any other non graphics family. Graphics
+		// families support transfers implicitly, so the graphics family is the fallback
+		uint32_t bestTransferScore = 0;
+		for (uint32_t familyIndex = 0; familyIndex < queueFamilyCount; familyIndex++)
+		{
+			const VkQueueFlags queueFlags = queueFamilies[familyIndex].queueFlags;
+			if (queueFamilies[familyIndex].queueCount == 0 || !(queueFlags & VK_QUEUE_TRANSFER_BIT) || (queueFlags & VK_QUEUE_GRAPHICS_BIT)) { continue; }
+
+			const uint32_t transferScore = (queueFlags & VK_QUEUE_COMPUTE_BIT) ? 1 : 2;
+			if (transferScore > bestTransferScore)
+			{
+				indices.transferFamily = familyIndex;
+				indices.transferFamilyHasValue = true;
+				bestTransferScore = transferScore;
+			}
+		}
+		if (!indices.transferFamilyHasValue && indices.graphicsFamilyHasValue)
+		{
+			indices.transferFamily = indices.graphicsFamily;
+			indices.transferFamilyHasValue = true;
+		}
 		return indices;
 	}
 
@@ -463,7 +595,7 @@ namespace SE {
 		throw std::runtime_error("failed to find suitable memory type!");
 	}
 
-	void SEGraphicsDevice::create_buffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory) 
+	void SEGraphicsDevice::create_buffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, EMemoryCategory category, VkBuffer& buffer, FMemoryAllocation& bufferAllocation) 
 	{
 		VkBufferCreateInfo bufferInfo{};
 		bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
@@ -479,17 +611,49 @@ namespace SE {
 		VkMemoryRequirements memRequirements;
 		vkGetBufferMemoryRequirements(m_GraphicsDevice, buffer, &memRequirements);
 
-		VkMemoryAllocateInfo allocInfo{};
-		allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-		allocInfo.allocationSize = memRequirements.size;
-		allocInfo.memoryTypeIndex = find_memory_type(memRequirements.memoryTypeBits, properties);
+		bufferAllocation = m_MemoryAllocator->allocate(memRequirements, find_memory_type(memRequirements.memoryTypeBits, properties), true, category);
+		vkBindBufferMemory(m_GraphicsDevice, buffer, bufferAllocation.memory, bufferAllocation.offset);
+	}
 
-		if (vkAllocateMemory(m_GraphicsDevice, &allocInfo, nullptr, &bufferMemory) != VK_SUCCESS) 
+	void SEGraphicsDevice::wait_idle()
+	{
+		// Waiting for the device accesses every queue
+		std::lock_guard<std::mutex> queueLock{m_QueueMutex};
+		std::unique_lock<std::mutex> transferQueueLock{m_TransferQueueMutex, std::defer_lock};
+		if (m_bSeparateTransferQueue) { transferQueueLock.lock(); }
+		vkDeviceWaitIdle(m_GraphicsDevice);
+	}
+
+	VkCommandPool SEGraphicsDevice::get_thread_command_pool()
+	{
+		if (std::this_thread::get_id() == m_MainThreadId) { return m_CommandPool; }
+
+		std::lock_guard<std::mutex> poolLock{m_ThreadCommandPoolMutex};
+		VkCommandPool& commandPool = m_ThreadCommandPools[std::this_thread::get_id()];
+		if (commandPool == VK_NULL_HANDLE)
 		{
-			throw std::runtime_error("failed to allocate vertex buffer memory!");
+			VkCommandPoolCreateInfo poolInfo = {};
+			poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+			poolInfo.queueFamilyIndex = find_physical_queue_families().graphicsFamily;
+			poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+
+			if (vkCreateCommandPool(m_GraphicsDevice, &poolInfo, nullptr, &commandPool) != VK_SUCCESS)
+			{
+				m_ThreadCommandPools.erase(std::this_thread::get_id());
+				throw std::runtime_error("failed to create thread command pool!");
+			}
 		}
+		return commandPool;
+	}
+
+	void SEGraphicsDevice::release_thread_command_pool()
+	{
+		std::lock_guard<std::mutex> poolLock{m_ThreadCommandPoolMutex};
+		auto commandPoolIterator = m_ThreadCommandPools.find(std::this_thread::get_id());
+		if (commandPoolIterator == m_ThreadCommandPools.end()) { return; }
 
-		vkBindBufferMemory(m_GraphicsDevice, buffer, bufferMemory, 0);
+		vkDestroyCommandPool(m_GraphicsDevice, commandPoolIterator->second, nullptr);
+		m_ThreadCommandPools.erase(commandPoolIterator);
 	}
 
 	VkCommandBuffer SEGraphicsDevice::begin_single_time_commands() 
@@ -497,7 +661,7 @@ namespace SE {
 		VkCommandBufferAllocateInfo allocInfo{};
 		allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
 		allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-		allocInfo.commandPool = m_CommandPool;
+		allocInfo.commandPool = get_thread_command_pool();
 		allocInfo.commandBufferCount = 1;
 
 		VkCommandBuffer commandBuffer;
@@ -520,19 +684,29 @@ namespace SE {
 		submitInfo.commandBufferCount = 1;
 		submitInfo.pCommandBuffers = &commandBuffer;
 
-		vkQueueSubmit(m_GraphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
-		vkQueueWaitIdle(m_GraphicsQueue);
+		// Wait on a fence rather than the whole queue, so frames submitted by the main thread are not waited for
+		VkFenceCreateInfo fenceInfo{};
+		fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+		VkFence fence;
+		vkCreateFence(m_GraphicsDevice, &fenceInfo, nullptr, &fence);
 
-		vkFreeCommandBuffers(m_GraphicsDevice, m_CommandPool, 1, &commandBuffer);
+		{
+			std::lock_guard<std::mutex> queueLock{m_QueueMutex};
+			vkQueueSubmit(m_GraphicsQueue, 1, &submitInfo, fence);
+		}
+		vkWaitForFences(m_GraphicsDevice, 1, &fence, VK_TRUE, UINT64_MAX);
+		vkDestroyFence(m_GraphicsDevice, fence, nullptr);
+
+		vkFreeCommandBuffers(m_GraphicsDevice, get_thread_command_pool(), 1, &commandBuffer);
 	}
 
-	void SEGraphicsDevice::copy_buffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size) 
+	void SEGraphicsDevice::copy_buffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size, VkDeviceSize dstOffset) 
 	{
 		VkCommandBuffer commandBuffer = begin_single_time_commands();
 
 		VkBufferCopy copyRegion{};
 		copyRegion.srcOffset = 0;  // Optional
-		copyRegion.dstOffset = 0;  // Optional
+		copyRegion.dstOffset = dstOffset;
 		copyRegion.size = size;
 		vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, 1, &copyRegion);
 
@@ -560,7 +734,7 @@ namespace SE {
 		end_single_time_commands(commandBuffer);
 	}
 
-	void SEGraphicsDevice::create_image_with_info(const VkImageCreateInfo& imageInfo, VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory) 
+	void SEGraphicsDevice::create_image_with_info(const VkImageCreateInfo& imageInfo, VkMemoryPropertyFlags properties, EMemoryCategory category, VkImage& image, FMemoryAllocation& imageAllocation) 
 	{
 		if (vkCreateImage(m_GraphicsDevice, &imageInfo, nullptr, &image) != VK_SUCCESS) 
 		{
@@ -570,17 +744,11 @@ namespace SE {
 		VkMemoryRequirements memRequirements;
 		vkGetImageMemoryRequirements(m_GraphicsDevice, image, &memRequirements);
 
-		VkMemoryAllocateInfo allocInfo{};
-		allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-		allocInfo.allocationSize = memRequirements.size;
-		allocInfo.memoryTypeIndex = find_memory_type(memRequirements.memoryTypeBits, properties);
-
-		if (vkAllocateMemory(m_GraphicsDevice, &allocInfo, nullptr, &imageMemory) != VK_SUCCESS) 
-		{
-			throw std::runtime_error("failed to allocate image memory!");
-		}
+		// Linear images may share blocks with buffers, optimal images are kept apart for bufferImageGranularity
+		const bool bLinear = imageInfo.tiling == VK_IMAGE_TILING_LINEAR;
+		imageAllocation = m_MemoryAllocator->allocate(memRequirements, find_memory_type(memRequirements.memoryTypeBits, properties), bLinear, category);
 
-		if (vkBindImageMemory(m_GraphicsDevice, image, imageMemory, 0) != VK_SUCCESS) 
+		if (vkBindImageMemory(m_GraphicsDevice, image, imageAllocation.memory, imageAllocation.offset) != VK_SUCCESS) 
 		{
 			throw std::runtime_error("failed to bind image memory!");
 		}
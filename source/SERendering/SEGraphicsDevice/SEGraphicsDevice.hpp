@@ -2,11 +2,21 @@
 
 #include "vulkan/vulkan.h"
 #include "SERendering/SEWindow/SEWindow.hpp"
+#include "SERendering/SEGraphicsDevice/SEMemoryAllocator.hpp"
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 
 namespace SE {
 
+	class SEGeometryPool;
+	class SEPipelineCache;
+	class SESamplerCache;
+	class SEStagingRing;
+
 	struct SwapChainSupportDetails {
 		VkSurfaceCapabilitiesKHR capabilities;
 		std::vector<VkSurfaceFormatKHR> formats;
@@ -16,9 +26,13 @@ namespace SE {
 	struct QueueFamilyIndices {
 		uint32_t graphicsFamily;
 		uint32_t presentFamily;
+		uint32_t transferFamily;
 		bool graphicsFamilyHasValue = false;
 		bool presentFamilyHasValue = false;
+		bool transferFamilyHasValue = false;
 		bool complete() { return graphicsFamilyHasValue && presentFamilyHasValue; }
+		// Uploads run on a queue of their own family, resources they write change owner on the way to graphics
+		bool has_separate_transfer_family() const { return transferFamilyHasValue && transferFamily != graphicsFamily; }
 	};
 
 	class SEGraphicsDevice {
@@ -40,21 +54,61 @@ namespace SE {
 		VkSurfaceKHR surface() { return m_Surface; }
 		VkQueue graphicsQueue() { return m_GraphicsQueue; }
 		VkQueue presentQueue() { return m_PresentQueue; }
+		// The graphics queue when the device has no separate transfer family
+		VkQueue transferQueue() { return m_TransferQueue; }
 		QueueFamilyIndices find_physical_queue_families() { return find_queue_families(m_PhysicalDevice); }
 		SwapChainSupportDetails get_swap_chain_support() { return query_swap_chain_support(m_PhysicalDevice); }
 		uint32_t find_memory_type(uint32_t typeFilter, VkMemoryPropertyFlags properties);
 		VkFormat find_supported_format(const std::vector<VkFormat>& candidates, VkImageTiling tiling, VkFormatFeatureFlags features);
 
-		// Vertex Buffer
+		// Queue submissions and idle waits from any thread must hold this lock
+		std::mutex& get_queue_mutex() { return m_QueueMutex; }
+		std::mutex& get_transfer_queue_mutex() { return m_bSeparateTransferQueue ? m_TransferQueueMutex : m_QueueMutex; }
+		void wait_idle();
+
+		// Command pool of the calling thread, the main thread uses the device command pool. Threads that record
+		// single time commands call release_thread_command_pool before they exit
+		VkCommandPool get_thread_command_pool();
+		void release_thread_command_pool();
+
+		// Vertex Buffer. Single time commands can be recorded from any thread
 		VkCommandBuffer begin_single_time_commands();
 		void end_single_time_commands(VkCommandBuffer commandBuffer);
-		void create_buffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory);
-		void copy_buffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size);
+		// Memory of buffers and images is sub-allocated, release it with free_memory after destroying the resource. The
+		// category files the memory in the allocator's budget report
+		void create_buffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, EMemoryCategory category, VkBuffer& buffer, FMemoryAllocation& bufferAllocation);
+		void copy_buffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size, VkDeviceSize dstOffset = 0);
 		void copy_buffer_to_image(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height, uint32_t layerCount);
-		void create_image_with_info(const VkImageCreateInfo& imageInfo, VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory);
+		void create_image_with_info(const VkImageCreateInfo& imageInfo, VkMemoryPropertyFlags properties, EMemoryCategory category, VkImage& image, FMemoryAllocation& imageAllocation);
+		void free_memory(FMemoryAllocation& allocation) { m_MemoryAllocator->free(allocation); }
+		SEMemoryAllocator& get_memory_allocator() { return *m_MemoryAllocator; }
+		// Integrated and software devices expose their whole device local heap as host visible, static data is then
+		// written in place instead of going through the staging ring
+		bool has_unified_memory() const { return m_bUnifiedMemory; }
+		// Memory properties of buffers that hold static data, such as vertices and indices. Host visible on unified
+		// memory devices, buffers created with them are mapped and written directly
+		VkMemoryPropertyFlags get_static_buffer_memory_properties() const { return m_bUnifiedMemory ? UNIFIED_MEMORY_PROPERTIES : static_cast<VkMemoryPropertyFlags>(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT); }
+		// Shared vertex and index buffers of all meshes
+		SEGeometryPool& get_geometry_pool() { return *m_GeometryPool; }
+		// Batched uploads to device local buffers
+		SEStagingRing& get_staging_ring() { return *m_StagingRing; }
+		// Samplers shared by all textures
+		SESamplerCache& get_sampler_cache() { return *m_SamplerCache; }
+		// Several indirect draws per call with non-zero firstInstance (multiDrawIndirect and drawIndirectFirstInstance)
+		bool supports_multi_draw_indirect() const { return m_bMultiDrawIndirect; }
+		// VK_KHR_draw_indirect_count, the draw count is read from a buffer
+		bool supports_draw_indirect_count() const { return m_CmdDrawIndexedIndirectCount != nullptr; }
+		void cmd_draw_indexed_indirect_count(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset, VkBuffer countBuffer, VkDeviceSize countBufferOffset, uint32_t maxDrawCount, uint32_t stride)
+		{
+			m_CmdDrawIndexedIndirectCount(commandBuffer, buffer, offset, countBuffer, countBufferOffset, maxDrawCount, stride);
+		}
+		// Pipeline cache shared by all pipelines, kept on disk between runs
+		SEPipelineCache& get_pipeline_cache() { return *m_PipelineCache; }
 
 		VkPhysicalDeviceProperties properties;
 
+		static constexpr VkMemoryPropertyFlags UNIFIED_MEMORY_PROPERTIES = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+
 #ifdef NDEBUG
 		const bool ENABLE_VALIDATION_LAYERS = false;
 #else
@@ -68,6 +122,11 @@ namespace SE {
 		void pick_physical_device();
 		void create_logical_device();
 		void create_command_pool();
+		void create_memory_allocator();
+		void create_geometry_pool();
+		void create_staging_ring();
+		void create_sampler_cache();
+		void create_pipeline_cache();
 
 		bool check_device_suitability(VkPhysicalDevice device);
 		std::vector<const char*> get_required_extensions();
@@ -76,6 +135,7 @@ namespace SE {
 		void populate_debug_messenger_create_info(VkDebugUtilsMessengerCreateInfoEXT& createInfo);
 		void has_gflw_required_instance_extensions();
 		bool check_device_extensions_support(VkPhysicalDevice device);
+		bool is_device_extension_supported(VkPhysicalDevice device, const char* extensionName);
 		SwapChainSupportDetails query_swap_chain_support(VkPhysicalDevice device);
 
 		VkInstance m_Instance;
@@ -84,10 +144,28 @@ namespace SE {
 		SEWindow& m_Window;
 		VkCommandPool m_CommandPool;
 
+		std::mutex m_QueueMutex;
+		std::mutex m_TransferQueueMutex;
+		std::mutex m_ThreadCommandPoolMutex;
+		std::thread::id m_MainThreadId = std::this_thread::get_id();
+		std::unordered_map<std::thread::id, VkCommandPool> m_ThreadCommandPools;
+
 		VkDevice m_GraphicsDevice;
 		VkSurfaceKHR m_Surface;
 		VkQueue m_GraphicsQueue;
 		VkQueue m_PresentQueue;
+		VkQueue m_TransferQueue;
+		bool m_bSeparateTransferQueue = false;
+
+		std::unique_ptr<SEMemoryAllocator> m_MemoryAllocator;
+		bool m_bUnifiedMemory = false;
+		bool m_bMemoryBudget = false;		// VK_EXT_memory_budget is enabled
+		bool m_bMultiDrawIndirect = false;
+		PFN_vkCmdDrawIndexedIndirectCountKHR m_CmdDrawIndexedIndirectCount = nullptr;
+		std::unique_ptr<SEGeometryPool> m_GeometryPool;
+		std::unique_ptr<SEStagingRing> m_StagingRing;
+		std::unique_ptr<SESamplerCache> m_SamplerCache;
+		std::unique_ptr<SEPipelineCache> m_PipelineCache;
 
 		const std::vector<const char*> m_ValidationLayers = { "VK_LAYER_KHRONOS_validation" };
 		const std::vector<const char*> m_DeviceExtensions = { VK_KHR_SWAPCHAIN_EXTENSION_NAME };
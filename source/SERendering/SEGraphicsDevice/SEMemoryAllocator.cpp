@@ -0,0 +1,488 @@
+#include "SEMemoryAllocator.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+
+namespace SE {
+
+	const char* get_memory_category_name(EMemoryCategory category)
+	{
+		switch (category)
+		{
+			case EMemoryCategory::Geometry: return "geometry";
+			case EMemoryCategory::Staging: return "staging";
+			case EMemoryCategory::Uniforms: return "uniforms";
+			case EMemoryCategory::Depth: return "depth";
+			case EMemoryCategory::Textures: return "textures";
+			case EMemoryCategory::Indirect: return "indirect";
+			default: return "other";
+		}
+	}
+
+#pragma region Lifecycle
+	SEMemoryAllocator::SEMemoryAllocator(VkDevice device, VkPhysicalDevice physicalDevice, PFN_vkGetPhysicalDeviceMemoryProperties2 getMemoryProperties2)
+		: m_Device{device}, m_PhysicalDevice{physicalDevice}, m_GetMemoryProperties2{getMemoryProperties2}
+	{
+		vkGetPhysicalDeviceMemoryProperties(physicalDevice, &m_MemoryProperties);
+		for (uint32_t heapIndex = 0; heapIndex < m_MemoryProperties.memoryHeapCount; heapIndex++)
+		{
+			m_HeapStats[heapIndex].heapSize = m_MemoryProperties.memoryHeaps[heapIndex].size;
+			m_HeapStats[heapIndex].bDeviceLocal = (m_MemoryProperties.memoryHeaps[heapIndex].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0;
+		}
+
+		VkPhysicalDeviceProperties physicalDeviceProperties;
+		vkGetPhysicalDeviceProperties(physicalDevice, &physicalDeviceProperties);
+		m_NonCoherentAtomSize = std::max<VkDeviceSize>(physicalDeviceProperties.limits.nonCoherentAtomSize, 1);
+
+		// Small heaps (resizable BAR windows, integrated carve-outs) get smaller blocks so one block does not take
+		// most of the heap
+		for (uint32_t memoryTypeIndex = 0; memoryTypeIndex < m_MemoryProperties.memoryTypeCount; memoryTypeIndex++)
+		{
+			const VkDeviceSize heapSize = m_MemoryProperties.memoryHeaps[m_MemoryProperties.memoryTypes[memoryTypeIndex].heapIndex].size;
+			const VkDeviceSize blockSize = std::max<VkDeviceSize>(std::min(DEFAULT_BLOCK_SIZE, heapSize / 8), SETlsfAllocator::ALLOCATION_GRANULE);
+			get_pool(memoryTypeIndex, false).blockSize = blockSize;
+			get_pool(memoryTypeIndex, true).blockSize = blockSize;
+		}
+	}
+
+	SEMemoryAllocator::~SEMemoryAllocator()
+	{
+		for (FMemoryPool& pool : m_Pools)
+		{
+			for (std::unique_ptr<FMemoryBlock>& block : pool.blocks)
+			{
+				if (block) { free_device_memory(block->memory, block->mappedData); }
+			}
+		}
+	}
+#pragma endregion Lifecycle
+
+	FMemoryAllocation SEMemoryAllocator::allocate(const VkMemoryRequirements& memoryRequirements, uint32_t memoryTypeIndex, bool bLinear, EMemoryCategory category)
+	{
+		VkDeviceSize size = memoryRequirements.size;
+		VkDeviceSize alignment = std::max<VkDeviceSize>(memoryRequirements.alignment, 1);
+
+		// Flushes of one allocation must not reach into the atoms of its neighbours
+		const VkMemoryPropertyFlags propertyFlags = m_MemoryProperties.memoryTypes[memoryTypeIndex].propertyFlags;
+		if ((propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) && !(propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT))
+		{
+			alignment = std::max(alignment, m_NonCoherentAtomSize);
+			size = (size + m_NonCoherentAtomSize - 1) / m_NonCoherentAtomSize * m_NonCoherentAtomSize;
+		}
+
+		FMemoryAllocation allocation{};
+		allocation.memoryTypeIndex = memoryTypeIndex;
+		allocation.bLinear = bLinear;
+		allocation.category = category;
+
+		std::lock_guard<std::mutex> allocatorLock{m_Mutex};
+		FMemoryPool& pool = get_pool(memoryTypeIndex, bLinear);
+
+		if (size > pool.blockSize / 2)
+		{
+			allocation.memory = allocate_device_memory(size, memoryTypeIndex, &allocation.mappedData);
+			allocation.size = size;
+			allocation.blockIndex = DEDICATED_BLOCK;
+			m_DedicatedAllocations++;
+			m_DedicatedBytes += size;
+			track_reserved(memoryTypeIndex, size, true);
+			track_used(allocation, true);
+			return allocation;
+		}
+
+		SETlsfAllocator::FAllocation range{};
+		uint32_t blockIndex = 0;
+		for (; blockIndex < pool.blocks.size(); blockIndex++)
+		{
+			if (pool.blocks[blockIndex] && pool.blocks[blockIndex]->allocator->allocate(size, alignment, range)) { break; }
+		}
+
+		if (blockIndex == pool.blocks.size())
+		{
+			auto block = std::make_unique<FMemoryBlock>();
+			block->memory = allocate_device_memory(pool.blockSize, memoryTypeIndex, &block->mappedData);
+			block->allocator = std::make_unique<SETlsfAllocator>(pool.blockSize);
+			block->allocator->allocate(size, alignment, range);
+			track_reserved(memoryTypeIndex, pool.blockSize, true);
+
+			auto emptySlot = std::find(pool.blocks.begin(), pool.blocks.end(), nullptr);
+			blockIndex = static_cast<uint32_t>(emptySlot - pool.blocks.begin());
+			if (emptySlot == pool.blocks.end()) { pool.blocks.push_back(std::move(block)); }
+			else { *emptySlot = std::move(block); }
+		}
+
+		const FMemoryBlock& block = *pool.blocks[blockIndex];
+		allocation.memory = block.memory;
+		allocation.offset = range.offset;
+		allocation.size = range.size;
+		allocation.mappedData = block.mappedData ? static_cast<char*>(block.mappedData) + range.offset : nullptr;
+		allocation.blockIndex = blockIndex;
+		allocation.node = range.node;
+		track_used(allocation, true);
+		return allocation;
+	}
+
+	void SEMemoryAllocator::free(FMemoryAllocation& allocation)
+	{
+		if (allocation.memory == VK_NULL_HANDLE) { return; }
+
+		// Ranges still marked must not be flushed once the memory is gone or reused
+		if (!is_coherent(allocation))
+		{
+			std::lock_guard<std::mutex> dirtyRangeLock{m_DirtyRangeMutex};
+			const VkDeviceSize allocationEnd = allocation.offset + allocation.size;
+			m_DirtyRanges.erase(std::remove_if(m_DirtyRanges.begin(), m_DirtyRanges.end(), [&allocation, allocationEnd](const VkMappedMemoryRange& range) {
+				return range.memory == allocation.memory && range.offset >= allocation.offset && range.offset < allocationEnd; }), m_DirtyRanges.end());
+		}
+
+		std::lock_guard<std::mutex> allocatorLock{m_Mutex};
+		track_used(allocation, false);
+		if (allocation.blockIndex == DEDICATED_BLOCK)
+		{
+			free_device_memory(allocation.memory, allocation.mappedData);
+			m_DedicatedAllocations--;
+			m_DedicatedBytes -= allocation.size;
+			track_reserved(allocation.memoryTypeIndex, allocation.size, false);
+			allocation = FMemoryAllocation{};
+			return;
+		}
+
+		FMemoryPool& pool = get_pool(allocation.memoryTypeIndex, allocation.bLinear);
+		std::unique_ptr<FMemoryBlock>& block = pool.blocks[allocation.blockIndex];
+		block->allocator->free(allocation.node);
+
+		// An empty block is returned to the driver unless it is the last one of its pool, which avoids allocating and
+		// freeing a block every time a single buffer is created and destroyed
+		if (block->allocator->is_empty())
+		{
+			const bool bOtherBlocks = std::any_of(pool.blocks.begin(), pool.blocks.end(), [&block](const std::unique_ptr<FMemoryBlock>& otherBlock) { return otherBlock && otherBlock != block; });
+			if (bOtherBlocks)
+			{
+				track_reserved(allocation.memoryTypeIndex, block->allocator->get_capacity(), false);
+				free_device_memory(block->memory, block->mappedData);
+				block.reset();
+			}
+		}
+		allocation = FMemoryAllocation{};
+	}
+
+	void SEMemoryAllocator::mark_dirty(const FMemoryAllocation& allocation, VkDeviceSize offset, VkDeviceSize size)
+	{
+		if (is_coherent(allocation)) { return; }
+
+		const VkMappedMemoryRange range = get_mapped_range(allocation, offset, size);
+		std::lock_guard<std::mutex> dirtyRangeLock{m_DirtyRangeMutex};
+		m_DirtyRanges.push_back(range);
+		m_RangesMarked++;
+	}
+
+	VkResult SEMemoryAllocator::flush_dirty_ranges()
+	{
+		std::lock_guard<std::mutex> dirtyRangeLock{m_DirtyRangeMutex};
+		if (m_DirtyRanges.empty()) { return VK_SUCCESS; }
+
+		// Overlapping and touching ranges of one memory object become one, the ranges are atom aligned already
+		std::sort(m_DirtyRanges.begin(), m_DirtyRanges.end(), [](const VkMappedMemoryRange& left, const VkMappedMemoryRange& right) {
+			return left.memory != right.memory ? left.memory < right.memory : left.offset < right.offset; });
+		m_FlushRanges.clear();
+		for (const VkMappedMemoryRange& range : m_DirtyRanges)
+		{
+			if (!m_FlushRanges.empty() && m_FlushRanges.back().memory == range.memory && range.offset <= m_FlushRanges.back().offset + m_FlushRanges.back().size)
+			{
+				VkMappedMemoryRange& merged = m_FlushRanges.back();
+				merged.size = std::max(merged.offset + merged.size, range.offset + range.size) - merged.offset;
+				continue;
+			}
+			m_FlushRanges.push_back(range);
+		}
+		m_DirtyRanges.clear();
+
+		m_RangesFlushed += m_FlushRanges.size();
+		m_FlushCalls++;
+		return vkFlushMappedMemoryRanges(m_Device, static_cast<uint32_t>(m_FlushRanges.size()), m_FlushRanges.data());
+	}
+
+	VkMappedMemoryRange SEMemoryAllocator::get_mapped_range(const FMemoryAllocation& allocation, VkDeviceSize offset, VkDeviceSize size) const
+	{
+		const VkDeviceSize allocationEnd = allocation.offset + allocation.size;
+		const VkDeviceSize start = allocation.offset + offset;
+		const VkDeviceSize end = size == VK_WHOLE_SIZE ? allocationEnd : std::min(start + size, allocationEnd);
+
+		VkMappedMemoryRange range{};
+		range.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+		range.memory = allocation.memory;
+		range.offset = start / m_NonCoherentAtomSize * m_NonCoherentAtomSize;
+		range.size = std::min((end + m_NonCoherentAtomSize - 1) / m_NonCoherentAtomSize * m_NonCoherentAtomSize, allocationEnd) - range.offset;
+		return range;
+	}
+
+	FMemoryAllocatorStats SEMemoryAllocator::get_stats()
+	{
+		FMemoryAllocatorStats stats{};
+		{
+			std::lock_guard<std::mutex> dirtyRangeLock{m_DirtyRangeMutex};
+			stats.rangesMarked = m_RangesMarked;
+			stats.rangesFlushed = m_RangesFlushed;
+			stats.flushCalls = m_FlushCalls;
+		}
+
+		std::lock_guard<std::mutex> allocatorLock{m_Mutex};
+		stats.dedicatedAllocations = m_DedicatedAllocations;
+		stats.reservedBytes = m_DedicatedBytes;
+		stats.usedBytes = m_DedicatedBytes;
+
+		VkDeviceSize freeBytes = 0;
+		for (const FMemoryPool& pool : m_Pools)
+		{
+			for (const std::unique_ptr<FMemoryBlock>& block : pool.blocks)
+			{
+				if (!block) { continue; }
+
+				stats.blockCount++;
+				stats.subAllocations += block->allocator->get_allocation_count();
+				stats.reservedBytes += block->allocator->get_capacity();
+				stats.usedBytes += block->allocator->get_used_bytes();
+				stats.freeRegionCount += block->allocator->get_free_region_count();
+				stats.largestFreeRegion = std::max<VkDeviceSize>(stats.largestFreeRegion, block->allocator->get_largest_free_region());
+				freeBytes += block->allocator->get_capacity() - block->allocator->get_used_bytes();
+			}
+		}
+
+		stats.deviceAllocations = stats.blockCount + stats.dedicatedAllocations;
+		stats.fragmentation = freeBytes > 0 ? 1.0f - static_cast<float>(stats.largestFreeRegion) / static_cast<float>(freeBytes) : 0.0f;
+		return stats;
+	}
+
+	FMemoryBudgetReport SEMemoryAllocator::get_budget_report()
+	{
+		FMemoryBudgetReport report{};
+		{
+			std::lock_guard<std::mutex> allocatorLock{m_Mutex};
+			report.categories = m_CategoryStats;
+			report.heaps.assign(m_HeapStats.begin(), m_HeapStats.begin() + m_MemoryProperties.memoryHeapCount);
+		}
+
+		VkPhysicalDeviceMemoryBudgetPropertiesEXT budgetProperties{};
+		budgetProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+		if (m_GetMemoryProperties2 != nullptr)
+		{
+			VkPhysicalDeviceMemoryProperties2 memoryProperties2{};
+			memoryProperties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+			memoryProperties2.pNext = &budgetProperties;
+			m_GetMemoryProperties2(m_PhysicalDevice, &memoryProperties2);
+			report.bDriverBudget = true;
+		}
+
+		VkDeviceSize largestDeviceLocalHeap = 0;
+		for (uint32_t heapIndex = 0; heapIndex < report.heaps.size(); heapIndex++)
+		{
+			FMemoryHeapBudget& heap = report.heaps[heapIndex];
+			heap.budgetBytes = report.bDriverBudget ? budgetProperties.heapBudget[heapIndex] : heap.heapSize / 10 * 8;
+			heap.usageBytes = report.bDriverBudget ? budgetProperties.heapUsage[heapIndex] : heap.reservedBytes;
+
+			if (heap.bDeviceLocal && heap.heapSize > largestDeviceLocalHeap)
+			{
+				largestDeviceLocalHeap = heap.heapSize;
+				report.deviceLocalHeap = heapIndex;
+			}
+		}
+		return report;
+	}
+
+	void SEMemoryAllocator::print_budget_report(std::ostream& stream)
+	{
+		constexpr double MEGABYTE = 1024.0 * 1024.0;
+		const FMemoryBudgetReport report = get_budget_report();
+
+		stream << "GPU memory, " << (report.bDriverBudget ? "driver budget (VK_EXT_memory_budget)" : "estimated budget, 80% of each heap") << '\n';
+		for (uint32_t heapIndex = 0; heapIndex < report.heaps.size(); heapIndex++)
+		{
+			const FMemoryHeapBudget& heap = report.heaps[heapIndex];
+			stream << "  heap " << heapIndex << (heap.bDeviceLocal ? " (device local)" : " (host)") << ": usage " << heap.usageBytes / MEGABYTE << " / budget "
+				<< heap.budgetBytes / MEGABYTE << " MB of " << heap.heapSize / MEGABYTE << " MB, reserved " << heap.reservedBytes / MEGABYTE << " (peak "
+				<< heap.peakReservedBytes / MEGABYTE << ") MB, used " << heap.usedBytes / MEGABYTE << " (peak " << heap.peakUsedBytes / MEGABYTE << ") MB\n";
+		}
+		for (uint32_t categoryIndex = 0; categoryIndex < MEMORY_CATEGORY_COUNT; categoryIndex++)
+		{
+			const FMemoryCategoryStats& category = report.categories[categoryIndex];
+			stream << "  " << get_memory_category_name(static_cast<EMemoryCategory>(categoryIndex)) << ": " << category.liveBytes / MEGABYTE << " MB in "
+				<< category.allocations << " allocations, peak " << category.peakBytes / MEGABYTE << " MB\n";
+		}
+	}
+
+	void SEMemoryAllocator::track_reserved(uint32_t memoryTypeIndex, VkDeviceSize size, bool bAllocated)
+	{
+		FMemoryHeapBudget& heap = m_HeapStats[m_MemoryProperties.memoryTypes[memoryTypeIndex].heapIndex];
+		if (!bAllocated)
+		{
+			heap.reservedBytes -= size;
+			return;
+		}
+		heap.reservedBytes += size;
+		heap.peakReservedBytes = std::max(heap.peakReservedBytes, heap.reservedBytes);
+	}
+
+	void SEMemoryAllocator::track_used(const FMemoryAllocation& allocation, bool bAllocated)
+	{
+		FMemoryCategoryStats& category = m_CategoryStats[static_cast<uint32_t>(allocation.category)];
+		FMemoryHeapBudget& heap = m_HeapStats[m_MemoryProperties.memoryTypes[allocation.memoryTypeIndex].heapIndex];
+		if (!bAllocated)
+		{
+			category.liveBytes -= allocation.size;
+			category.allocations--;
+			heap.usedBytes -= allocation.size;
+			return;
+		}
+		category.liveBytes += allocation.size;
+		category.peakBytes = std::max(category.peakBytes, category.liveBytes);
+		category.allocations++;
+		heap.usedBytes += allocation.size;
+		heap.peakUsedBytes = std::max(heap.peakUsedBytes, heap.usedBytes);
+	}
+
+	VkDeviceMemory SEMemoryAllocator::allocate_device_memory(VkDeviceSize size, uint32_t memoryTypeIndex, void** mappedData)
+	{
+		VkMemoryAllocateInfo allocInfo{};
+		allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+		allocInfo.allocationSize = size;
+		allocInfo.memoryTypeIndex = memoryTypeIndex;
+
+		VkDeviceMemory memory;
+		if (vkAllocateMemory(m_Device, &allocInfo, nullptr, &memory) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to allocate device memory block!");
+		}
+
+		*mappedData = nullptr;
+		if (is_host_visible(memoryTypeIndex) && vkMapMemory(m_Device, memory, 0, VK_WHOLE_SIZE, 0, mappedData) != VK_SUCCESS)
+		{
+			vkFreeMemory(m_Device, memory, nullptr);
+			throw std::runtime_error("failed to map device memory block!");
+		}
+		return memory;
+	}
+
+	void SEMemoryAllocator::free_device_memory(VkDeviceMemory memory, void* mappedData)
+	{
+		if (mappedData) { vkUnmapMemory(m_Device, memory); }
+		vkFreeMemory(m_Device, memory, nullptr);
+	}
+
+	void SEMemoryAllocator::benchmark_sub_allocation(uint32_t operationCount)
+	{
+		using Clock = std::chrono::high_resolution_clock;
+
+		// Buffer sized requests from 256 bytes (uniforms) to 8 MB (large meshes, staging), log uniform, with
+		// alignments from 16 bytes to 64 KB. The live set hovers around LIVE_ALLOCATIONS
+		constexpr uint32_t LIVE_ALLOCATIONS = 4096;
+		std::mt19937_64 random{42};
+		std::uniform_real_distribution<double> sizeExponent{8.0, 23.0};
+		std::uniform_int_distribution<uint32_t> alignmentShift{4, 16};
+
+		struct FLiveAllocation {
+			uint32_t blockIndex;
+			uint32_t node;
+			uint64_t size;
+		};
+		std::vector<std::unique_ptr<SETlsfAllocator>> blocks;
+		std::vector<FLiveAllocation> liveAllocations;
+		liveAllocations.reserve(LIVE_ALLOCATIONS * 2);
+
+		uint32_t dedicatedCount = 0;
+		uint32_t allocateCount = 0;
+		uint32_t freeCount = 0;
+		uint32_t blocksCreated = 0;
+		uint32_t peakBlocks = 0;
+		uint64_t liveBytes = 0;
+		uint64_t peakLiveBytes = 0;
+		double allocateSeconds = 0.0;
+		double freeSeconds = 0.0;
+
+		for (uint32_t operationIndex = 0; operationIndex < operationCount; operationIndex++)
+		{
+			const bool bAllocate = liveAllocations.size() < LIVE_ALLOCATIONS / 2 || (liveAllocations.size() < LIVE_ALLOCATIONS * 2 && (random() & 1) == 0);
+			if (bAllocate)
+			{
+				const uint64_t size = static_cast<uint64_t>(std::exp2(sizeExponent(random)));
+				const uint64_t alignment = 1ull << alignmentShift(random);
+				if (size > DEFAULT_BLOCK_SIZE / 2)
+				{
+					dedicatedCount++;
+					continue;
+				}
+
+				const auto allocateStart = Clock::now();
+				SETlsfAllocator::FAllocation range{};
+				uint32_t blockIndex = 0;
+				for (; blockIndex < blocks.size(); blockIndex++)
+				{
+					if (blocks[blockIndex] && blocks[blockIndex]->allocate(size, alignment, range)) { break; }
+				}
+				if (blockIndex == blocks.size())
+				{
+					auto emptySlot = std::find(blocks.begin(), blocks.end(), nullptr);
+					blockIndex = static_cast<uint32_t>(emptySlot - blocks.begin());
+					if (emptySlot == blocks.end()) { blocks.push_back(std::make_unique<SETlsfAllocator>(DEFAULT_BLOCK_SIZE)); }
+					else { *emptySlot = std::make_unique<SETlsfAllocator>(DEFAULT_BLOCK_SIZE); }
+					blocks[blockIndex]->allocate(size, alignment, range);
+					blocksCreated++;
+				}
+				allocateSeconds += std::chrono::duration<double>(Clock::now() - allocateStart).count();
+
+				liveAllocations.push_back(FLiveAllocation{blockIndex, range.node, range.size});
+				liveBytes += range.size;
+				peakLiveBytes = std::max(peakLiveBytes, liveBytes);
+				allocateCount++;
+			} else {
+				const size_t liveIndex = static_cast<size_t>(random() % liveAllocations.size());
+				const FLiveAllocation liveAllocation = liveAllocations[liveIndex];
+				liveAllocations[liveIndex] = liveAllocations.back();
+				liveAllocations.pop_back();
+
+				const auto freeStart = Clock::now();
+				std::unique_ptr<SETlsfAllocator>& block = blocks[liveAllocation.blockIndex];
+				block->free(liveAllocation.node);
+				if (block->is_empty() && std::count_if(blocks.begin(), blocks.end(), [](const std::unique_ptr<SETlsfAllocator>& otherBlock) { return otherBlock != nullptr; }) > 1)
+				{
+					block.reset();
+				}
+				freeSeconds += std::chrono::duration<double>(Clock::now() - freeStart).count();
+
+				liveBytes -= liveAllocation.size;
+				freeCount++;
+			}
+
+			const uint32_t liveBlocks = static_cast<uint32_t>(std::count_if(blocks.begin(), blocks.end(), [](const std::unique_ptr<SETlsfAllocator>& block) { return block != nullptr; }));
+			peakBlocks = std::max(peakBlocks, liveBlocks);
+		}
+
+		uint32_t liveBlocks = 0;
+		uint64_t freeBytes = 0;
+		uint64_t largestFreeRegion = 0;
+		uint32_t freeRegions = 0;
+		for (const std::unique_ptr<SETlsfAllocator>& block : blocks)
+		{
+			if (!block) { continue; }
+			liveBlocks++;
+			freeBytes += block->get_capacity() - block->get_used_bytes();
+			largestFreeRegion = std::max(largestFreeRegion, block->get_largest_free_region());
+			freeRegions += block->get_free_region_count();
+		}
+
+		constexpr double MEGABYTE = 1024.0 * 1024.0;
+		std::cout << "Sub-allocation benchmark, " << operationCount << " operations, " << DEFAULT_BLOCK_SIZE / (1024 * 1024) << " MB blocks\n";
+		std::cout << "  allocate: " << allocateCount << " in " << allocateSeconds * 1000.0 << " ms (" << allocateSeconds * 1e9 / std::max(allocateCount, 1u) << " ns each)\n";
+		std::cout << "  free:     " << freeCount << " in " << freeSeconds * 1000.0 << " ms (" << freeSeconds * 1e9 / std::max(freeCount, 1u) << " ns each)\n";
+		std::cout << "  device allocations: " << blocksCreated << " blocks created, peak " << peakBlocks << " live, plus " << dedicatedCount
+			<< " dedicated, instead of " << allocateCount + dedicatedCount << " vkAllocateMemory calls\n";
+		std::cout << "  peak live data " << peakLiveBytes / MEGABYTE << " MB in " << peakBlocks * (DEFAULT_BLOCK_SIZE / MEGABYTE) << " MB of blocks\n";
+		std::cout << "  end state: " << liveAllocations.size() << " allocations in " << liveBlocks << " blocks, " << 100.0 * liveBytes / std::max<double>(liveBlocks * static_cast<double>(DEFAULT_BLOCK_SIZE), 1.0)
+			<< "% used, " << freeRegions << " free regions, fragmentation "
+			<< (freeBytes > 0 ? 100.0 * (1.0 - static_cast<double>(largestFreeRegion) / static_cast<double>(freeBytes)) : 0.0) << "%\n";
+	}
+
+} // end SE namespace
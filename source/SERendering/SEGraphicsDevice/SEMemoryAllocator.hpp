@@ -0,0 +1,179 @@
+#pragma once
+
+#include "vulkan/vulkan.h"
+#include "SECore/SEUtilities/SETlsfAllocator.hpp"
+
+#include <array>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace SE {
+
+	// What a device allocation holds, every allocation is tagged with one for the budget report
+	enum class EMemoryCategory : uint8_t {
+		Geometry,		// Vertex and index buffers
+		Staging,		// Upload staging memory
+		Uniforms,		// Uniforms and other per frame data
+		Depth,			// Depth attachments
+		Textures,
+		Indirect,		// GPU culling's scene, and the draw commands, counts and instance data it writes
+		Other
+	};
+
+	static constexpr uint32_t MEMORY_CATEGORY_COUNT = 7;
+
+	const char* get_memory_category_name(EMemoryCategory category);
+
+	// Range of device memory backing one buffer or image. Several allocations share a VkDeviceMemory, so bind and map
+	// at offset, never from the start of memory
+	struct FMemoryAllocation {
+		VkDeviceMemory memory = VK_NULL_HANDLE;
+		VkDeviceSize offset = 0;
+		VkDeviceSize size = 0;
+		// Start of the allocation in the persistent mapping of its block, null unless the memory type is host visible
+		void* mappedData = nullptr;
+		uint32_t memoryTypeIndex = 0;
+		bool bLinear = true;
+		uint32_t blockIndex = 0;	// DEDICATED_BLOCK when the allocation owns its memory
+		uint32_t node = SETlsfAllocator::INVALID_NODE;
+		EMemoryCategory category = EMemoryCategory::Other;
+	};
+
+	struct FMemoryAllocatorStats {
+		uint32_t deviceAllocations = 0;		// Live vkAllocateMemory objects, blocks plus dedicated allocations
+		uint32_t blockCount = 0;
+		uint32_t dedicatedAllocations = 0;
+		uint32_t subAllocations = 0;
+		VkDeviceSize reservedBytes = 0;		// Device memory held, blocks plus dedicated allocations
+		VkDeviceSize usedBytes = 0;
+		uint32_t freeRegionCount = 0;
+		VkDeviceSize largestFreeRegion = 0;
+		// 1 - largest free region / free bytes over all blocks. 0 when the free space is one region
+		float fragmentation = 0.0f;
+		uint64_t rangesMarked = 0;			// Dirty ranges of non-coherent memory since startup
+		uint64_t rangesFlushed = 0;			// After merging
+		uint64_t flushCalls = 0;
+	};
+
+	struct FMemoryCategoryStats {
+		VkDeviceSize liveBytes = 0;
+		VkDeviceSize peakBytes = 0;
+		uint32_t allocations = 0;
+	};
+
+	struct FMemoryHeapBudget {
+		VkDeviceSize heapSize = 0;
+		bool bDeviceLocal = false;
+		// From VK_EXT_memory_budget, covering every process and the driver's own memory. Without the extension the
+		// budget is 80% of the heap and the usage is this process's reserved bytes
+		VkDeviceSize budgetBytes = 0;
+		VkDeviceSize usageBytes = 0;
+		// Device memory this allocator holds in the heap, and how much of it backs resources
+		VkDeviceSize reservedBytes = 0;
+		VkDeviceSize peakReservedBytes = 0;
+		VkDeviceSize usedBytes = 0;
+		VkDeviceSize peakUsedBytes = 0;
+	};
+
+	struct FMemoryBudgetReport {
+		std::array<FMemoryCategoryStats, MEMORY_CATEGORY_COUNT> categories{};
+		std::vector<FMemoryHeapBudget> heaps{};
+		uint32_t deviceLocalHeap = 0;		// The largest device local heap, where content budgets apply
+		bool bDriverBudget = false;			// Budgets and usage come from VK_EXT_memory_budget
+
+		const FMemoryCategoryStats& get_category(EMemoryCategory category) const { return categories[static_cast<uint32_t>(category)]; }
+	};
+
+	// Sub-allocates buffers and images from large VkDeviceMemory blocks, one TLSF allocator per block. Blocks are pooled
+	// per memory type, and linear resources (buffers, linear images) never share a block with optimal images, so
+	// bufferImageGranularity never applies between neighbours. Host visible blocks stay mapped for their lifetime.
+	// Thread safe
+	class SEMemoryAllocator {
+
+	public:
+		static constexpr VkDeviceSize DEFAULT_BLOCK_SIZE = 64ull * 1024 * 1024;
+		static constexpr uint32_t DEDICATED_BLOCK = UINT32_MAX;
+
+#pragma region Lifecycle
+		// With getMemoryProperties2 and VK_EXT_memory_budget enabled, budget reports carry the driver's budget
+		SEMemoryAllocator(VkDevice device, VkPhysicalDevice physicalDevice, PFN_vkGetPhysicalDeviceMemoryProperties2 getMemoryProperties2 = nullptr);
+		~SEMemoryAllocator();
+
+		SEMemoryAllocator(const SEMemoryAllocator&) = delete;
+		SEMemoryAllocator& operator=(const SEMemoryAllocator&) = delete;
+#pragma endregion Lifecycle
+
+		// Requests larger than half a block get memory of their own. Throws when the device is out of memory
+		FMemoryAllocation allocate(const VkMemoryRequirements& memoryRequirements, uint32_t memoryTypeIndex, bool bLinear, EMemoryCategory category);
+		void free(FMemoryAllocation& allocation);
+
+		// Host writes to non-coherent memory are recorded with mark_dirty and flushed together by flush_dirty_ranges, once
+		// per frame before the submission that reads them. Coherent memory needs neither, mark_dirty ignores it
+		bool is_coherent(const FMemoryAllocation& allocation) const { return (m_MemoryProperties.memoryTypes[allocation.memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) != 0; }
+		// offset is relative to the allocation, VK_WHOLE_SIZE covers the rest of it
+		void mark_dirty(const FMemoryAllocation& allocation, VkDeviceSize offset, VkDeviceSize size);
+		// Sorts and merges the marked ranges, then flushes them in one call
+		VkResult flush_dirty_ranges();
+		// Range of an allocation widened to nonCoherentAtomSize, for flushes and invalidates. Stays inside the
+		// allocation, non-coherent allocations are padded to whole atoms
+		VkMappedMemoryRange get_mapped_range(const FMemoryAllocation& allocation, VkDeviceSize offset, VkDeviceSize size) const;
+
+		FMemoryAllocatorStats get_stats();
+		// Live and peak bytes per category and per heap, against the driver's budget. Queries the driver, so call it
+		// at most once a frame
+		FMemoryBudgetReport get_budget_report();
+		void print_budget_report(std::ostream& stream);
+		const VkPhysicalDeviceMemoryProperties& get_memory_properties() const { return m_MemoryProperties; }
+
+		// Runs a random allocate and free workload against the block pooling and TLSF logic without a device, then
+		// prints the time per operation, the device allocations it would take and the fragmentation left behind
+		static void benchmark_sub_allocation(uint32_t operationCount = 1000000);
+
+	private:
+		struct FMemoryBlock {
+			VkDeviceMemory memory = VK_NULL_HANDLE;
+			void* mappedData = nullptr;
+			std::unique_ptr<SETlsfAllocator> allocator{};
+		};
+
+		struct FMemoryPool {
+			// Empty slots are reused, so block indices held by allocations stay valid
+			std::vector<std::unique_ptr<FMemoryBlock>> blocks{};
+			VkDeviceSize blockSize = 0;
+		};
+
+		FMemoryPool& get_pool(uint32_t memoryTypeIndex, bool bLinear) { return m_Pools[memoryTypeIndex * 2 + (bLinear ? 1 : 0)]; }
+		VkDeviceMemory allocate_device_memory(VkDeviceSize size, uint32_t memoryTypeIndex, void** mappedData);
+		void free_device_memory(VkDeviceMemory memory, void* mappedData);
+		bool is_host_visible(uint32_t memoryTypeIndex) const { return (m_MemoryProperties.memoryTypes[memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) != 0; }
+		// Callers hold m_Mutex
+		void track_reserved(uint32_t memoryTypeIndex, VkDeviceSize size, bool bAllocated);
+		void track_used(const FMemoryAllocation& allocation, bool bAllocated);
+
+
+		VkDevice m_Device;
+		VkPhysicalDevice m_PhysicalDevice;
+		PFN_vkGetPhysicalDeviceMemoryProperties2 m_GetMemoryProperties2;
+		VkPhysicalDeviceMemoryProperties m_MemoryProperties{};
+		VkDeviceSize m_NonCoherentAtomSize = 1;
+
+		std::mutex m_Mutex;
+		std::array<FMemoryPool, VK_MAX_MEMORY_TYPES * 2> m_Pools{};
+		uint32_t m_DedicatedAllocations = 0;
+		VkDeviceSize m_DedicatedBytes = 0;
+
+		std::array<FMemoryCategoryStats, MEMORY_CATEGORY_COUNT> m_CategoryStats{};
+		std::array<FMemoryHeapBudget, VK_MAX_MEMORY_HEAPS> m_HeapStats{};
+
+		// Guards only the dirty ranges, so marking does not contend with allocations
+		std::mutex m_DirtyRangeMutex;
+		std::vector<VkMappedMemoryRange> m_DirtyRanges{};
+		std::vector<VkMappedMemoryRange> m_FlushRanges{};
+		uint64_t m_RangesMarked = 0;
+		uint64_t m_RangesFlushed = 0;
+		uint64_t m_FlushCalls = 0;
+	};
+
+} // end SE namespace
@@ -0,0 +1,177 @@
+#include "SEParallelRecorder.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+
+namespace SE {
+
+#pragma region Lifecycle
+SEParallelRecorder::SEParallelRecorder(SEGraphicsDevice& device, uint32_t frameCount, uint32_t threadCount) : m_GraphicsDevice(device)
+{
+	if (threadCount == 0) { threadCount = std::max(1u, std::thread::hardware_concurrency()); }
+	m_ThreadCount = std::min(threadCount, MAX_THREAD_COUNT);
+
+	VkCommandPoolCreateInfo poolInfo{};
+	poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+	poolInfo.queueFamilyIndex = m_GraphicsDevice.find_physical_queue_families().graphicsFamily;
+	// Buffers are only reset together with their pool
+	poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+
+	m_Frames.resize(frameCount);
+	for (FFrameCommandPools& frame : m_Frames)
+	{
+		frame.commandPools.resize(m_ThreadCount, VK_NULL_HANDLE);
+		frame.commandBuffers.resize(m_ThreadCount, VK_NULL_HANDLE);
+		for (uint32_t threadIndex = 0; threadIndex < m_ThreadCount; threadIndex++)
+		{
+			if (vkCreateCommandPool(m_GraphicsDevice.device(), &poolInfo, nullptr, &frame.commandPools[threadIndex]) != VK_SUCCESS)
+			{
+				throw std::runtime_error("failed to create recording command pool!");
+			}
+
+			VkCommandBufferAllocateInfo allocateInfo{};
+			allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+			allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+			allocateInfo.commandPool = frame.commandPools[threadIndex];
+			allocateInfo.commandBufferCount = 1;
+			if (vkAllocateCommandBuffers(m_GraphicsDevice.device(), &allocateInfo, &frame.commandBuffers[threadIndex]) != VK_SUCCESS)
+			{
+				throw std::runtime_error("failed to allocate secondary command buffer!");
+			}
+		}
+	}
+
+	for (uint32_t threadIndex = 1; threadIndex < m_ThreadCount; threadIndex++)
+	{
+		m_Workers.emplace_back(&SEParallelRecorder::worker_loop, this, threadIndex);
+	}
+}
+
+SEParallelRecorder::~SEParallelRecorder()
+{
+	{
+		std::lock_guard<std::mutex> workLock{m_WorkMutex};
+		m_IsStopping = true;
+	}
+	m_WorkCondition.notify_all();
+	for (std::thread& worker : m_Workers)
+	{
+		worker.join();
+	}
+
+	// Destroying a pool frees its buffers, no frame may still execute them
+	m_GraphicsDevice.wait_idle();
+	for (FFrameCommandPools& frame : m_Frames)
+	{
+		for (VkCommandPool commandPool : frame.commandPools)
+		{
+			vkDestroyCommandPool(m_GraphicsDevice.device(), commandPool, nullptr);
+		}
+	}
+}
+#pragma endregion Lifecycle
+
+void SEParallelRecorder::begin_frame(uint32_t frameIndex)
+{
+	m_FrameIndex = frameIndex;
+	for (VkCommandPool commandPool : m_Frames[frameIndex].commandPools)
+	{
+		if (vkResetCommandPool(m_GraphicsDevice.device(), commandPool, 0) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to reset recording command pool!");
+		}
+	}
+}
+
+const std::vector<VkCommandBuffer>& SEParallelRecorder::record(VkRenderPass renderPass, uint32_t threadCount, const FRecordFunction& recordFunction)
+{
+	const std::chrono::steady_clock::time_point recordStart = std::chrono::steady_clock::now();
+
+	m_InheritanceInfo = VkCommandBufferInheritanceInfo{};
+	m_InheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+	m_InheritanceInfo.renderPass = renderPass;
+	m_InheritanceInfo.subpass = 0;
+
+	m_ActiveThreadCount = std::clamp(threadCount, 1u, m_ThreadCount);
+	m_RecordFunction = &recordFunction;
+	m_Exception = nullptr;
+	if (m_ActiveThreadCount > 1)
+	{
+		{
+			std::lock_guard<std::mutex> workLock{m_WorkMutex};
+			m_PendingWorkers = m_ActiveThreadCount - 1;
+			m_Generation++;
+		}
+		m_WorkCondition.notify_all();
+	}
+
+	record_thread(0);
+
+	if (m_ActiveThreadCount > 1)
+	{
+		std::unique_lock<std::mutex> workLock{m_WorkMutex};
+		m_DoneCondition.wait(workLock, [this]() { return m_PendingWorkers == 0; });
+	}
+	m_RecordFunction = nullptr;
+	if (m_Exception) { std::rethrow_exception(m_Exception); }
+
+	const std::vector<VkCommandBuffer>& commandBuffers = m_Frames[m_FrameIndex].commandBuffers;
+	m_RecordedBuffers.assign(commandBuffers.begin(), commandBuffers.begin() + m_ActiveThreadCount);
+	m_RecordMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - recordStart).count();
+	return m_RecordedBuffers;
+}
+
+void SEParallelRecorder::worker_loop(uint32_t threadIndex)
+{
+	uint64_t seenGeneration = 0;
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> workLock{m_WorkMutex};
+			m_WorkCondition.wait(workLock, [this, seenGeneration]() { return m_IsStopping || m_Generation != seenGeneration; });
+			if (m_IsStopping) { return; }
+			seenGeneration = m_Generation;
+			if (threadIndex >= m_ActiveThreadCount) { continue; }
+		}
+
+		record_thread(threadIndex);
+
+		bool bLastWorker = false;
+		{
+			std::lock_guard<std::mutex> workLock{m_WorkMutex};
+			bLastWorker = --m_PendingWorkers == 0;
+		}
+		if (bLastWorker) { m_DoneCondition.notify_one(); }
+	}
+}
+
+void SEParallelRecorder::record_thread(uint32_t threadIndex)
+{
+	VkCommandBuffer commandBuffer = m_Frames[m_FrameIndex].commandBuffers[threadIndex];
+	try
+	{
+		VkCommandBufferBeginInfo beginInfo{};
+		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT | VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+		beginInfo.pInheritanceInfo = &m_InheritanceInfo;
+		if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to begin recording secondary command buffer!");
+		}
+
+		(*m_RecordFunction)(threadIndex, commandBuffer);
+
+		if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to record secondary command buffer!");
+		}
+	}
+	catch (...)
+	{
+		std::lock_guard<std::mutex> workLock{m_WorkMutex};
+		if (!m_Exception) { m_Exception = std::current_exception(); }
+	}
+}
+
+} // namespace SE
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "SERendering/SEGraphicsDevice/SEGraphicsDevice.hpp"
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace SE {
+
+// Records secondary command buffers for a render pass on several threads at once. Every thread has a command pool per
+// frame in flight with one secondary command buffer, so threads never share a pool and nothing is locked while
+// recording. begin_frame resets the frame's pools wholesale once its fence has signaled, instead of resetting buffers
+// one by one. The calling thread records as thread 0, workers wait between frames
+class SEParallelRecorder {
+
+public:
+	// Workers beyond this rarely help, the draws of a frame are split too thin
+	static constexpr uint32_t MAX_THREAD_COUNT = 8;
+
+	// Called on every recording thread with its index and its secondary command buffer, which is begun to continue the
+	// render pass and ended afterwards
+	using FRecordFunction = std::function<void(uint32_t threadIndex, VkCommandBuffer commandBuffer)>;
+
+#pragma region Lifecycle
+	// threadCount 0 uses the hardware threads, up to MAX_THREAD_COUNT
+	SEParallelRecorder(SEGraphicsDevice& device, uint32_t frameCount, uint32_t threadCount = 0);
+	~SEParallelRecorder();
+	SEParallelRecorder(const SEParallelRecorder&) = delete;
+	SEParallelRecorder& operator=(const SEParallelRecorder&) = delete;
+#pragma endregion Lifecycle
+
+	uint32_t get_thread_count() const { return m_ThreadCount; }
+
+	// Resets the command pools of frameIndex. The frame that used them last must have completed
+	void begin_frame(uint32_t frameIndex);
+
+	// Runs recordFunction on the first threadCount threads, at most get_thread_count(), and returns once every buffer
+	// has ended. The buffers are in thread order, ready for vkCmdExecuteCommands inside subpass 0 of renderPass. Once
+	// per frame, rethrows the first exception a thread threw
+	const std::vector<VkCommandBuffer>& record(VkRenderPass renderPass, uint32_t threadCount, const FRecordFunction& recordFunction);
+
+	// Wall time of the last record call
+	double get_record_milliseconds() const { return m_RecordMilliseconds; }
+
+private:
+	// Command pools of one frame in flight, one per thread, each with the buffer it allocated
+	struct FFrameCommandPools {
+		std::vector<VkCommandPool> commandPools;
+		std::vector<VkCommandBuffer> commandBuffers;
+	};
+
+	void worker_loop(uint32_t threadIndex);
+	void record_thread(uint32_t threadIndex);
+
+
+	SEGraphicsDevice& m_GraphicsDevice;
+	uint32_t m_ThreadCount;
+	std::vector<FFrameCommandPools> m_Frames;
+	uint32_t m_FrameIndex = 0;
+	std::vector<VkCommandBuffer> m_RecordedBuffers;
+	double m_RecordMilliseconds = 0.0;
+
+	// Work of the current record call, read by workers after they see a new generation
+	const FRecordFunction* m_RecordFunction = nullptr;
+	VkCommandBufferInheritanceInfo m_InheritanceInfo{};
+	uint32_t m_ActiveThreadCount = 0;
+
+	std::mutex m_WorkMutex;
+	std::condition_variable m_WorkCondition;
+	std::condition_variable m_DoneCondition;
+	uint64_t m_Generation = 0;
+	uint32_t m_PendingWorkers = 0;
+	std::exception_ptr m_Exception;
+	bool m_IsStopping = false;
+	std::vector<std::thread> m_Workers;
+};
+
+} // namespace SE
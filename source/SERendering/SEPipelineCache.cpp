@@ -0,0 +1,108 @@
+
+#include "SEPipelineCache.hpp"
+#include "SECore/SEUtilities/SEFileUtilities.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+namespace SE {
+
+#pragma region Lifecycle
+SEPipelineCache::SEPipelineCache(SEGraphicsDevice& device, const std::string& filepath) : m_GraphicsDevice(device), m_Filepath(filepath)
+{
+	const std::vector<char> initialData = load_initial_data();
+
+	VkPipelineCacheCreateInfo cacheInfo{};
+	cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+	cacheInfo.initialDataSize = initialData.size();
+	cacheInfo.pInitialData = initialData.empty() ? nullptr : initialData.data();
+
+	if (vkCreatePipelineCache(m_GraphicsDevice.device(), &cacheInfo, nullptr, &m_PipelineCache) != VK_SUCCESS)
+	{
+		// Drivers may still refuse data that passed the header checks, an empty cache always works
+		cacheInfo.initialDataSize = 0;
+		cacheInfo.pInitialData = nullptr;
+		if (initialData.empty() || vkCreatePipelineCache(m_GraphicsDevice.device(), &cacheInfo, nullptr, &m_PipelineCache) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to create pipeline cache!");
+		}
+		return;
+	}
+
+	m_Stats.bWarm = !initialData.empty();
+	m_Stats.loadedBytes = initialData.size();
+}
+
+SEPipelineCache::~SEPipelineCache()
+{
+	if (!save())
+	{
+		std::cerr << "Failed to save pipeline cache to " << m_Filepath << '\n';
+	}
+	vkDestroyPipelineCache(m_GraphicsDevice.device(), m_PipelineCache, nullptr);
+}
+#pragma endregion Lifecycle
+
+bool SEPipelineCache::is_compatible(const VkPhysicalDeviceProperties& properties, const void* data, size_t size)
+{
+	VkPipelineCacheHeaderVersionOne header{};
+	if (size < sizeof(header)) { return false; }
+	memcpy(&header, data, sizeof(header));
+
+	return header.headerSize >= sizeof(header) && header.headerSize <= size
+		&& header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+		&& header.vendorID == properties.vendorID
+		&& header.deviceID == properties.deviceID
+		&& memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+}
+
+std::vector<char> SEPipelineCache::load_initial_data()
+{
+	std::ifstream fileIn(m_Filepath, std::ios::binary | std::ios::ate);
+	if (!fileIn.is_open()) { return {}; }
+
+	std::vector<char> data(static_cast<size_t>(fileIn.tellg()));
+	fileIn.seekg(0);
+	fileIn.read(data.data(), static_cast<std::streamsize>(data.size()));
+	if (!fileIn.good()) { return {}; }
+
+	// Some drivers crash on data written by another device or driver version instead of ignoring it
+	if (!is_compatible(m_GraphicsDevice.properties, data.data(), data.size()))
+	{
+		std::cerr << "Pipeline cache " << m_Filepath << " was written for another device or driver, starting cold\n";
+		return {};
+	}
+	return data;
+}
+
+bool SEPipelineCache::save()
+{
+	size_t dataSize = 0;
+	if (vkGetPipelineCacheData(m_GraphicsDevice.device(), m_PipelineCache, &dataSize, nullptr) != VK_SUCCESS) { return false; }
+	std::vector<char> data(dataSize);
+	if (vkGetPipelineCacheData(m_GraphicsDevice.device(), m_PipelineCache, &dataSize, data.data()) != VK_SUCCESS) { return false; }
+	data.resize(dataSize);
+
+	if (!write_file_atomically(m_Filepath, {{data.data(), data.size()}})) { return false; }
+
+	std::lock_guard<std::mutex> statsLock{m_StatsMutex};
+	m_Stats.savedBytes = data.size();
+	return true;
+}
+
+void SEPipelineCache::record_creation(std::chrono::steady_clock::duration duration)
+{
+	std::lock_guard<std::mutex> statsLock{m_StatsMutex};
+	m_Stats.pipelinesCreated++;
+	m_Stats.creationMilliseconds += std::chrono::duration<double, std::milli>(duration).count();
+}
+
+FPipelineCacheStats SEPipelineCache::get_stats()
+{
+	std::lock_guard<std::mutex> statsLock{m_StatsMutex};
+	return m_Stats;
+}
+
+} // namespace SE
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "SERendering/SEGraphicsDevice/SEGraphicsDevice.hpp"
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace SE {
+
+struct FPipelineCacheStats {
+	bool bWarm = false;					// Started from data saved by an earlier run on this device and driver
+	uint32_t pipelinesCreated = 0;
+	double creationMilliseconds = 0.0;	// Spent in vkCreate*Pipelines since startup
+	size_t loadedBytes = 0;
+	size_t savedBytes = 0;
+};
+
+// VkPipelineCache shared by every pipeline of the device. Startup loads the data an earlier run saved, so drivers
+// skip compiling pipelines they have seen before, and shutdown saves it again. Data is only handed to the driver
+// when its header matches this device's vendor, device and cache UUID; a driver update changes the UUID, and the
+// cache then starts cold
+class SEPipelineCache {
+
+public:
+	static constexpr const char* DEFAULT_FILEPATH = "pipeline_cache.bin";
+
+#pragma region Lifecycle
+	SEPipelineCache(SEGraphicsDevice& device, const std::string& filepath = DEFAULT_FILEPATH);
+	// Saves the cache, the device must still be alive
+	~SEPipelineCache();
+	SEPipelineCache(const SEPipelineCache&) = delete;
+	SEPipelineCache& operator=(const SEPipelineCache&) = delete;
+#pragma endregion Lifecycle
+
+	VkPipelineCache get_pipeline_cache() const { return m_PipelineCache; }
+
+	// Writes the cache to disk through a temporary file, so a crash mid-write leaves the previous data. Returns false on failure
+	bool save();
+
+	// Pipeline creation reports its duration here, from any thread
+	void record_creation(std::chrono::steady_clock::duration duration);
+	FPipelineCacheStats get_stats();
+
+	// Whether data saved by another run can be handed to this device's driver
+	static bool is_compatible(const VkPhysicalDeviceProperties& properties, const void* data, size_t size);
+
+private:
+	// Returns the validated contents of m_Filepath, empty when the file is missing or does not match the device
+	std::vector<char> load_initial_data();
+
+
+	SEGraphicsDevice& m_GraphicsDevice;
+	const std::string m_Filepath;
+	VkPipelineCache m_PipelineCache = VK_NULL_HANDLE;
+
+	std::mutex m_StatsMutex;
+	FPipelineCacheStats m_Stats{};
+};
+
+} // namespace SE
@@ -1,8 +1,10 @@
 #include "SERenderPipeline.hpp"
 
 #include "SECore/SEComponents/SEMesh.hpp"
+#include "SERendering/SEPipelineCache.hpp"
 
 #include <spirv-tools/libspirv.h>
+#include <chrono>
 #include <fstream>
 #include <stdexcept>
 #include <iostream>
@@ -17,10 +19,16 @@ SERenderPipeline::SERenderPipeline(SEGraphicsDevice& graphicsDevice, const std::
 create_graphics_pipeline(vertFilepath, fragFilepath, configInfo);
 }
 
+SERenderPipeline::SERenderPipeline(SEGraphicsDevice& graphicsDevice, const std::string& compFilepath, VkPipelineLayout pipelineLayout) : m_GraphicsDevice{ graphicsDevice }, m_BindPoint{ VK_PIPELINE_BIND_POINT_COMPUTE }
+{
+	create_compute_pipeline(compFilepath, pipelineLayout);
+}
+
 SERenderPipeline::~SERenderPipeline() 
 {
 		vkDestroyShaderModule(m_GraphicsDevice.device(), m_VertShaderModule, nullptr);
 		vkDestroyShaderModule(m_GraphicsDevice.device(), m_FragShaderModule, nullptr);
+		vkDestroyShaderModule(m_GraphicsDevice.device(), m_CompShaderModule, nullptr);
 		vkDestroyPipeline(m_GraphicsDevice.device(), m_GraphicsPipeline, nullptr);
 }
 #pragma endregion Lifecycle
@@ -102,7 +110,30 @@ void SERenderPipeline::bind_command_buffer(VkCommandBuffer commandBuffer)
 	/* Bind the graphics pipeline
 	*  the bind point options include compute, graphics, ray tracing, and ray tracing NV
 	*/
-	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_GraphicsPipeline);
+	vkCmdBindPipeline(commandBuffer, m_BindPoint, m_GraphicsPipeline);
+}
+
+void SERenderPipeline::dispatch(VkCommandBuffer commandBuffer, uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ)
+{
+	assert(is_compute() && "Cannot dispatch a graphics pipeline.");
+	vkCmdDispatch(commandBuffer, groupCountX, groupCountY, groupCountZ);
+}
+
+VkPipelineLayout SERenderPipeline::create_pipeline_layout(SEGraphicsDevice& graphicsDevice, const std::vector<VkDescriptorSetLayout>& descriptorSetLayouts, const std::vector<VkPushConstantRange>& pushConstantRanges)
+{
+	VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+	pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(descriptorSetLayouts.size());
+	pipelineLayoutInfo.pSetLayouts = descriptorSetLayouts.data();
+	pipelineLayoutInfo.pushConstantRangeCount = static_cast<uint32_t>(pushConstantRanges.size());
+	pipelineLayoutInfo.pPushConstantRanges = pushConstantRanges.data();
+
+	VkPipelineLayout pipelineLayout;
+	if (vkCreatePipelineLayout(graphicsDevice.device(), &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS)
+	{
+		throw std::runtime_error("failed to create pipeline layout!");
+	}
+	return pipelineLayout;
 }
 
 std::vector<char> SERenderPipeline::read_file(const std::string& filepath)
@@ -154,8 +185,10 @@ void SERenderPipeline::create_graphics_pipeline(const std::string& vertFilepath,
 	shaderStages[1].pSpecializationInfo = nullptr;
 
 
-	std::vector<VkVertexInputBindingDescription> bindingDescriptions = SEMesh::Vertex::get_binding_descriptions();
-	std::vector<VkVertexInputAttributeDescription> attributeDescriptions =  SEMesh::Vertex::get_attribute_descriptions();
+	std::vector<VkVertexInputBindingDescription> bindingDescriptions = SEMesh::get_binding_descriptions(configInfo.vertexFormat);
+	std::vector<VkVertexInputAttributeDescription> attributeDescriptions = SEMesh::get_attribute_descriptions(configInfo.vertexFormat);
+	bindingDescriptions.insert(bindingDescriptions.end(), configInfo.instanceBindingDescriptions.begin(), configInfo.instanceBindingDescriptions.end());
+	attributeDescriptions.insert(attributeDescriptions.end(), configInfo.instanceAttributeDescriptions.begin(), configInfo.instanceAttributeDescriptions.end());
 	VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
 	vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
 	vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
@@ -184,10 +217,40 @@ void SERenderPipeline::create_graphics_pipeline(const std::string& vertFilepath,
 	pipelineInfo.basePipelineIndex = -1;  // Optional
 	pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;  // Optional
 
-	if (vkCreateGraphicsPipelines(m_GraphicsDevice.device(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_GraphicsPipeline) != VK_SUCCESS)
+	// Timed for the cold and warm startup comparison, cache hits skip the driver's shader compilation
+	SEPipelineCache& pipelineCache = m_GraphicsDevice.get_pipeline_cache();
+	const std::chrono::steady_clock::time_point creationStart = std::chrono::steady_clock::now();
+	if (vkCreateGraphicsPipelines(m_GraphicsDevice.device(), pipelineCache.get_pipeline_cache(), 1, &pipelineInfo, nullptr, &m_GraphicsPipeline) != VK_SUCCESS)
 	{
 		throw std::runtime_error("Failed to create graphics pipeline.");
 	}
+	pipelineCache.record_creation(std::chrono::steady_clock::now() - creationStart);
+}
+
+void SERenderPipeline::create_compute_pipeline(const std::string& compFilepath, VkPipelineLayout pipelineLayout)
+{
+	assert(pipelineLayout != VK_NULL_HANDLE && "Cannot create compute pipeline, no pipelineLayout");
+
+	std::vector<char> compCode = read_file(compFilepath);
+	create_shader_module(compCode, &m_CompShaderModule);
+
+	VkComputePipelineCreateInfo pipelineInfo{};
+	pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+	pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+	pipelineInfo.stage.module = m_CompShaderModule;
+	pipelineInfo.stage.pName = "main";
+	pipelineInfo.layout = pipelineLayout;
+	pipelineInfo.basePipelineIndex = -1;
+	pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+
+	SEPipelineCache& pipelineCache = m_GraphicsDevice.get_pipeline_cache();
+	const std::chrono::steady_clock::time_point creationStart = std::chrono::steady_clock::now();
+	if (vkCreateComputePipelines(m_GraphicsDevice.device(), pipelineCache.get_pipeline_cache(), 1, &pipelineInfo, nullptr, &m_GraphicsPipeline) != VK_SUCCESS)
+	{
+		throw std::runtime_error("Failed to create compute pipeline.");
+	}
+	pipelineCache.record_creation(std::chrono::steady_clock::now() - creationStart);
 }
 
 void SERenderPipeline::create_shader_module(const std::vector<char>& shaderCode, VkShaderModule* shaderModule)
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "SERendering/SEGraphicsDevice/SEGraphicsDEvice.hpp"
+#include "SECore/SEComponents/SEMesh.hpp"
 #include <string>
 #include <vector>
 
@@ -22,6 +23,10 @@ struct PipelineConfigInfo {
 	VkPipelineLayout pipelineLayout = nullptr;
 	VkRenderPass renderPass = nullptr;
 	uint32_t subpass = 0;
+	EVertexFormat vertexFormat = EVertexFormat::Full;
+	// Per-instance vertex input, appended to the layout of vertexFormat
+	std::vector<VkVertexInputBindingDescription> instanceBindingDescriptions;
+	std::vector<VkVertexInputAttributeDescription> instanceAttributeDescriptions;
 };
 
 class SERenderPipeline {
@@ -29,13 +34,24 @@ class SERenderPipeline {
 public:
 #pragma region Lifecycle
 	SERenderPipeline(SEGraphicsDevice& graphicsDevice, const std::string& vertFilepath, const std::string& fragFilepath, const PipelineConfigInfo& configInfo);
+	// Compute pipeline from a single compute shader
+	SERenderPipeline(SEGraphicsDevice& graphicsDevice, const std::string& compFilepath, VkPipelineLayout pipelineLayout);
 	~SERenderPipeline();
 	SERenderPipeline(const SERenderPipeline&) = delete;
 	SERenderPipeline& operator=(const SERenderPipeline&) = delete;
 #pragma endregion Lifecycle
 
 	static void default_pipeline_config_info(PipelineConfigInfo& configInfo);
+	// Layout for the descriptor sets and push constants of a pipeline, the caller destroys it
+	static VkPipelineLayout create_pipeline_layout(SEGraphicsDevice& graphicsDevice, const std::vector<VkDescriptorSetLayout>& descriptorSetLayouts, const std::vector<VkPushConstantRange>& pushConstantRanges = {});
+	// Binds to the graphics or compute bind point, whichever the pipeline was built for
 	void bind_command_buffer(VkCommandBuffer commandBuffer);
+	bool is_compute() const { return m_BindPoint == VK_PIPELINE_BIND_POINT_COMPUTE; }
+
+	// Workgroups needed to cover itemCount items with groupSize invocations each
+	static uint32_t get_group_count(uint32_t itemCount, uint32_t groupSize) { return (itemCount + groupSize - 1) / groupSize; }
+	// Compute pipelines only, the pipeline must be bound
+	void dispatch(VkCommandBuffer commandBuffer, uint32_t groupCountX, uint32_t groupCountY = 1, uint32_t groupCountZ = 1);
 
 #ifdef NDEBUG
 	const bool ENABLE_SPIRV_VALIDATION = true;
@@ -47,15 +63,18 @@ private:
 	static std::vector<char> read_file(const std::string& filepath);
 
 	void create_graphics_pipeline(const std::string& vertFilepath, const std::string& fragFilepath, const PipelineConfigInfo& configInfo);
+	void create_compute_pipeline(const std::string& compFilepath, VkPipelineLayout pipelineLayout);
 
 	void create_shader_module(const std::vector<char>& shaderCode, VkShaderModule* shaderModule);
 
 	bool validate_spirv_code(const std::vector<char>& shaderCode);
 
 	SEGraphicsDevice& m_GraphicsDevice;
-	VkPipeline m_GraphicsPipeline;
-	VkShaderModule m_VertShaderModule;
-	VkShaderModule m_FragShaderModule;
+	VkPipeline m_GraphicsPipeline = VK_NULL_HANDLE;		// The compute pipeline for compute shaders
+	VkPipelineBindPoint m_BindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+	VkShaderModule m_VertShaderModule = VK_NULL_HANDLE;
+	VkShaderModule m_FragShaderModule = VK_NULL_HANDLE;
+	VkShaderModule m_CompShaderModule = VK_NULL_HANDLE;
 };
 
 }	// end SE namespace
\ No newline at end of file
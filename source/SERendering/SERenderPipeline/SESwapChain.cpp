@@ -52,7 +52,7 @@ namespace SE {
 		{
 			vkDestroyImageView(m_GraphicsDevice.device(), m_DepthImageViews[i], nullptr);
 			vkDestroyImage(m_GraphicsDevice.device(), m_DepthImages[i], nullptr);
-			vkFreeMemory(m_GraphicsDevice.device(), m_DepthImageMemorys[i], nullptr);
+			m_GraphicsDevice.free_memory(m_DepthImageAllocations[i]);
 		}
 
 		for (auto framebuffer : m_SwapChainFramebuffers) 
@@ -104,6 +104,9 @@ namespace SE {
 		submitInfo.signalSemaphoreCount = 1;
 		submitInfo.pSignalSemaphores = signalSemaphores;
 
+		// Asset streaming threads submit uploads to the same queue
+		std::lock_guard<std::mutex> queueLock{m_GraphicsDevice.get_queue_mutex()};
+
 		vkResetFences(m_GraphicsDevice.device(), 1, &m_InFlightFences[m_CurrentFrame]);
 		if (vkQueueSubmit(m_GraphicsDevice.graphicsQueue(), 1, &submitInfo, m_InFlightFences[m_CurrentFrame]) != VK_SUCCESS) 
 		{
@@ -306,7 +309,7 @@ namespace SE {
 		VkExtent2D swapChainExtent = get_spawchain_extent();
 
 		m_DepthImages.resize(get_image_count());
-		m_DepthImageMemorys.resize(get_image_count());
+		m_DepthImageAllocations.resize(get_image_count());
 		m_DepthImageViews.resize(get_image_count());
 
 		for (int i = 0; i < m_DepthImages.size(); i++) 
@@ -327,7 +330,7 @@ namespace SE {
 			imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 			imageInfo.flags = 0;
 
-			m_GraphicsDevice.create_image_with_info(imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_DepthImages[i], m_DepthImageMemorys[i]);
+			m_GraphicsDevice.create_image_with_info(imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, EMemoryCategory::Depth, m_DepthImages[i], m_DepthImageAllocations[i]);
 
 			VkImageViewCreateInfo viewInfo{};
 			viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
@@ -59,7 +59,7 @@ namespace SE {
 		VkRenderPass m_RenderPass;
 
 		std::vector<VkImage> m_DepthImages;
-		std::vector<VkDeviceMemory> m_DepthImageMemorys;
+		std::vector<FMemoryAllocation> m_DepthImageAllocations;
 		std::vector<VkImageView> m_DepthImageViews;
 		std::vector<VkImage> m_SwapChainImages;
 		std::vector<VkImageView> m_SwapChainImageViews;
@@ -0,0 +1,150 @@
+#include "SERendering/SERenderSystems/SEGpuCulling.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace SE {
+
+	static constexpr uint32_t INITIAL_OBJECT_CAPACITY = 1024;
+	static constexpr uint32_t INITIAL_RUN_CAPACITY = 64;
+
+#pragma region Lifecycle
+	SEGpuCulling::SEGpuCulling(SEGraphicsDevice& graphicsDevice, SEFrameAllocator& frameAllocator, SEGpuScene& gpuScene)
+		: m_GraphicsDevice(graphicsDevice), m_FrameAllocator(frameAllocator), m_GpuScene(gpuScene)
+	{
+		create_descriptor_set();
+
+		m_PipelineLayout = SERenderPipeline::create_pipeline_layout(m_GraphicsDevice, {m_DescriptorSetLayout->get_descriptor_set_layout()});
+		m_Pipeline = std::make_unique<SERenderPipeline>(m_GraphicsDevice, "shaders/gpu_cull.comp.spv", m_PipelineLayout);
+
+		create_output_buffers(INITIAL_OBJECT_CAPACITY, INITIAL_RUN_CAPACITY);
+		write_descriptor_set();
+	}
+
+	SEGpuCulling::~SEGpuCulling()
+	{
+		m_Pipeline = nullptr;
+		vkDestroyPipelineLayout(m_GraphicsDevice.device(), m_PipelineLayout, nullptr);
+	}
+#pragma endregion Lifecycle
+
+	void SEGpuCulling::create_descriptor_set()
+	{
+		// Constants move each frame through a dynamic offset into the frame allocator, the scene and outputs are fixed
+		// buffers
+		m_DescriptorSetLayout = SEDescriptorSetLayout::Builder(m_GraphicsDevice)
+			.add_binding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, VK_SHADER_STAGE_COMPUTE_BIT)
+			.add_binding(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+			.add_binding(2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+			.add_binding(3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+			.add_binding(4, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+			.add_binding(5, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+			.add_binding(6, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+			.add_binding(7, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+			.add_binding(8, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+			.build();
+
+		m_DescriptorPool = SEDescriptorPool::Builder(m_GraphicsDevice)
+			.set_max_sets(1)
+			.add_pool_size(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1)
+			.add_pool_size(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 8)
+			.build();
+	}
+
+	void SEGpuCulling::create_output_buffers(uint32_t objectCapacity, uint32_t runCapacity)
+	{
+		// The set may be bound by frames in flight, which also read the old buffers
+		if (m_DescriptorSet != VK_NULL_HANDLE) { m_GraphicsDevice.wait_idle(); }
+
+		m_CommandBuffer = std::make_unique<SEBuffer>(m_GraphicsDevice, sizeof(VkDrawIndexedIndirectCommand), objectCapacity, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, EMemoryCategory::Indirect);
+		m_InstanceBuffer = std::make_unique<SEBuffer>(m_GraphicsDevice, INSTANCE_STRIDE, objectCapacity, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, EMemoryCategory::Indirect);
+		m_CountBuffer = std::make_unique<SEBuffer>(m_GraphicsDevice, sizeof(uint32_t), runCapacity, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, EMemoryCategory::Indirect);
+		m_ObjectCapacity = objectCapacity;
+		m_RunCapacity = runCapacity;
+	}
+
+	void SEGpuCulling::write_descriptor_set()
+	{
+		VkDescriptorBufferInfo constantsInfo = m_FrameAllocator.get_descriptor_info(sizeof(FGpuCullConstants));
+		VkDescriptorBufferInfo objectInfo = m_GpuScene.get_object_buffer().get_descriptor_info();
+		VkDescriptorBufferInfo meshInfo = m_GpuScene.get_mesh_buffer().get_descriptor_info();
+		VkDescriptorBufferInfo runInfo = m_GpuScene.get_run_buffer().get_descriptor_info();
+		VkDescriptorBufferInfo lodInfo = m_GpuScene.get_lod_buffer().get_descriptor_info();
+		VkDescriptorBufferInfo countInfo = m_CountBuffer->get_descriptor_info();
+		VkDescriptorBufferInfo commandInfo = m_CommandBuffer->get_descriptor_info();
+		VkDescriptorBufferInfo instanceInfo = m_InstanceBuffer->get_descriptor_info();
+		VkDescriptorBufferInfo extentInfo = m_GpuScene.get_extent_buffer().get_descriptor_info();
+
+		SEDescriptorWriter descriptorWriter{*m_DescriptorSetLayout, *m_DescriptorPool};
+		descriptorWriter.write_buffer(0, &constantsInfo)
+			.write_buffer(1, &objectInfo)
+			.write_buffer(2, &meshInfo)
+			.write_buffer(3, &runInfo)
+			.write_buffer(4, &lodInfo)
+			.write_buffer(5, &countInfo)
+			.write_buffer(6, &commandInfo)
+			.write_buffer(7, &instanceInfo)
+			.write_buffer(8, &extentInfo);
+		m_SceneBufferGeneration = m_GpuScene.get_buffer_generation();
+		if (m_DescriptorSet == VK_NULL_HANDLE)
+		{
+			if (!descriptorWriter.build(m_DescriptorSet))
+			{
+				throw std::runtime_error("failed to allocate GPU culling descriptor set!");
+			}
+			return;
+		}
+		descriptorWriter.overwrite(m_DescriptorSet);
+	}
+
+	bool SEGpuCulling::record_dispatch(VkCommandBuffer commandBuffer, const FGpuCullConstants& cullConstants)
+	{
+		FFrameAllocation constantsAllocation{};
+		if (!m_FrameAllocator.allocate_uniform(sizeof(FGpuCullConstants), constantsAllocation)) { return false; }
+		memcpy(constantsAllocation.data, &cullConstants, sizeof(FGpuCullConstants));
+		// Grows the scene buffers, which waits for the frames in flight when it recreates them
+		if (!m_GpuScene.stage_uploads()) { return false; }
+
+		const uint32_t objectCount = m_GpuScene.get_object_count();
+		const uint32_t runCount = static_cast<uint32_t>(m_GpuScene.get_runs().size());
+		const bool bGrowOutputs = objectCount > m_ObjectCapacity || runCount > m_RunCapacity;
+		if (bGrowOutputs) { create_output_buffers(std::max(objectCount, m_ObjectCapacity * 2), std::max(runCount, m_RunCapacity * 2)); }
+		if (bGrowOutputs || m_SceneBufferGeneration != m_GpuScene.get_buffer_generation())
+		{
+			// Nothing in flight binds the set, recreating buffers waited for the device to go idle
+			write_descriptor_set();
+		}
+
+		// The previous frame's dispatch read the scene and its draws read the outputs. Overwriting after a read only
+		// needs the reads to finish first
+		VkMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+		m_GpuScene.record_uploads(commandBuffer);
+		if (runCount > 0)
+		{
+			vkCmdFillBuffer(commandBuffer, m_CountBuffer->get_buffer(), 0, static_cast<VkDeviceSize>(runCount) * sizeof(uint32_t), 0);
+		}
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+		if (objectCount > 0)
+		{
+			const uint32_t constantsOffset = static_cast<uint32_t>(constantsAllocation.offset);
+			m_Pipeline->bind_command_buffer(commandBuffer);
+			vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_PipelineLayout, 0, 1, &m_DescriptorSet, 1, &constantsOffset);
+			m_Pipeline->dispatch(commandBuffer, SERenderPipeline::get_group_count(objectCount, GROUP_SIZE));
+		}
+
+		// Commands and counts feed the indirect draws, instance matrices the vertex input, texture extents the host
+		// once the frame's fence signals
+		barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_HOST_READ_BIT;
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_HOST_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+		return true;
+	}
+
+} // namespace SE
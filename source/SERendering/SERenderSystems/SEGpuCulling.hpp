@@ -0,0 +1,90 @@
+#pragma once
+
+#include "SERendering/SEBuffer.hpp"
+#include "SERendering/SEDescriptorSets/SEDescriptors.hpp"
+#include "SERendering/SEFrameAllocator.hpp"
+#include "SERendering/SEGraphicsDevice/SEGraphicsDevice.hpp"
+#include "SERendering/SERenderPipeline/SERenderPipeline.hpp"
+#include "SERendering/SERenderSystems/SEGpuScene.hpp"
+#include "SECore/SEUtilities/SEFrustum.hpp"
+
+#include <memory>
+
+namespace SE {
+
+	// Uniforms of gpu_cull.comp with the std140 layout, written to the frame allocator for each dispatch
+	struct FGpuCullConstants {
+		glm::vec4 frustumPlanes[FFrustum::PlaneCount];
+		glm::vec4 viewDepthRow{0.0f};	// Row of the view matrix that gives view space depth
+		float projectionScale = 0.0f;	// |projection[1][1]|, normalized device units per view space unit at depth 1
+		float viewportHeight = 0.0f;
+		float maxScreenError = 0.0f;	// FLodSettings
+		float hysteresis = 0.0f;
+		uint32_t objectCount = 0;
+		uint32_t extentBase = 0;		// SEGpuScene::get_extent_base of the frame
+		uint32_t bPerspective = 0;		// Orthographic projections do not divide by depth
+		uint32_t padding = 0;
+	};
+
+	static_assert(sizeof(FGpuCullConstants) == 144, "FGpuCullConstants must match the std140 layout of gpu_cull.comp");
+
+	// Culling and level of detail selection on the GPU. A compute shader tests every object of an SEGpuScene, picks its
+	// level of detail and appends a draw command and the instance matrices of the visible ones to their run's slots,
+	// counting draws per run, so that one indirect count draw per run consumes the result without a CPU readback. It
+	// also keeps the largest screen extent of each texture for streaming
+	class SEGpuCulling {
+
+	public:
+		static constexpr uint32_t GROUP_SIZE = 64;				// local_size_x of gpu_cull.comp
+		static constexpr VkDeviceSize INSTANCE_STRIDE = 128;	// FInstanceData, two matrices per object
+
+#pragma region Lifecycle
+		SEGpuCulling(SEGraphicsDevice& graphicsDevice, SEFrameAllocator& frameAllocator, SEGpuScene& gpuScene);
+		~SEGpuCulling();
+
+		SEGpuCulling(const SEGpuCulling&) = delete;
+		SEGpuCulling& operator=(const SEGpuCulling&) = delete;
+#pragma endregion Lifecycle
+
+		// Stages the scene's changes and the constants in the frame allocator, which must have begun the frame being
+		// recorded, then records the uploads, the reset of the draw counts, the dispatch and the barriers that hand the
+		// output to indirect draws, vertex input and the host. Outside a render pass, after SEGpuScene::begin_frame.
+		// Returns false without recording a dispatch when the frame allocator is full
+		bool record_dispatch(VkCommandBuffer commandBuffer, const FGpuCullConstants& cullConstants);
+
+		// VkDrawIndexedIndirectCommand per command slot
+		VkBuffer get_command_buffer() const { return m_CommandBuffer->get_buffer(); }
+		// Draw count per run
+		VkBuffer get_count_buffer() const { return m_CountBuffer->get_buffer(); }
+		// FInstanceData per command slot, the commands' firstInstance points at their own slot
+		VkBuffer get_instance_buffer() const { return m_InstanceBuffer->get_buffer(); }
+
+	private:
+		void create_descriptor_set();
+		// Recreates the output buffers for at least objectCapacity slots and runCapacity runs
+		void create_output_buffers(uint32_t objectCapacity, uint32_t runCapacity);
+		// Points the descriptor set at the current scene and output buffers
+		void write_descriptor_set();
+
+
+		SEGraphicsDevice& m_GraphicsDevice;
+		SEFrameAllocator& m_FrameAllocator;
+		SEGpuScene& m_GpuScene;
+
+		std::unique_ptr<SEDescriptorSetLayout> m_DescriptorSetLayout;
+		std::unique_ptr<SEDescriptorPool> m_DescriptorPool;
+		VkDescriptorSet m_DescriptorSet = VK_NULL_HANDLE;
+		VkPipelineLayout m_PipelineLayout = VK_NULL_HANDLE;
+		std::unique_ptr<SERenderPipeline> m_Pipeline;
+
+		// Device local, written by the shader and read by the draws of the same frame. Frames in flight share them,
+		// record_dispatch waits for the previous frame's draws before overwriting
+		std::unique_ptr<SEBuffer> m_CommandBuffer;
+		std::unique_ptr<SEBuffer> m_InstanceBuffer;
+		std::unique_ptr<SEBuffer> m_CountBuffer;
+		uint32_t m_ObjectCapacity = 0;
+		uint32_t m_RunCapacity = 0;
+		uint32_t m_SceneBufferGeneration = 0;	// Of the scene buffers the descriptor set points at
+	};
+
+} // end SE namespace
@@ -0,0 +1,369 @@
+#include "SERendering/SERenderSystems/SEGpuScene.hpp"
+#include "SERendering/SERenderPipeline/SESwapChain.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <tuple>
+
+namespace SE {
+
+	static constexpr uint32_t INITIAL_OBJECT_CAPACITY = 1024;
+	static constexpr uint32_t INITIAL_MESH_CAPACITY = 64;
+	static constexpr uint32_t INITIAL_RUN_CAPACITY = 64;
+	static constexpr uint32_t INITIAL_TEXTURE_CAPACITY = 64;
+	// Changed objects take at most this fraction of a frame's allocator, the rest go out with the frames after
+	static constexpr VkDeviceSize OBJECT_UPLOAD_DIVISOR = 4;
+
+	static constexpr VkBufferUsageFlags SCENE_BUFFER_USAGE = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+
+	// Per run on the GPU, SceneRun in gpu_cull.comp
+	struct FGpuSceneRunRecord {
+		uint32_t firstDraw;
+		uint32_t maxDrawCount;
+	};
+
+#pragma region Lifecycle
+	SEGpuScene::SEGpuScene(SEGraphicsDevice& graphicsDevice, SEFrameAllocator& frameAllocator)
+		: m_GraphicsDevice(graphicsDevice), m_FrameAllocator(frameAllocator)
+	{
+		grow_buffer(m_ObjectBuffer, sizeof(FGpuSceneObject), INITIAL_OBJECT_CAPACITY);
+		grow_buffer(m_LodBuffer, sizeof(uint32_t), INITIAL_OBJECT_CAPACITY);
+		grow_buffer(m_MeshBuffer, sizeof(FGpuSceneMesh), INITIAL_MESH_CAPACITY);
+		grow_buffer(m_RunBuffer, sizeof(FGpuSceneRunRecord), INITIAL_RUN_CAPACITY);
+		m_ObjectCapacity = INITIAL_OBJECT_CAPACITY;
+		m_MeshCapacity = INITIAL_MESH_CAPACITY;
+		m_RunCapacity = INITIAL_RUN_CAPACITY;
+		create_extent_buffer(INITIAL_TEXTURE_CAPACITY);
+	}
+#pragma endregion Lifecycle
+
+	void SEGpuScene::set_object(SEGameObject::id_type id, const std::shared_ptr<SEMeshHandle>& mesh, const std::shared_ptr<SETextureHandle>& texture, const glm::mat4& transformMatrix, const glm::mat3& normalMatrix)
+	{
+		if (mesh == nullptr)
+		{
+			remove_object(id);
+			return;
+		}
+
+		const uint32_t meshIndex = get_mesh_index(mesh);
+		const uint32_t textureIndex = get_texture_index(texture);
+		auto [objectSlot, bAdded] = m_ObjectSlots.try_emplace(id, get_object_count());
+		const uint32_t objectIndex = objectSlot->second;
+		if (bAdded)
+		{
+			m_ObjectRecords.push_back(FGpuSceneObject{});
+			m_ObjectIds.push_back(id);
+			m_ObjectDirty.push_back(0);
+		}
+
+		// A new mesh or texture moves the object to another run
+		FGpuSceneObject& record = m_ObjectRecords[objectIndex];
+		if (bAdded || record.meshIndex != meshIndex || record.textureIndex != textureIndex)
+		{
+			if (!bAdded) { remove_from_run(record); }
+			record.runIndex = add_to_run(meshIndex, textureIndex);
+		}
+
+		record.transformMatrix = transformMatrix;
+		record.normalMatrix[0] = glm::vec4{normalMatrix[0], 0.0f};
+		record.normalMatrix[1] = glm::vec4{normalMatrix[1], 0.0f};
+		record.normalMatrix[2] = glm::vec4{normalMatrix[2], 0.0f};
+		record.meshIndex = meshIndex;
+		record.textureIndex = textureIndex;
+		record.flags = OBJECT_VALID;
+		mark_object_dirty(objectIndex);
+	}
+
+	void SEGpuScene::remove_object(SEGameObject::id_type id)
+	{
+		auto objectSlot = m_ObjectSlots.find(id);
+		if (objectSlot == m_ObjectSlots.end()) { return; }
+		const uint32_t objectIndex = objectSlot->second;
+		remove_from_run(m_ObjectRecords[objectIndex]);
+		m_ObjectSlots.erase(objectSlot);
+
+		// The last object fills the hole, its old slot drops out of the dispatch
+		const uint32_t lastIndex = get_object_count() - 1;
+		if (objectIndex != lastIndex)
+		{
+			m_ObjectRecords[objectIndex] = m_ObjectRecords[lastIndex];
+			m_ObjectIds[objectIndex] = m_ObjectIds[lastIndex];
+			m_ObjectSlots[m_ObjectIds[objectIndex]] = objectIndex;
+			mark_object_dirty(objectIndex);
+		}
+		m_ObjectRecords.pop_back();
+		m_ObjectIds.pop_back();
+		m_ObjectDirty.pop_back();
+	}
+
+	uint32_t SEGpuScene::get_mesh_index(const std::shared_ptr<SEMeshHandle>& mesh)
+	{
+		auto [meshIndex, bAdded] = m_MeshIndices.try_emplace(mesh.get(), static_cast<uint32_t>(m_Meshes.size()));
+		if (bAdded)
+		{
+			// The record stays zeroed until begin_frame finds the mesh resident
+			m_Meshes.push_back(FSceneMesh{mesh});
+			m_MeshRecords.push_back(FGpuSceneMesh{});
+			m_MeshDirty.push_back(0);
+		}
+		return meshIndex->second;
+	}
+
+	uint32_t SEGpuScene::get_texture_index(const std::shared_ptr<SETextureHandle>& texture)
+	{
+		if (texture == nullptr) { return 0; }
+
+		auto [textureIndex, bAdded] = m_TextureIndices.try_emplace(texture.get(), static_cast<uint32_t>(m_Textures.size()));
+		if (bAdded) { m_Textures.push_back(texture); }
+		return textureIndex->second;
+	}
+
+	uint32_t SEGpuScene::add_to_run(uint32_t meshIndex, uint32_t textureIndex)
+	{
+		const uint32_t maxRunDraws = std::max(m_GraphicsDevice.properties.limits.maxDrawIndirectCount, 1u);
+		const uint64_t runKey = (static_cast<uint64_t>(meshIndex) << 32) | textureIndex;
+		auto [openRun, bNewRun] = m_OpenRuns.try_emplace(runKey, static_cast<uint32_t>(m_Runs.size()));
+		if (bNewRun || m_Runs[openRun->second].objectCount == maxRunDraws)
+		{
+			openRun->second = static_cast<uint32_t>(m_Runs.size());
+			m_Runs.push_back(FGpuSceneRun{meshIndex, textureIndex, 0, 0});
+		}
+
+		m_Runs[openRun->second].objectCount++;
+		m_Meshes[meshIndex].objectCount++;
+		m_bRunsDirty = true;
+		return openRun->second;
+	}
+
+	void SEGpuScene::remove_from_run(const FGpuSceneObject& record)
+	{
+		// Emptied runs stay, they draw nothing
+		m_Runs[record.runIndex].objectCount--;
+		m_Meshes[record.meshIndex].objectCount--;
+		m_bRunsDirty = true;
+	}
+
+	void SEGpuScene::mark_object_dirty(uint32_t objectIndex)
+	{
+		if (m_ObjectDirty[objectIndex]) { return; }
+		m_ObjectDirty[objectIndex] = 1;
+		m_DirtyObjects.push_back(objectIndex);
+	}
+
+	void SEGpuScene::begin_frame(const FFrameInfo& frameInfo)
+	{
+		// The fence of this frame index was waited on, so its dispatch finished writing the region
+		uint32_t* screenExtents = static_cast<uint32_t*>(m_ExtentBuffer->get_mapped_memory()) + get_extent_base(frameInfo.frameIndex);
+		for (uint32_t textureIndex = 1; textureIndex < static_cast<uint32_t>(m_Textures.size()); textureIndex++)
+		{
+			if (screenExtents[textureIndex] == 0) { continue; }
+			float screenExtent = 0.0f;
+			memcpy(&screenExtent, &screenExtents[textureIndex], sizeof(screenExtent));
+			m_Textures[textureIndex]->request_screen_extent(screenExtent, frameInfo.frameNumber);
+		}
+		memset(screenExtents, 0, static_cast<size_t>(m_TextureCapacity) * sizeof(uint32_t));
+
+		m_CpuDrawnObjectCount = 0;
+		for (uint32_t meshIndex = 0; meshIndex < static_cast<uint32_t>(m_Meshes.size()); meshIndex++)
+		{
+			FSceneMesh& sceneMesh = m_Meshes[meshIndex];
+			if (sceneMesh.objectCount == 0) { continue; }
+
+			// Marked even while not resident or culled, as the CPU path does for every object
+			sceneMesh.handle->mark_used(frameInfo.frameNumber);
+			SEMesh* mesh = sceneMesh.handle->get_mesh();
+			if (mesh != nullptr && !mesh->is_upload_submitted()) { mesh = nullptr; }
+
+			sceneMesh.bCpuDrawn = mesh != nullptr && !mesh->has_index_buffer();
+			sceneMesh.drawnMesh = sceneMesh.bCpuDrawn ? nullptr : mesh;
+			if (sceneMesh.bCpuDrawn) { m_CpuDrawnObjectCount += sceneMesh.objectCount; }
+
+			// A reloaded mesh can sit at other offsets of the geometry pool, the record is compared rather than the pointer
+			FGpuSceneMesh record{};
+			if (sceneMesh.drawnMesh != nullptr)
+			{
+				const SEMesh& drawnMesh = *sceneMesh.drawnMesh;
+				record.dequantizationMatrix = drawnMesh.get_dequantization_matrix();
+				record.boundingSphere = drawnMesh.get_bounding_sphere();
+				record.lodCount = std::min(drawnMesh.get_lod_count(), SEMesh::MAX_LOD_COUNT);
+				for (uint32_t lodIndex = 0; lodIndex < record.lodCount; lodIndex++)
+				{
+					const VkDrawIndexedIndirectCommand command = drawnMesh.get_draw_command(lodIndex, 1, 0);
+					record.lods[lodIndex] = FGpuSceneLod{command.firstIndex, command.indexCount, drawnMesh.get_lod(lodIndex).error, 0};
+					record.vertexOffset = command.vertexOffset;
+				}
+			}
+			if (memcmp(&record, &m_MeshRecords[meshIndex], sizeof(record)) != 0)
+			{
+				m_MeshRecords[meshIndex] = record;
+				m_MeshDirty[meshIndex] = 1;
+			}
+		}
+	}
+
+	void SEGpuScene::reserve_buffers()
+	{
+		const uint32_t objectCount = get_object_count();
+		const uint32_t meshCount = static_cast<uint32_t>(m_Meshes.size());
+		const uint32_t runCount = static_cast<uint32_t>(m_Runs.size());
+		const uint32_t textureCount = static_cast<uint32_t>(m_Textures.size());
+		if (objectCount <= m_ObjectCapacity && meshCount <= m_MeshCapacity && runCount <= m_RunCapacity && textureCount <= m_TextureCapacity) { return; }
+
+		// Frames in flight read the old buffers
+		m_GraphicsDevice.wait_idle();
+		if (objectCount > m_ObjectCapacity)
+		{
+			m_ObjectCapacity = std::max(objectCount, m_ObjectCapacity * 2);
+			grow_buffer(m_ObjectBuffer, sizeof(FGpuSceneObject), m_ObjectCapacity);
+			grow_buffer(m_LodBuffer, sizeof(uint32_t), m_ObjectCapacity);
+		}
+		if (meshCount > m_MeshCapacity)
+		{
+			m_MeshCapacity = std::max(meshCount, m_MeshCapacity * 2);
+			grow_buffer(m_MeshBuffer, sizeof(FGpuSceneMesh), m_MeshCapacity);
+		}
+		if (runCount > m_RunCapacity)
+		{
+			m_RunCapacity = std::max(runCount, m_RunCapacity * 2);
+			grow_buffer(m_RunBuffer, sizeof(FGpuSceneRunRecord), m_RunCapacity);
+		}
+		// Extents of the frames before are lost, the next dispatches write them again
+		if (textureCount > m_TextureCapacity) { create_extent_buffer(std::max(textureCount, m_TextureCapacity * 2)); }
+	}
+
+	void SEGpuScene::grow_buffer(std::unique_ptr<SEBuffer>& buffer, VkDeviceSize elementSize, uint32_t capacity)
+	{
+		std::unique_ptr<SEBuffer> grownBuffer = std::make_unique<SEBuffer>(m_GraphicsDevice, elementSize, capacity, SCENE_BUFFER_USAGE, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, EMemoryCategory::Indirect);
+		const VkDeviceSize copyBytes = buffer != nullptr ? buffer->get_bufferSize() : 0;
+
+		// Zeroed objects and meshes are skipped by the shader until their record is uploaded
+		VkCommandBuffer commandBuffer = m_GraphicsDevice.begin_single_time_commands();
+		vkCmdFillBuffer(commandBuffer, grownBuffer->get_buffer(), copyBytes, VK_WHOLE_SIZE, 0);
+		if (copyBytes > 0)
+		{
+			VkBufferCopy copyRegion{0, 0, copyBytes};
+			vkCmdCopyBuffer(commandBuffer, buffer->get_buffer(), grownBuffer->get_buffer(), 1, &copyRegion);
+		}
+		m_GraphicsDevice.end_single_time_commands(commandBuffer);
+
+		buffer = std::move(grownBuffer);
+		m_BufferGeneration++;
+	}
+
+	void SEGpuScene::create_extent_buffer(uint32_t textureCapacity)
+	{
+		m_ExtentBuffer = std::make_unique<SEBuffer>(m_GraphicsDevice, sizeof(uint32_t), textureCapacity * SESwapChain::MAX_FRAMES_IN_FLIGHT, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, EMemoryCategory::Indirect);
+		if (m_ExtentBuffer->map() != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to map GPU scene texture extents!");
+		}
+		memset(m_ExtentBuffer->get_mapped_memory(), 0, static_cast<size_t>(m_ExtentBuffer->get_bufferSize()));
+		m_TextureCapacity = textureCapacity;
+		m_BufferGeneration++;
+	}
+
+	bool SEGpuScene::stage_uploads()
+	{
+		reserve_buffers();
+		m_StagedObjects.clear();
+		m_ObjectCopies.clear();
+		m_MeshCopies.clear();
+		m_RunCopy = VkBufferCopy{};
+
+		// Runs and meshes go out whole, the shader must never see a run layout the draws do not share
+		const uint32_t runCount = m_bRunsDirty ? static_cast<uint32_t>(m_Runs.size()) : 0;
+		const VkDeviceSize meshBytes = static_cast<VkDeviceSize>(std::count(m_MeshDirty.begin(), m_MeshDirty.end(), 1)) * sizeof(FGpuSceneMesh);
+		const VkDeviceSize runBytes = static_cast<VkDeviceSize>(runCount) * sizeof(FGpuSceneRunRecord);
+		const VkDeviceSize freeBytes = m_FrameAllocator.get_frame_free_bytes();
+		const VkDeviceSize requiredBytes = meshBytes + runBytes + alignof(FGpuSceneMesh);
+		if (requiredBytes > freeBytes) { return false; }
+
+		// Changed objects, oldest first, up to the budget. Entries of slots uploaded or removed since are dropped
+		const VkDeviceSize objectBudget = std::min(m_FrameAllocator.get_frame_capacity() / OBJECT_UPLOAD_DIVISOR, freeBytes - requiredBytes);
+		const size_t objectLimit = static_cast<size_t>(objectBudget / sizeof(FGpuSceneObject));
+		size_t consumedEntries = 0;
+		while (consumedEntries < m_DirtyObjects.size() && m_StagedObjects.size() < objectLimit)
+		{
+			const uint32_t objectIndex = m_DirtyObjects[consumedEntries++];
+			if (objectIndex < get_object_count() && m_ObjectDirty[objectIndex]) { m_StagedObjects.push_back(objectIndex); }
+		}
+
+		const VkDeviceSize objectBytes = static_cast<VkDeviceSize>(m_StagedObjects.size()) * sizeof(FGpuSceneObject);
+		FFrameAllocation stagingAllocation{};
+		if (meshBytes + objectBytes + runBytes > 0 && !m_FrameAllocator.allocate(meshBytes + objectBytes + runBytes, alignof(FGpuSceneMesh), stagingAllocation))
+		{
+			m_StagedObjects.clear();
+			return false;
+		}
+
+		// Meshes, then objects, then runs, each a multiple of the alignment of the next
+		uint8_t* stagingData = static_cast<uint8_t*>(stagingAllocation.data);
+		VkDeviceSize stagingOffset = 0;
+		for (uint32_t meshIndex = 0; meshIndex < static_cast<uint32_t>(m_Meshes.size()); meshIndex++)
+		{
+			if (!m_MeshDirty[meshIndex]) { continue; }
+			memcpy(stagingData + stagingOffset, &m_MeshRecords[meshIndex], sizeof(FGpuSceneMesh));
+			m_MeshCopies.push_back(VkBufferCopy{stagingAllocation.offset + stagingOffset, meshIndex * sizeof(FGpuSceneMesh), sizeof(FGpuSceneMesh)});
+			stagingOffset += sizeof(FGpuSceneMesh);
+			m_MeshDirty[meshIndex] = 0;
+		}
+		for (uint32_t objectIndex : m_StagedObjects)
+		{
+			memcpy(stagingData + stagingOffset, &m_ObjectRecords[objectIndex], sizeof(FGpuSceneObject));
+			m_ObjectCopies.push_back(VkBufferCopy{stagingAllocation.offset + stagingOffset, objectIndex * sizeof(FGpuSceneObject), sizeof(FGpuSceneObject)});
+			stagingOffset += sizeof(FGpuSceneObject);
+			m_ObjectDirty[objectIndex] = 0;
+		}
+		m_DirtyObjects.erase(m_DirtyObjects.begin(), m_DirtyObjects.begin() + consumedEntries);
+
+		if (runCount > 0)
+		{
+			// Every object owns a slot of its run, so a run's range only moves when object counts change
+			FGpuSceneRunRecord* runRecords = reinterpret_cast<FGpuSceneRunRecord*>(stagingData + stagingOffset);
+			uint32_t firstDraw = 0;
+			for (uint32_t runIndex = 0; runIndex < runCount; runIndex++)
+			{
+				m_Runs[runIndex].firstDraw = firstDraw;
+				runRecords[runIndex] = FGpuSceneRunRecord{firstDraw, m_Runs[runIndex].objectCount};
+				firstDraw += m_Runs[runIndex].objectCount;
+			}
+			m_RunCopy = VkBufferCopy{stagingAllocation.offset + stagingOffset, 0, runBytes};
+			m_bRunsDirty = false;
+		}
+
+		// Draw order only changes when runs are opened
+		if (m_RunDrawOrder.size() != m_Runs.size())
+		{
+			m_RunDrawOrder.resize(m_Runs.size());
+			for (uint32_t runIndex = 0; runIndex < static_cast<uint32_t>(m_Runs.size()); runIndex++) { m_RunDrawOrder[runIndex] = runIndex; }
+			std::sort(m_RunDrawOrder.begin(), m_RunDrawOrder.end(), [this](uint32_t left, uint32_t right)
+			{
+				const FGpuSceneRun& leftRun = m_Runs[left];
+				const FGpuSceneRun& rightRun = m_Runs[right];
+				const uint32_t leftFormat = static_cast<uint32_t>(m_Meshes[leftRun.meshIndex].handle->get_vertex_format());
+				const uint32_t rightFormat = static_cast<uint32_t>(m_Meshes[rightRun.meshIndex].handle->get_vertex_format());
+				return std::tie(leftFormat, leftRun.textureIndex, leftRun.meshIndex, left) < std::tie(rightFormat, rightRun.textureIndex, rightRun.meshIndex, right);
+			});
+		}
+		return true;
+	}
+
+	void SEGpuScene::record_uploads(VkCommandBuffer commandBuffer)
+	{
+		const VkBuffer stagingBuffer = m_FrameAllocator.get_buffer();
+		if (!m_MeshCopies.empty())
+		{
+			vkCmdCopyBuffer(commandBuffer, stagingBuffer, m_MeshBuffer->get_buffer(), static_cast<uint32_t>(m_MeshCopies.size()), m_MeshCopies.data());
+		}
+		if (!m_ObjectCopies.empty())
+		{
+			vkCmdCopyBuffer(commandBuffer, stagingBuffer, m_ObjectBuffer->get_buffer(), static_cast<uint32_t>(m_ObjectCopies.size()), m_ObjectCopies.data());
+		}
+		if (m_RunCopy.size > 0)
+		{
+			vkCmdCopyBuffer(commandBuffer, stagingBuffer, m_RunBuffer->get_buffer(), 1, &m_RunCopy);
+		}
+	}
+
+} // namespace SE
@@ -0,0 +1,175 @@
+#pragma once
+
+#include "SERendering/SEBuffer.hpp"
+#include "SERendering/SEFrameAllocator.hpp"
+#include "SERendering/SEFrameInfo.hpp"
+#include "SERendering/SEGraphicsDevice/SEGraphicsDevice.hpp"
+#include "SECore/SEEntities/SEGameObject.hpp"
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace SE {
+
+	// One registered object, SceneObject in gpu_cull.comp with the std430 layout
+	struct FGpuSceneObject {
+		glm::mat4 transformMatrix{1.0f};
+		glm::vec4 normalMatrix[3]{};	// Columns of the normal matrix, the shader completes the instance's mat4
+		uint32_t meshIndex = 0;
+		uint32_t textureIndex = 0;		// 0 for objects without a texture
+		uint32_t runIndex = 0;			// Run whose range of command slots a visible object is appended to
+		uint32_t flags = 0;				// SEGpuScene::OBJECT_VALID once written, the shader skips zeroed slots
+	};
+
+	// One level of detail of a scene mesh, SceneLod in gpu_cull.comp
+	struct FGpuSceneLod {
+		uint32_t firstIndex = 0;		// In the index buffer the mesh draws from
+		uint32_t indexCount = 0;
+		float error = 0.0f;
+		uint32_t padding = 0;
+	};
+
+	// One mesh of the registered objects, SceneMesh in gpu_cull.comp
+	struct FGpuSceneMesh {
+		glm::mat4 dequantizationMatrix{1.0f};
+		glm::vec4 boundingSphere{0.0f};
+		FGpuSceneLod lods[SEMesh::MAX_LOD_COUNT]{};
+		uint32_t lodCount = 0;			// 0 while the shader cannot draw the mesh, its objects are skipped
+		int32_t vertexOffset = 0;
+		uint32_t padding[2]{};
+	};
+
+	static_assert(sizeof(FGpuSceneObject) == 128, "FGpuSceneObject must match the std430 layout of gpu_cull.comp");
+	static_assert(sizeof(FGpuSceneMesh) == 176, "FGpuSceneMesh must match the std430 layout of gpu_cull.comp");
+
+	// Objects that share a mesh and a texture, drawn by one indirect count draw. The culling shader appends the
+	// visible ones to slots firstDraw to firstDraw + objectCount
+	struct FGpuSceneRun {
+		uint32_t meshIndex;
+		uint32_t textureIndex;
+		uint32_t firstDraw;
+		uint32_t objectCount;
+	};
+
+	// Objects drawn by GPU culling, kept in device local buffers between frames. Registering or changing an object
+	// rewrites its record on the CPU, and only changed records are copied to the GPU. Per frame the CPU work grows
+	// with the meshes, textures and runs of the scene, not with its objects
+	class SEGpuScene {
+
+	public:
+		static constexpr uint32_t OBJECT_VALID = 1;
+
+#pragma region Lifecycle
+		SEGpuScene(SEGraphicsDevice& graphicsDevice, SEFrameAllocator& frameAllocator);
+		~SEGpuScene() = default;
+
+		SEGpuScene(const SEGpuScene&) = delete;
+		SEGpuScene& operator=(const SEGpuScene&) = delete;
+#pragma endregion Lifecycle
+
+		// Registers an object, or rewrites the record of one registered under the same id. Objects without a mesh
+		// are removed
+		void set_object(SEGameObject::id_type id, const std::shared_ptr<SEMeshHandle>& mesh, const std::shared_ptr<SETextureHandle>& texture, const glm::mat4& transformMatrix, const glm::mat3& normalMatrix);
+		void remove_object(SEGameObject::id_type id);
+
+		// Once per frame, after the fence of frameInfo.frameIndex. Hands the texture extents the last dispatch of that
+		// frame index wrote to streaming, marks the meshes used and follows their residency
+		void begin_frame(const FFrameInfo& frameInfo);
+		// Copies changed runs and meshes to the frame allocator, and changed objects up to a budget, the rest wait for
+		// later frames. Returns false, staging nothing, when the frame allocator has no room for the runs and meshes
+		bool stage_uploads();
+		// Records the copies stage_uploads staged. The caller orders them after earlier reads and before the dispatch
+		void record_uploads(VkCommandBuffer commandBuffer);
+
+		// Slots the shader tests, every one belongs to a run
+		uint32_t get_object_count() const { return static_cast<uint32_t>(m_ObjectRecords.size()); }
+		const std::vector<FGpuSceneRun>& get_runs() const { return m_Runs; }
+		// Run indices sorted by pipeline, texture and mesh, the order that binds state the least
+		const std::vector<uint32_t>& get_run_draw_order() const { return m_RunDrawOrder; }
+		// Mesh the shader draws for a mesh index, nullptr while it is not resident or has no index buffer
+		SEMesh* get_drawn_mesh(uint32_t meshIndex) const { return m_Meshes[meshIndex].drawnMesh; }
+		// nullptr for index 0, objects without a texture
+		const SETextureHandle* get_texture(uint32_t textureIndex) const { return m_Textures[textureIndex].get(); }
+		// Resident meshes without an index buffer have no indexed command for the shader to write, the CPU path draws
+		// their objects
+		bool has_cpu_drawn_objects() const { return m_CpuDrawnObjectCount > 0; }
+		// First texture extent the dispatch of a frame index writes
+		uint32_t get_extent_base(uint32_t frameIndex) const { return frameIndex * m_TextureCapacity; }
+
+		// Buffers bound by the culling shader. The generation changes whenever one of them is recreated
+		uint32_t get_buffer_generation() const { return m_BufferGeneration; }
+		SEBuffer& get_object_buffer() { return *m_ObjectBuffer; }
+		SEBuffer& get_mesh_buffer() { return *m_MeshBuffer; }
+		SEBuffer& get_run_buffer() { return *m_RunBuffer; }
+		SEBuffer& get_lod_buffer() { return *m_LodBuffer; }
+		SEBuffer& get_extent_buffer() { return *m_ExtentBuffer; }
+
+	private:
+		// Resident state of one mesh, checked every frame
+		struct FSceneMesh {
+			std::shared_ptr<SEMeshHandle> handle;
+			SEMesh* drawnMesh = nullptr;
+			bool bCpuDrawn = false;		// Resident without an index buffer
+			uint32_t objectCount = 0;
+		};
+
+		uint32_t get_mesh_index(const std::shared_ptr<SEMeshHandle>& mesh);
+		uint32_t get_texture_index(const std::shared_ptr<SETextureHandle>& texture);
+		// Run that takes the next object of a mesh and texture, opening a new one when the last is full
+		uint32_t add_to_run(uint32_t meshIndex, uint32_t textureIndex);
+		void remove_from_run(const FGpuSceneObject& record);
+		void mark_object_dirty(uint32_t objectIndex);
+		// Grows the buffers to the counts registered, keeping their contents
+		void reserve_buffers();
+		// Recreates a device local buffer with room for capacity elements, the old contents copied and the rest zeroed
+		void grow_buffer(std::unique_ptr<SEBuffer>& buffer, VkDeviceSize elementSize, uint32_t capacity);
+		void create_extent_buffer(uint32_t textureCapacity);
+
+
+		SEGraphicsDevice& m_GraphicsDevice;
+		SEFrameAllocator& m_FrameAllocator;
+
+		// CPU copies of the records, slots stay dense as removal moves the last object into the hole
+		std::vector<FGpuSceneObject> m_ObjectRecords{};
+		std::vector<SEGameObject::id_type> m_ObjectIds{};
+		std::vector<uint8_t> m_ObjectDirty{};
+		std::vector<uint32_t> m_DirtyObjects{};		// Slots to upload, oldest first, stale entries are skipped
+		std::unordered_map<SEGameObject::id_type, uint32_t> m_ObjectSlots{};
+
+		std::vector<FSceneMesh> m_Meshes{};
+		std::vector<FGpuSceneMesh> m_MeshRecords{};
+		std::vector<uint8_t> m_MeshDirty{};
+		std::unordered_map<const SEMeshHandle*, uint32_t> m_MeshIndices{};
+		uint32_t m_CpuDrawnObjectCount = 0;
+
+		std::vector<std::shared_ptr<SETextureHandle>> m_Textures{nullptr};
+		std::unordered_map<const SETextureHandle*, uint32_t> m_TextureIndices{};
+
+		std::vector<FGpuSceneRun> m_Runs{};
+		std::vector<uint32_t> m_RunDrawOrder{};
+		std::unordered_map<uint64_t, uint32_t> m_OpenRuns{};	// Keyed by mesh index and texture index
+		bool m_bRunsDirty = false;
+
+		// Device local and shared by frames in flight, the culling shader reads them
+		std::unique_ptr<SEBuffer> m_ObjectBuffer;
+		std::unique_ptr<SEBuffer> m_MeshBuffer;
+		std::unique_ptr<SEBuffer> m_RunBuffer;		// First slot and slot count per run
+		std::unique_ptr<SEBuffer> m_LodBuffer;		// Level of detail each object drew last, written by the shader
+		// Host visible, one region of m_TextureCapacity entries per frame in flight. The shader keeps the largest
+		// screen extent of each texture's visible objects, as the bits of the float
+		std::unique_ptr<SEBuffer> m_ExtentBuffer;
+		uint32_t m_ObjectCapacity = 0;
+		uint32_t m_MeshCapacity = 0;
+		uint32_t m_RunCapacity = 0;
+		uint32_t m_TextureCapacity = 0;
+		uint32_t m_BufferGeneration = 0;
+
+		// Set by stage_uploads for record_uploads, from the frame allocator into the scene buffers
+		std::vector<uint32_t> m_StagedObjects{};
+		std::vector<VkBufferCopy> m_ObjectCopies{};
+		std::vector<VkBufferCopy> m_MeshCopies{};
+		VkBufferCopy m_RunCopy{};		// Empty while the runs are unchanged
+	};
+
+} // end SE namespace
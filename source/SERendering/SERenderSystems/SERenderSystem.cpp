@@ -1,7 +1,13 @@
 #include "SERendering/SERenderSystems/SERenderSystem.hpp"
 #include "SECore/SEUtilities/SEMatrixUtilities.hpp"
 #include <stdexcept>
+#include <algorithm>
 #include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+#include <limits>
 
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
@@ -10,16 +16,37 @@
 
 namespace SE {
 
-	struct PushConstantData
+	static_assert(sizeof(FInstanceData) == SEGpuCulling::INSTANCE_STRIDE, "The culling shader writes FInstanceData");
+
+	std::vector<VkVertexInputBindingDescription> FInstanceData::get_binding_descriptions()
+	{
+		std::vector<VkVertexInputBindingDescription> bindingDescriptions(1);
+		bindingDescriptions[0].binding = BINDING;
+		bindingDescriptions[0].stride = sizeof(FInstanceData);
+		bindingDescriptions[0].inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+		return bindingDescriptions;
+	}
+
+	std::vector<VkVertexInputAttributeDescription> FInstanceData::get_attribute_descriptions()
 	{
-		glm::mat4 meshMatrix{1.0f};
-		glm::mat4 normalMatrix{1.0f};
-	};
+		// Matrices are passed as four vec4 columns
+		std::vector<VkVertexInputAttributeDescription> attributeDescriptions{};
+		for (uint32_t column = 0; column < 4; column++)
+		{
+			attributeDescriptions.push_back({ FIRST_LOCATION + column, BINDING, VK_FORMAT_R32G32B32A32_SFLOAT, static_cast<uint32_t>(offsetof(FInstanceData, meshMatrix) + column * sizeof(glm::vec4)) });
+		}
+		for (uint32_t column = 0; column < 4; column++)
+		{
+			attributeDescriptions.push_back({ FIRST_LOCATION + 4 + column, BINDING, VK_FORMAT_R32G32B32A32_SFLOAT, static_cast<uint32_t>(offsetof(FInstanceData, normalMatrix) + column * sizeof(glm::vec4)) });
+		}
+		return attributeDescriptions;
+	}
 
 #pragma region Lifecycle
-	SERenderSystem::SERenderSystem(SEGraphicsDevice& graphicsDevice, VkRenderPass renderPass, VkDescriptorSetLayout globalDescriptorSetLayout) : m_GraphicsDevice(graphicsDevice)
+	SERenderSystem::SERenderSystem(SEGraphicsDevice& graphicsDevice, SEFrameAllocator& frameAllocator, VkRenderPass renderPass, VkDescriptorSetLayout globalDescriptorSetLayout, VkDescriptorSetLayout textureDescriptorSetLayout, VkDescriptorSet defaultTextureDescriptorSet)
+		: m_GraphicsDevice(graphicsDevice), m_FrameAllocator(frameAllocator), m_DefaultTextureDescriptorSet(defaultTextureDescriptorSet)
 	{
-		create_pipeline_layout(globalDescriptorSetLayout);
+		create_pipeline_layout(globalDescriptorSetLayout, textureDescriptorSetLayout);
 		create_pipeline(renderPass);
 	}
 
@@ -37,47 +64,721 @@ namespace SE {
 		SERenderPipeline::default_pipeline_config_info(pipelineConfig);
 		pipelineConfig.renderPass = renderPass;
 		pipelineConfig.pipelineLayout = m_PipelineLayout;
+		pipelineConfig.instanceBindingDescriptions = FInstanceData::get_binding_descriptions();
+		pipelineConfig.instanceAttributeDescriptions = FInstanceData::get_attribute_descriptions();
+
+		pipelineConfig.vertexFormat = EVertexFormat::Full;
+		m_Pipelines[static_cast<size_t>(EVertexFormat::Full)] = std::make_unique<SERenderPipeline>(m_GraphicsDevice, "shaders/basic_shader.vert.spv", "shaders/basic_shader.frag.spv", pipelineConfig);
+
+		// Packed vertices decode octahedral normals in the vertex shader, the fragment stage is shared
+		pipelineConfig.vertexFormat = EVertexFormat::Packed;
+		m_Pipelines[static_cast<size_t>(EVertexFormat::Packed)] = std::make_unique<SERenderPipeline>(m_GraphicsDevice, "shaders/basic_shader_packed.vert.spv", "shaders/basic_shader.frag.spv", pipelineConfig);
+	}
 
-		m_Pipeline = std::make_unique<SERenderPipeline>(m_GraphicsDevice, "shaders/basic_shader.vert.spv", "shaders/basic_shader.frag.spv", pipelineConfig);
+	void SERenderSystem::create_pipeline_layout(VkDescriptorSetLayout globalDescriptorSetLayout, VkDescriptorSetLayout textureDescriptorSetLayout)
+	{
+		// Per-object matrices are instance attributes, there are no push constants
+		m_PipelineLayout = SERenderPipeline::create_pipeline_layout(m_GraphicsDevice, {globalDescriptorSetLayout, textureDescriptorSetLayout});
 	}
 
-	void SERenderSystem::create_pipeline_layout(VkDescriptorSetLayout globalDescriptorSetLayout)
+	float SERenderSystem::get_screen_extent(const glm::vec3& worldCenter, float worldRadius, const FFrameInfo& frameInfo)
 	{
-		VkPushConstantRange pushConstantRange{};
-		pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
-		pushConstantRange.offset = 0;
-		pushConstantRange.size = sizeof(PushConstantData);
+		// Same projection as select_lod, scaled to pixels. A camera inside the bounds wants full detail
+		const glm::mat4& projectionMatrix = frameInfo.camera.get_projection_matrix();
+		float screenExtent = worldRadius * glm::abs(projectionMatrix[1][1]) * static_cast<float>(frameInfo.viewportExtent.height);
+		if (projectionMatrix[2][3] != 0.0f)
+		{
+			const float nearestDepth = (frameInfo.camera.get_view_matrix() * glm::vec4{worldCenter, 1.0f}).z - worldRadius;
+			if (nearestDepth <= 0.0f) { return std::numeric_limits<float>::max(); }
+			screenExtent /= nearestDepth;
+		}
+		return screenExtent;
+	}
 
-		std::vector<VkDescriptorSetLayout> descriptorSetLayouts{globalDescriptorSetLayout};
+	uint32_t SERenderSystem::select_lod(const SEMesh& mesh, const glm::mat4& transformMatrix, const glm::vec3& scale, const SECamera& camera, uint32_t previousLodIndex) const
+	{
+		const uint32_t lodCount = mesh.get_lod_count();
+		if (lodCount <= 1 || m_LodSettings.maxScreenError <= 0.0f) { return 0; }
 
-		VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
-		pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-		pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(descriptorSetLayouts.size());
-		pipelineLayoutInfo.pSetLayouts = descriptorSetLayouts.data();
-		pipelineLayoutInfo.pushConstantRangeCount = 1;
-		pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+		const glm::vec4 boundingSphere = mesh.get_bounding_sphere();
+		const float maxScale = glm::max(glm::abs(scale.x), glm::max(glm::abs(scale.y), glm::abs(scale.z)));
+		const glm::vec3 worldCenter{transformMatrix * glm::vec4{glm::vec3{boundingSphere}, 1.0f}};
+		const float worldRadius = boundingSphere.w * maxScale;
 
-		if (vkCreatePipelineLayout(m_GraphicsDevice.device(), &pipelineLayoutInfo, nullptr, &m_PipelineLayout) != VK_SUCCESS)
+		// Fraction of the viewport height covered by one mesh space unit at the nearest point of the bounds.
+		// Normalized device coordinates span 2 units, perspective projections also divide by view depth
+		const glm::mat4& projectionMatrix = camera.get_projection_matrix();
+		float screenScale = glm::abs(projectionMatrix[1][1]) * 0.5f * maxScale;
+		if (projectionMatrix[2][3] != 0.0f)
 		{
-			throw std::runtime_error("failed to create pipeline layout!");
+			const float nearestDepth = (camera.get_view_matrix() * glm::vec4{worldCenter, 1.0f}).z - worldRadius;
+			if (nearestDepth <= 0.0f) { return 0; }
+			screenScale /= nearestDepth;
 		}
+
+		// Coarsest level whose error stays below the limit once projected
+		auto find_lod = [&mesh, lodCount, screenScale](float maxScreenError)
+		{
+			for (uint32_t lodIndex = lodCount - 1; lodIndex > 0; lodIndex--)
+			{
+				if (mesh.get_lod(lodIndex).error * screenScale <= maxScreenError) { return lodIndex; }
+			}
+			return 0u;
+		};
+
+		const uint32_t lodIndex = find_lod(m_LodSettings.maxScreenError);
+		if (lodIndex <= previousLodIndex) { return lodIndex; }
+
+		// Refining happens right away, coarsening has to pass the tighter limit
+		return glm::max(find_lod(m_LodSettings.maxScreenError * (1.0f - m_LodSettings.hysteresis)), glm::min(previousLodIndex, lodCount - 1));
 	}
 
-	void SERenderSystem::render_game_objects(FFrameInfo& frameInfo, std::vector<SEGameObject>& gameObjects)
+	void SERenderSystem::add_visible_meshlet_draws(SEMesh& mesh, VkDescriptorSet textureDescriptorSet, const FFrustum& meshFrustum, const glm::vec3& meshCameraPosition, bool bConeCulling, uint32_t instanceIndex)
 	{
-		m_Pipeline->bind_command_buffer(frameInfo.commandBuffer);
+		// Visible meshlets that follow each other in the index buffer are merged into one draw
+		uint32_t rangeFirstIndex = 0;
+		uint32_t rangeIndexCount = 0;
+		auto flush_range = [&]()
+		{
+			if (rangeIndexCount == 0) { return; }
+			m_DrawCommands.push_back(FDrawCommand{mesh.get_index_range_command(rangeFirstIndex, rangeIndexCount, 1, instanceIndex), &mesh, textureDescriptorSet});
+			m_RenderStats.drawCalls++;
+			m_RenderStats.trianglesSubmitted += rangeIndexCount / 3;
+			rangeIndexCount = 0;
+		};
 
-		vkCmdBindDescriptorSets(frameInfo.commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_PipelineLayout, 0, 1, &frameInfo.descriptorSet, 0, nullptr);
+		for (const SEMesh::FMeshlet& meshlet : mesh.get_meshlets())
+		{
+			const glm::vec3 center{meshlet.boundingSphere};
+			const float radius = meshlet.boundingSphere.w;
 
+			bool bVisible = meshFrustum.intersects_sphere(center, radius);
+			if (bVisible && bConeCulling)
+			{
+				// Every triangle faces away when the camera lies inside the cone opposite the average normal
+				const glm::vec3 cameraToCenter = center - meshCameraPosition;
+				bVisible = glm::dot(cameraToCenter, meshlet.coneAxis) < meshlet.coneCutoff * glm::length(cameraToCenter) + radius;
+			}
+
+			if (!bVisible)
+			{
+				m_RenderStats.clustersCulled++;
+				continue;
+			}
+			m_RenderStats.clustersVisible++;
+
+			if (rangeIndexCount > 0 && rangeFirstIndex + rangeIndexCount == meshlet.firstIndex)
+			{
+				rangeIndexCount += meshlet.triangleCount * 3;
+				continue;
+			}
+			flush_range();
+			rangeFirstIndex = meshlet.firstIndex;
+			rangeIndexCount = meshlet.triangleCount * 3;
+		}
+		flush_range();
+	}
+
+	void SERenderSystem::gather_draw_candidates(const FFrameInfo& frameInfo, std::vector<SEGameObject>& gameObjects, bool bNonIndexedOnly)
+	{
+		m_DrawCandidates.clear();
+		m_CandidateCentersX.clear();
+		m_CandidateCentersY.clear();
+		m_CandidateCentersZ.clear();
+		m_CandidateRadii.clear();
 		for (SEGameObject& gameObject : gameObjects)
 		{
-			PushConstantData push{};
-			push.meshMatrix = get_transform_matrix(gameObject.m_TransformComponent.Translation, gameObject.m_TransformComponent.Rotation, gameObject.m_TransformComponent.Scale);
-			push.normalMatrix = get_normal_matrix(gameObject.m_TransformComponent.Translation, gameObject.m_TransformComponent.Rotation, gameObject.m_TransformComponent.Scale);
+			if (gameObject.m_Mesh == nullptr) { continue; }
+
+			// Marked even while not resident or culled, so meshes just out of view are not evicted
+			gameObject.m_Mesh->mark_used(frameInfo.frameNumber);
+			SEMesh* mesh = gameObject.m_Mesh->get_mesh();
+			// Uploads queued after this frame's staging flush go out with the next one
+			if (mesh == nullptr || !mesh->is_upload_submitted()) { continue; }
+			if (bNonIndexedOnly && mesh->has_index_buffer()) { continue; }
+
+			const glm::mat4 transformMatrix = get_transform_matrix(gameObject.m_TransformComponent.Translation, gameObject.m_TransformComponent.Rotation, gameObject.m_TransformComponent.Scale);
+			const glm::vec4 boundingSphere = mesh->get_bounding_sphere();
+			const glm::vec3 worldCenter{transformMatrix * glm::vec4{glm::vec3{boundingSphere}, 1.0f}};
+			// Longest basis vector, covers rotation and non-uniform scale
+			const float maxScale = glm::max(glm::length(glm::vec3{transformMatrix[0]}), glm::max(glm::length(glm::vec3{transformMatrix[1]}), glm::length(glm::vec3{transformMatrix[2]})));
+
+			m_DrawCandidates.push_back(FDrawCandidate{&gameObject, mesh, transformMatrix});
+			m_CandidateCentersX.push_back(worldCenter.x);
+			m_CandidateCentersY.push_back(worldCenter.y);
+			m_CandidateCentersZ.push_back(worldCenter.z);
+			m_CandidateRadii.push_back(boundingSphere.w * maxScale);
+		}
+	}
+
+	void SERenderSystem::render_game_objects(FFrameInfo& frameInfo, std::vector<SEGameObject>& gameObjects)
+	{
+		prepare_draws(frameInfo, gameObjects);
+
+		FBoundState boundState{};
+		record_draws(frameInfo.commandBuffer, frameInfo, 0, static_cast<uint32_t>(m_DrawRuns.size()), m_bDrawsGpuCulled, boundState);
+		add_recording_stats(boundState.renderStats);
+	}
+
+	const std::vector<VkCommandBuffer>& SERenderSystem::record_game_objects(FFrameInfo& frameInfo, std::vector<SEGameObject>& gameObjects, SEParallelRecorder& recorder, VkRenderPass renderPass)
+	{
+		prepare_draws(frameInfo, gameObjects);
+
+		// Contiguous runs per thread with about the same number of draws each, so the secondary buffers execute in
+		// the order a single thread would have recorded. Indirect count draws of GPU culling cost the same for any
+		// number of objects, the first thread records them ahead of its runs
+		const uint32_t runCount = static_cast<uint32_t>(m_DrawRuns.size());
+		const uint32_t threadCount = std::min({recorder.get_thread_count(), std::max(1u, static_cast<uint32_t>(m_DrawCommands.size()) / MIN_DRAWS_PER_THREAD), std::max(runCount, 1u)});
+		m_ThreadFirstRuns.assign(threadCount + 1, runCount);
+		m_ThreadFirstRuns[0] = 0;
+		uint64_t recordedDraws = 0;
+		uint32_t threadIndex = 1;
+		for (uint32_t runIndex = 0; runIndex < runCount && threadIndex < threadCount; runIndex++)
+		{
+			if (recordedDraws * threadCount >= m_DrawCommands.size() * threadIndex) { m_ThreadFirstRuns[threadIndex++] = runIndex; }
+			recordedDraws += m_DrawRuns[runIndex].drawCount;
+		}
+		m_ThreadRenderStats.assign(threadCount, FRenderStats{});
+
+		const std::vector<VkCommandBuffer>& commandBuffers = recorder.record(renderPass, threadCount, [this, &frameInfo](uint32_t threadIndex, VkCommandBuffer commandBuffer)
+		{
+			// Secondary command buffers do not inherit dynamic state
+			VkViewport viewport{0.0f, 0.0f, static_cast<float>(frameInfo.viewportExtent.width), static_cast<float>(frameInfo.viewportExtent.height), 0.0f, 1.0f};
+			VkRect2D scissor{{0, 0}, frameInfo.viewportExtent};
+			vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+			vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+
+			FBoundState boundState{};
+			record_draws(commandBuffer, frameInfo, m_ThreadFirstRuns[threadIndex], m_ThreadFirstRuns[threadIndex + 1], threadIndex == 0 && m_bDrawsGpuCulled, boundState);
+			m_ThreadRenderStats[threadIndex] = boundState.renderStats;
+		});
+
+		for (const FRenderStats& threadRenderStats : m_ThreadRenderStats) { add_recording_stats(threadRenderStats); }
+		return commandBuffers;
+	}
+
+	void SERenderSystem::add_recording_stats(const FRenderStats& recordingStats)
+	{
+		m_RenderStats.pipelineBinds += recordingStats.pipelineBinds;
+		m_RenderStats.geometryBinds += recordingStats.geometryBinds;
+		m_RenderStats.textureBinds += recordingStats.textureBinds;
+		m_RenderStats.indirectCalls += recordingStats.indirectCalls;
+		m_RenderStats.stateChanges += recordingStats.pipelineBinds + recordingStats.geometryBinds + recordingStats.textureBinds;
+	}
+
+	void SERenderSystem::record_draws(VkCommandBuffer commandBuffer, const FFrameInfo& frameInfo, uint32_t firstRun, uint32_t runEnd, bool bGpuCulledDraws, FBoundState& boundState)
+	{
+		// Pipelines share the layout, so the global set stays bound across pipeline switches
+		m_Pipelines[static_cast<size_t>(boundState.vertexFormat)]->bind_command_buffer(commandBuffer);
+		boundState.renderStats.pipelineBinds++;
+		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_PipelineLayout, 0, 1, &frameInfo.descriptorSet, 1, &frameInfo.globalUniformOffset);
+
+		if (bGpuCulledDraws) { submit_gpu_culled_draws(commandBuffer, boundState); }
+		if (firstRun == runEnd) { return; }
+
+		const VkBuffer instanceBuffer = m_FrameAllocator.get_buffer();
+		vkCmdBindVertexBuffers(commandBuffer, FInstanceData::BINDING, 1, &instanceBuffer, &m_InstanceOffset);
+		submit_draws(commandBuffer, get_supported_draw_submission(m_DrawSubmission), boundState, firstRun, runEnd);
+	}
+
+	void SERenderSystem::prepare_draws(FFrameInfo& frameInfo, std::vector<SEGameObject>& gameObjects)
+	{
+		m_DrawCommands.clear();
+		m_DrawRuns.clear();
+
+		// The culling dispatch of this frame already counted its objects. Meshes without an index buffer have no
+		// indexed command for the shader to write, their objects still go through the CPU path
+		m_bDrawsGpuCulled = m_bGpuCullingRecorded && m_GpuCullingFrame == frameInfo.frameNumber;
+		if (m_bDrawsGpuCulled && !m_GpuScene->has_cpu_drawn_objects()) { return; }
+		if (!m_bDrawsGpuCulled) { m_RenderStats = FRenderStats{}; }
+
+		const glm::mat4 projectionViewMatrix = frameInfo.camera.get_projection_matrix() * frameInfo.camera.get_view_matrix();
+		const glm::vec3 cameraPosition{glm::inverse(frameInfo.camera.get_view_matrix())[3]};
+		// Cone culling needs a camera position, orthographic projections only have a direction
+		const bool bConeCulling = m_CullingSettings.clusterConeCulling && frameInfo.camera.get_projection_matrix()[2][3] != 0.0f;
+
+		gather_draw_candidates(frameInfo, gameObjects, m_bDrawsGpuCulled);
+		m_CandidateVisible.assign(m_DrawCandidates.size(), 1);
+		if (m_CullingSettings.frustumCulling) { cull_candidates(FFrustum::from_matrix(projectionViewMatrix)); }
+
+		// Pick the level of detail and texture of each visible object, and its sort key
+		const glm::mat4& viewMatrix = frameInfo.camera.get_view_matrix();
+		m_InstanceDraws.clear();
+		m_SortItems.clear();
+		for (size_t candidateIndex = 0; candidateIndex < m_DrawCandidates.size(); candidateIndex++)
+		{
+			if (!m_CandidateVisible[candidateIndex])
+			{
+				m_RenderStats.objectsCulled++;
+				continue;
+			}
+			m_RenderStats.objectsVisible++;
+
+			SEGameObject& gameObject = *m_DrawCandidates[candidateIndex].gameObject;
+			SEMesh* mesh = m_DrawCandidates[candidateIndex].mesh;
+			gameObject.m_LodIndex = select_lod(*mesh, m_DrawCandidates[candidateIndex].transformMatrix, gameObject.m_TransformComponent.Scale, frameInfo.camera, gameObject.m_LodIndex);
+
+			// Streaming hears about every draw, resident or not
+			const glm::vec3 worldCenter{m_CandidateCentersX[candidateIndex], m_CandidateCentersY[candidateIndex], m_CandidateCentersZ[candidateIndex]};
+			VkDescriptorSet textureDescriptorSet = m_DefaultTextureDescriptorSet;
+			uint32_t textureId = 0;
+			if (gameObject.m_Texture != nullptr)
+			{
+				gameObject.m_Texture->request_screen_extent(get_screen_extent(worldCenter, m_CandidateRadii[candidateIndex], frameInfo), frameInfo.frameNumber);
+				if (gameObject.m_Texture->is_resident())
+				{
+					textureDescriptorSet = gameObject.m_Texture->get_descriptor_set();
+					textureId = gameObject.m_Texture->get_sort_id();
+				}
+			}
+
+			// Nearest point of the bounds, the camera looks down positive view space z
+			const float viewDepth = (viewMatrix * glm::vec4{worldCenter, 1.0f}).z - m_CandidateRadii[candidateIndex];
+			m_SortItems.push_back(FSortItem{make_sort_key(OPAQUE_PASS, mesh->get_vertex_format(), mesh->get_sort_id(), gameObject.m_LodIndex, textureId, viewDepth), static_cast<uint32_t>(m_InstanceDraws.size())});
+			m_InstanceDraws.push_back(FInstanceDraw{mesh, gameObject.m_LodIndex, textureDescriptorSet, static_cast<uint32_t>(candidateIndex)});
+		}
+		if (m_InstanceDraws.empty()) { return; }
+
+		// Instances beyond what the frame allocator has left are dropped, the farthest first, rather than failing the frame.
+		// Each instance also reserves room for the indirect command and count of the draw it may end up alone in, plus
+		// alignment padding of every recording thread's allocations
+		const VkDeviceSize freeBytes = m_FrameAllocator.get_frame_free_bytes();
+		const VkDeviceSize reservedBytes = alignof(FInstanceData) + SEParallelRecorder::MAX_THREAD_COUNT * 2 * sizeof(uint32_t);
+		const VkDeviceSize instanceBytes = sizeof(FInstanceData) + sizeof(VkDrawIndexedIndirectCommand) + sizeof(uint32_t);
+		const size_t instanceLimit = freeBytes > reservedBytes ? static_cast<size_t>((freeBytes - reservedBytes) / instanceBytes) : 0;
+		const bool bInstancesDropped = m_InstanceDraws.size() > instanceLimit;
+		if (bInstancesDropped)
+		{
+			m_RenderStats.instancesDropped = static_cast<uint32_t>(m_InstanceDraws.size() - instanceLimit);
+			if (!m_bInstanceLimitWarned)
+			{
+				std::cerr << "Instance data exceeds the frame allocator, dropping the " << m_RenderStats.instancesDropped << " farthest of " << m_InstanceDraws.size() << " objects\n";
+				m_bInstanceLimitWarned = true;
+			}
+			if (instanceLimit == 0)
+			{
+				m_InstanceDraws.clear();
+				return;
+			}
+
+			// The low bits of the sort keys are the view depth
+			std::nth_element(m_SortItems.begin(), m_SortItems.begin() + instanceLimit, m_SortItems.end(), [](const FSortItem& left, const FSortItem& right)
+			{
+				return (left.key & SORT_KEY_DEPTH_MASK) < (right.key & SORT_KEY_DEPTH_MASK);
+			});
+			m_SortItems.resize(instanceLimit);
+			// Unsorted draws keep the order they were gathered in
+			if (!m_bDrawSorting)
+			{
+				std::sort(m_SortItems.begin(), m_SortItems.end(), [](const FSortItem& left, const FSortItem& right) { return left.index < right.index; });
+			}
+		}
+
+		// Batches become contiguous instance ranges, ordered so that state changes as rarely as possible
+		if (m_bDrawSorting) { radix_sort(m_SortItems, m_SortScratch); }
+		if (m_bDrawSorting || bInstancesDropped)
+		{
+			m_SortedInstanceDraws.clear();
+			for (const FSortItem& sortItem : m_SortItems) { m_SortedInstanceDraws.push_back(m_InstanceDraws[sortItem.index]); }
+			m_InstanceDraws.swap(m_SortedInstanceDraws);
+		}
+
+		// One allocation and one bind cover the instances of every batch
+		FFrameAllocation instanceAllocation{};
+		if (!m_FrameAllocator.allocate(m_InstanceDraws.size() * sizeof(FInstanceData), alignof(FInstanceData), instanceAllocation))
+		{
+			throw std::runtime_error("failed to allocate instance data!");
+		}
+		FInstanceData* instanceData = static_cast<FInstanceData*>(instanceAllocation.data);
+		for (size_t instanceIndex = 0; instanceIndex < m_InstanceDraws.size(); instanceIndex++)
+		{
+			const FInstanceDraw& instanceDraw = m_InstanceDraws[instanceIndex];
+			const TransformComponent& transform = m_DrawCandidates[instanceDraw.candidateIndex].gameObject->m_TransformComponent;
+
+			// Packed positions are expanded to mesh space by the dequantization matrix
+			FInstanceData instance{};
+			instance.meshMatrix = m_DrawCandidates[instanceDraw.candidateIndex].transformMatrix * instanceDraw.mesh->get_dequantization_matrix();
+			instance.normalMatrix = get_normal_matrix(transform.Translation, transform.Rotation, transform.Scale);
+			instanceData[instanceIndex] = instance;
+		}
+
+		m_InstanceOffset = instanceAllocation.offset;
+
+		// Batches become draws, in batch order so that runs of draws sharing state stay together
+		size_t batchStart = 0;
+		while (batchStart < m_InstanceDraws.size())
+		{
+			const FInstanceDraw& instanceDraw = m_InstanceDraws[batchStart];
+			size_t batchEnd = batchStart + 1;
+			while (batchEnd < m_InstanceDraws.size() && instanceDraw.is_same_batch(m_InstanceDraws[batchEnd])) { batchEnd++; }
+			const uint32_t firstInstance = static_cast<uint32_t>(batchStart);
+			const uint32_t instanceCount = static_cast<uint32_t>(batchEnd - batchStart);
+			batchStart = batchEnd;
+
+			// Meshlets cover the full detail level of a single object. Culling runs in mesh space, which keeps non-uniform
+			// scale exact. Batches of several objects draw whole levels, culling them per instance would split the batch
+			SEMesh& mesh = *instanceDraw.mesh;
+			if (instanceCount == 1 && m_CullingSettings.clusterCulling && instanceDraw.lodIndex == 0 && !mesh.get_meshlets().empty())
+			{
+				const glm::mat4& transformMatrix = m_DrawCandidates[instanceDraw.candidateIndex].transformMatrix;
+				const FFrustum meshFrustum = FFrustum::from_matrix(projectionViewMatrix * transformMatrix);
+				const glm::vec3 meshCameraPosition{glm::inverse(transformMatrix) * glm::vec4{cameraPosition, 1.0f}};
+				add_visible_meshlet_draws(mesh, instanceDraw.textureDescriptorSet, meshFrustum, meshCameraPosition, bConeCulling, firstInstance);
+				continue;
+			}
+
+			m_DrawCommands.push_back(FDrawCommand{mesh.get_draw_command(instanceDraw.lodIndex, instanceCount, firstInstance), &mesh, instanceDraw.textureDescriptorSet});
+			m_RenderStats.drawCalls++;
+			m_RenderStats.trianglesSubmitted += static_cast<uint64_t>(mesh.get_triangle_count(instanceDraw.lodIndex)) * instanceCount;
+		}
+
+		build_draw_runs();
+	}
+
+	uint64_t SERenderSystem::make_sort_key(uint32_t pass, EVertexFormat vertexFormat, uint32_t meshId, uint32_t lodIndex, uint32_t textureId, float viewDepth)
+	{
+		// The bits of non-negative floats order like their values. The 24 below the sign bit keep 16 bits of mantissa,
+		// precise to about 0.002 percent of the depth. Objects reaching behind the camera sort first
+		uint32_t depthBits = 0;
+		if (viewDepth > 0.0f) { memcpy(&depthBits, &viewDepth, sizeof(depthBits)); }
+
+		return (static_cast<uint64_t>(pass & 0x3) << 62)
+			| (static_cast<uint64_t>(static_cast<uint32_t>(vertexFormat) & 0x3) << 60)
+			| (static_cast<uint64_t>(meshId & 0xFFFF) << 44)
+			| (static_cast<uint64_t>(std::min(lodIndex, 15u)) << 40)
+			| (static_cast<uint64_t>(textureId & 0xFFFF) << 24)
+			| static_cast<uint64_t>(depthBits >> 7);
+	}
+
+	void SERenderSystem::add_gpu_scene_object(const SEGameObject& gameObject)
+	{
+		if (!is_gpu_culling_active()) { return; }
+		if (m_GpuScene == nullptr) { m_GpuScene = std::make_unique<SEGpuScene>(m_GraphicsDevice, m_FrameAllocator); }
+
+		const TransformComponent& transform = gameObject.m_TransformComponent;
+		m_GpuScene->set_object(gameObject.get_game_object_id(), gameObject.m_Mesh, gameObject.m_Texture, get_transform_matrix(transform.Translation, transform.Rotation, transform.Scale),
+			get_normal_matrix(transform.Translation, transform.Rotation, transform.Scale));
+	}
+
+	void SERenderSystem::remove_gpu_scene_object(SEGameObject::id_type id)
+	{
+		if (m_GpuScene != nullptr) { m_GpuScene->remove_object(id); }
+	}
+
+	void SERenderSystem::record_gpu_culling(FFrameInfo& frameInfo)
+	{
+		m_bGpuCullingRecorded = false;
+		if (!is_gpu_culling_active() || m_GpuScene == nullptr) { return; }
+		if (m_GpuCulling == nullptr) { m_GpuCulling = std::make_unique<SEGpuCulling>(m_GraphicsDevice, m_FrameAllocator, *m_GpuScene); }
+
+		m_GpuScene->begin_frame(frameInfo);
+
+		// Planes that every sphere passes when frustum culling is off
+		FGpuCullConstants cullConstants{};
+		for (glm::vec4& plane : cullConstants.frustumPlanes) { plane = glm::vec4{0.0f, 0.0f, 0.0f, 1.0f}; }
+		const glm::mat4& projectionMatrix = frameInfo.camera.get_projection_matrix();
+		const glm::mat4& viewMatrix = frameInfo.camera.get_view_matrix();
+		if (m_CullingSettings.frustumCulling)
+		{
+			const FFrustum frustum = FFrustum::from_matrix(projectionMatrix * viewMatrix);
+			std::copy(std::begin(frustum.planes), std::end(frustum.planes), std::begin(cullConstants.frustumPlanes));
+		}
+
+		// The shader follows select_lod and get_screen_extent
+		cullConstants.viewDepthRow = glm::vec4{viewMatrix[0][2], viewMatrix[1][2], viewMatrix[2][2], viewMatrix[3][2]};
+		cullConstants.projectionScale = glm::abs(projectionMatrix[1][1]);
+		cullConstants.viewportHeight = static_cast<float>(frameInfo.viewportExtent.height);
+		cullConstants.maxScreenError = m_LodSettings.maxScreenError;
+		cullConstants.hysteresis = m_LodSettings.hysteresis;
+		cullConstants.objectCount = m_GpuScene->get_object_count();
+		cullConstants.extentBase = m_GpuScene->get_extent_base(frameInfo.frameIndex);
+		cullConstants.bPerspective = projectionMatrix[2][3] != 0.0f ? 1 : 0;
+		if (!m_GpuCulling->record_dispatch(frameInfo.commandBuffer, cullConstants)) { return; }
+
+		m_RenderStats = FRenderStats{};
+		m_RenderStats.gpuCulledObjects = cullConstants.objectCount;
+		m_bGpuCullingRecorded = true;
+		m_GpuCullingFrame = frameInfo.frameNumber;
+	}
+
+	void SERenderSystem::submit_gpu_culled_draws(VkCommandBuffer commandBuffer, FBoundState& boundState)
+	{
+		// Each command's firstInstance is its own slot in the instance buffer
+		const VkBuffer instanceBuffer = m_GpuCulling->get_instance_buffer();
+		const VkDeviceSize instanceOffset = 0;
+		vkCmdBindVertexBuffers(commandBuffer, FInstanceData::BINDING, 1, &instanceBuffer, &instanceOffset);
+
+		// Texture residency changes without touching the scene, descriptor sets are looked up per run
+		const std::vector<FGpuSceneRun>& gpuSceneRuns = m_GpuScene->get_runs();
+		for (uint32_t runIndex : m_GpuScene->get_run_draw_order())
+		{
+			const FGpuSceneRun& gpuSceneRun = gpuSceneRuns[runIndex];
+			SEMesh* mesh = m_GpuScene->get_drawn_mesh(gpuSceneRun.meshIndex);
+			if (gpuSceneRun.objectCount == 0 || mesh == nullptr) { continue; }
+
+			const SETextureHandle* texture = m_GpuScene->get_texture(gpuSceneRun.textureIndex);
+			const VkDescriptorSet textureDescriptorSet = texture != nullptr && texture->is_resident() ? texture->get_descriptor_set() : m_DefaultTextureDescriptorSet;
+			bind_draw_state(commandBuffer, FDrawCommand{VkDrawIndexedIndirectCommand{}, mesh, textureDescriptorSet}, boundState);
+
+			const VkDeviceSize commandOffset = static_cast<VkDeviceSize>(gpuSceneRun.firstDraw) * sizeof(VkDrawIndexedIndirectCommand);
+			const VkDeviceSize countOffset = static_cast<VkDeviceSize>(runIndex) * sizeof(uint32_t);
+			m_GraphicsDevice.cmd_draw_indexed_indirect_count(commandBuffer, m_GpuCulling->get_command_buffer(), commandOffset, m_GpuCulling->get_count_buffer(), countOffset, gpuSceneRun.objectCount, sizeof(VkDrawIndexedIndirectCommand));
+			boundState.renderStats.indirectCalls++;
+		}
+	}
+
+	EDrawSubmission SERenderSystem::get_supported_draw_submission(EDrawSubmission drawSubmission) const
+	{
+		if (drawSubmission == EDrawSubmission::Direct || !m_GraphicsDevice.supports_multi_draw_indirect()) { return EDrawSubmission::Direct; }
+		if (drawSubmission == EDrawSubmission::IndirectCount && !m_GraphicsDevice.supports_draw_indirect_count()) { return EDrawSubmission::Indirect; }
+		return drawSubmission;
+	}
+
+	bool SERenderSystem::is_same_draw_state(const FDrawCommand& left, const FDrawCommand& right)
+	{
+		// Pooled meshes of one format share the pipeline and buffers, so runs usually only break at texture changes
+		return left.mesh->get_vertex_format() == right.mesh->get_vertex_format()
+			&& left.mesh->get_vertex_buffer() == right.mesh->get_vertex_buffer()
+			&& left.mesh->get_index_buffer() == right.mesh->get_index_buffer()
+			&& left.mesh->get_index_type() == right.mesh->get_index_type()
+			&& left.mesh->has_index_buffer() == right.mesh->has_index_buffer()
+			&& left.textureDescriptorSet == right.textureDescriptorSet;
+	}
+
+	void SERenderSystem::build_draw_runs()
+	{
+		const uint32_t maxRunDraws = std::max(m_GraphicsDevice.properties.limits.maxDrawIndirectCount, 1u);
+
+		m_DrawRuns.clear();
+		for (uint32_t drawIndex = 0; drawIndex < static_cast<uint32_t>(m_DrawCommands.size()); drawIndex++)
+		{
+			if (!m_DrawRuns.empty())
+			{
+				FDrawRun& drawRun = m_DrawRuns.back();
+				if (drawRun.drawCount < maxRunDraws && is_same_draw_state(m_DrawCommands[drawRun.firstDraw], m_DrawCommands[drawIndex]))
+				{
+					drawRun.drawCount++;
+					continue;
+				}
+			}
+			m_DrawRuns.push_back(FDrawRun{drawIndex, 1});
+		}
+	}
+
+	void SERenderSystem::bind_draw_state(VkCommandBuffer commandBuffer, const FDrawCommand& drawCommand, FBoundState& boundState)
+	{
+		const EVertexFormat vertexFormat = drawCommand.mesh->get_vertex_format();
+		if (vertexFormat != boundState.vertexFormat)
+		{
+			boundState.vertexFormat = vertexFormat;
+			m_Pipelines[static_cast<size_t>(vertexFormat)]->bind_command_buffer(commandBuffer);
+			boundState.renderStats.pipelineBinds++;
+		}
+		bind_mesh_geometry(commandBuffer, *drawCommand.mesh, boundState);
+
+		if (drawCommand.textureDescriptorSet != boundState.textureDescriptorSet)
+		{
+			vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_PipelineLayout, 1, 1, &drawCommand.textureDescriptorSet, 0, nullptr);
+			boundState.textureDescriptorSet = drawCommand.textureDescriptorSet;
+			boundState.renderStats.textureBinds++;
+		}
+	}
+
+	void SERenderSystem::submit_draws(VkCommandBuffer commandBuffer, EDrawSubmission drawSubmission, FBoundState& boundState, uint32_t firstRun, uint32_t runEnd)
+	{
+		if (firstRun == runEnd) { return; }
+		const uint32_t firstDrawIndex = m_DrawRuns[firstRun].firstDraw;
+		const uint32_t drawEnd = m_DrawRuns[runEnd - 1].firstDraw + m_DrawRuns[runEnd - 1].drawCount;
+
+		// Every command of the runs goes to the GPU in one allocation, indirect calls point into it. Meshlet draws can
+		// outgrow what prepare_draws reserved, a full frame allocator falls back to a mode that needs less of it
+		FFrameAllocation commandAllocation{};
+		FFrameAllocation countAllocation{};
+		if (drawSubmission != EDrawSubmission::Direct && !m_FrameAllocator.allocate(static_cast<VkDeviceSize>(drawEnd - firstDrawIndex) * sizeof(VkDrawIndexedIndirectCommand), sizeof(uint32_t), commandAllocation))
+		{
+			drawSubmission = EDrawSubmission::Direct;
+		}
+		if (drawSubmission != EDrawSubmission::Direct)
+		{
+			VkDrawIndexedIndirectCommand* indirectCommands = static_cast<VkDrawIndexedIndirectCommand*>(commandAllocation.data);
+			for (uint32_t drawIndex = firstDrawIndex; drawIndex < drawEnd; drawIndex++)
+			{
+				indirectCommands[drawIndex - firstDrawIndex] = m_DrawCommands[drawIndex].command;
+			}
+		}
+		if (drawSubmission == EDrawSubmission::IndirectCount && !m_FrameAllocator.allocate(static_cast<VkDeviceSize>(runEnd - firstRun) * sizeof(uint32_t), sizeof(uint32_t), countAllocation))
+		{
+			drawSubmission = EDrawSubmission::Indirect;
+		}
+
+		const VkBuffer frameBuffer = m_FrameAllocator.get_buffer();
+		for (uint32_t runIndex = firstRun; runIndex < runEnd; runIndex++)
+		{
+			const FDrawRun& drawRun = m_DrawRuns[runIndex];
+			const FDrawCommand& firstDraw = m_DrawCommands[drawRun.firstDraw];
+			bind_draw_state(commandBuffer, firstDraw, boundState);
+
+			// Meshes without an index buffer have no indexed indirect command, they are always drawn directly
+			if (drawSubmission == EDrawSubmission::Direct || !firstDraw.mesh->has_index_buffer())
+			{
+				for (uint32_t drawIndex = drawRun.firstDraw; drawIndex < drawRun.firstDraw + drawRun.drawCount; drawIndex++)
+				{
+					const VkDrawIndexedIndirectCommand& command = m_DrawCommands[drawIndex].command;
+					if (firstDraw.mesh->has_index_buffer())
+					{
+						vkCmdDrawIndexed(commandBuffer, command.indexCount, command.instanceCount, command.firstIndex, command.vertexOffset, command.firstInstance);
+						continue;
+					}
+					vkCmdDraw(commandBuffer, command.indexCount, command.instanceCount, command.firstIndex, command.firstInstance);
+				}
+				continue;
+			}
+
+			const VkDeviceSize commandOffset = commandAllocation.offset + static_cast<VkDeviceSize>(drawRun.firstDraw - firstDrawIndex) * sizeof(VkDrawIndexedIndirectCommand);
+			if (drawSubmission == EDrawSubmission::IndirectCount)
+			{
+				static_cast<uint32_t*>(countAllocation.data)[runIndex - firstRun] = drawRun.drawCount;
+				const VkDeviceSize countOffset = countAllocation.offset + static_cast<VkDeviceSize>(runIndex - firstRun) * sizeof(uint32_t);
+				m_GraphicsDevice.cmd_draw_indexed_indirect_count(commandBuffer, frameBuffer, commandOffset, frameBuffer, countOffset, drawRun.drawCount, sizeof(VkDrawIndexedIndirectCommand));
+			}
+			else
+			{
+				vkCmdDrawIndexedIndirect(commandBuffer, frameBuffer, commandOffset, drawRun.drawCount, sizeof(VkDrawIndexedIndirectCommand));
+			}
+			boundState.renderStats.indirectCalls++;
+		}
+	}
+
+	void SERenderSystem::benchmark_draw_submission(VkRenderPass renderPass, SEMesh& mesh, VkDescriptorSet globalDescriptorSet, const std::vector<uint32_t>& objectCounts, uint32_t iterations)
+	{
+		VkCommandBufferAllocateInfo allocateInfo{};
+		allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+		allocateInfo.commandPool = m_GraphicsDevice.get_command_pool();
+		allocateInfo.commandBufferCount = 1;
+
+		VkCommandBuffer commandBuffer;
+		if (vkAllocateCommandBuffers(m_GraphicsDevice.device(), &allocateInfo, &commandBuffer) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to allocate benchmark command buffer!");
+		}
+
+		// Secondary command buffers continuing the render pass are recorded like the frame's, but never submitted
+		VkCommandBufferInheritanceInfo inheritanceInfo{};
+		inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+		inheritanceInfo.renderPass = renderPass;
+		inheritanceInfo.subpass = 0;
+
+		VkCommandBufferBeginInfo beginInfo{};
+		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT | VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+		beginInfo.pInheritanceInfo = &inheritanceInfo;
+
+		// Each iteration records the same draws from scratch, the way a frame does
+		auto time_recording = [&](EDrawSubmission drawSubmission) {
+			const auto startTime = std::chrono::steady_clock::now();
+			for (uint32_t iteration = 0; iteration < iterations; iteration++)
+			{
+				m_FrameAllocator.begin_frame(0);
+				if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS)
+				{
+					throw std::runtime_error("failed to begin recording benchmark command buffer!");
+				}
+
+				FBoundState boundState{};
+				m_Pipelines[static_cast<size_t>(boundState.vertexFormat)]->bind_command_buffer(commandBuffer);
+				const uint32_t globalUniformOffset = 0;
+				vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_PipelineLayout, 0, 1, &globalDescriptorSet, 1, &globalUniformOffset);
+				const VkBuffer instanceBuffer = m_FrameAllocator.get_buffer();
+				const VkDeviceSize instanceOffset = 0;
+				vkCmdBindVertexBuffers(commandBuffer, FInstanceData::BINDING, 1, &instanceBuffer, &instanceOffset);
+
+				submit_draws(commandBuffer, drawSubmission, boundState, 0, static_cast<uint32_t>(m_DrawRuns.size()));
+
+				if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS)
+				{
+					throw std::runtime_error("failed to record benchmark command buffer!");
+				}
+			}
+			return std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+		};
+
+		std::cout << "Draw submission benchmark, " << mesh.get_triangle_count() << " triangles per draw, " << iterations << " recordings each\n";
+		for (uint32_t objectCount : objectCounts)
+		{
+			m_DrawCommands.clear();
+			for (uint32_t objectIndex = 0; objectIndex < objectCount; objectIndex++)
+			{
+				m_DrawCommands.push_back(FDrawCommand{mesh.get_draw_command(0, 1, objectIndex), &mesh, m_DefaultTextureDescriptorSet});
+			}
+			build_draw_runs();
+
+			std::cout << "   " << objectCount << " objects\n";
+			const double directSeconds = time_recording(EDrawSubmission::Direct);
+			std::cout << "      Direct:         " << directSeconds * 1000.0 / iterations << " ms\n";
+			for (EDrawSubmission drawSubmission : {EDrawSubmission::Indirect, EDrawSubmission::IndirectCount})
+			{
+				const char* name = drawSubmission == EDrawSubmission::Indirect ? "Indirect:       " : "Indirect count: ";
+				if (get_supported_draw_submission(drawSubmission) != drawSubmission)
+				{
+					std::cout << "      " << name << "unavailable on this device\n";
+					continue;
+				}
+
+				const double indirectSeconds = time_recording(drawSubmission);
+				std::cout << "      " << name << indirectSeconds * 1000.0 / iterations << " ms, " << (indirectSeconds > 0.0 ? directSeconds / indirectSeconds : 0.0) << "x\n";
+			}
+		}
+
+		m_DrawCommands.clear();
+		m_DrawRuns.clear();
+		vkFreeCommandBuffers(m_GraphicsDevice.device(), m_GraphicsDevice.get_command_pool(), 1, &commandBuffer);
+	}
+
+	void SERenderSystem::bind_mesh_geometry(VkCommandBuffer commandBuffer, const SEMesh& mesh, FBoundState& boundState)
+	{
+		FBoundGeometry& boundGeometry = boundState.geometry;
+		const VkBuffer vertexBuffer = mesh.get_vertex_buffer();
+		if (vertexBuffer != boundGeometry.vertexBuffer)
+		{
+			const VkDeviceSize offset = 0;
+			vkCmdBindVertexBuffers(commandBuffer, 0, 1, &vertexBuffer, &offset);
+			boundGeometry.vertexBuffer = vertexBuffer;
+			boundState.renderStats.geometryBinds++;
+		}
+
+		// 16 and 32-bit indices share the pool's index buffer, switching type needs a rebind
+		const VkBuffer indexBuffer = mesh.get_index_buffer();
+		if (indexBuffer != VK_NULL_HANDLE && (indexBuffer != boundGeometry.indexBuffer || mesh.get_index_type() != boundGeometry.indexType))
+		{
+			vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0, mesh.get_index_type());
+			boundGeometry.indexBuffer = indexBuffer;
+			boundGeometry.indexType = mesh.get_index_type();
+			boundState.renderStats.geometryBinds++;
+		}
+	}
+
+	void SERenderSystem::cull_candidates(const FFrustum& frustum)
+	{
+		const uint32_t candidateCount = static_cast<uint32_t>(m_DrawCandidates.size());
+		frustum.intersects_spheres(m_CandidateCentersX.data(), m_CandidateCentersY.data(), m_CandidateCentersZ.data(), m_CandidateRadii.data(), candidateCount, m_CandidateVisible.data());
+
+		// Spheres are loose around long thin meshes, the box transformed to world space is tighter
+		for (uint32_t candidateIndex = 0; candidateIndex < candidateCount; candidateIndex++)
+		{
+			if (!m_CandidateVisible[candidateIndex]) { continue; }
+
+			const SEMesh& mesh = *m_DrawCandidates[candidateIndex].mesh;
+			const glm::mat4& transformMatrix = m_DrawCandidates[candidateIndex].transformMatrix;
+			const glm::vec3 localCenter = (mesh.get_bounds_min() + mesh.get_bounds_max()) * 0.5f;
+			const glm::vec3 localExtents = (mesh.get_bounds_max() - mesh.get_bounds_min()) * 0.5f;
+
+			const glm::vec3 worldCenter{transformMatrix * glm::vec4{localCenter, 1.0f}};
+			const glm::vec3 worldExtents = glm::abs(glm::vec3{transformMatrix[0]}) * localExtents.x
+				+ glm::abs(glm::vec3{transformMatrix[1]}) * localExtents.y
+				+ glm::abs(glm::vec3{transformMatrix[2]}) * localExtents.z;
 
-			vkCmdPushConstants(frameInfo.commandBuffer, m_PipelineLayout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(PushConstantData), &push);
-			gameObject.m_Mesh->bind_command_buffer(frameInfo.commandBuffer);
-			gameObject.m_Mesh->draw(frameInfo.commandBuffer);
+			if (!frustum.intersects_box(worldCenter, worldExtents)) { m_CandidateVisible[candidateIndex] = 0; }
 		}
 	}
 
@@ -5,37 +5,259 @@
 #include "SECore/SEEntities/SEGameObject.hpp"
 #include "SECore/SEEntities/SECamera.hpp"
 #include "SERendering/SEFrameInfo.hpp"
+#include "SERendering/SEFrameAllocator.hpp"
+#include "SERendering/SERenderSystems/SEGpuCulling.hpp"
+#include "SERendering/SEParallelRecorder.hpp"
+#include "SECore/SEUtilities/SEFrustum.hpp"
+#include "SECore/SEUtilities/SERadixSort.hpp"
 
+#include <array>
 #include <memory>
 #include <vector>
 
 namespace SE {
 
+	struct FLodSettings {
+		// Simplification error allowed on screen, as a fraction of the viewport height. 0 always draws full detail
+		float maxScreenError = 0.001f;
+		// A coarser level is only taken once its error is this fraction below the limit, so objects near a switch
+		// distance do not flip between levels every frame
+		float hysteresis = 0.25f;
+	};
+
+	struct FCullingSettings {
+		// Skips objects whose bounds are outside the camera frustum
+		bool frustumCulling = true;
+		// Meshes split into meshlets draw only the ranges of meshlets that pass the tests below
+		bool clusterCulling = true;
+		// Drops meshlets whose normal cone faces away from the camera. Assumes closed meshes, the pipelines do not
+		// cull back faces
+		bool clusterConeCulling = true;
+		// Tests the objects registered with SERenderSystem::add_gpu_scene_object in a compute shader that also picks
+		// their levels of detail and writes the indirect draws, see SEGpuCulling. Needs VK_KHR_draw_indirect_count, the
+		// CPU path runs without it. Meshlets are not culled, meshes without an index buffer are drawn by the CPU path
+		bool gpuCulling = false;
+	};
+
+	// Per-instance vertex input of the render pipelines. Each frame writes one entry per visible object to the frame
+	// allocator, objects that share a mesh, level of detail and texture sit next to each other and draw as one instance range
+	struct FInstanceData {
+		glm::mat4 meshMatrix{1.0f};		// Model matrix, with the dequantization of packed positions
+		glm::mat4 normalMatrix{1.0f};
+
+		static constexpr uint32_t BINDING = 1;
+		static constexpr uint32_t FIRST_LOCATION = 4;	// After the mesh attributes, each matrix takes four locations
+
+		static std::vector<VkVertexInputBindingDescription> get_binding_descriptions();
+		static std::vector<VkVertexInputAttributeDescription> get_attribute_descriptions();
+	};
+
+	// How render_game_objects submits its draws. Indirect modes fall back to Direct on devices without multiDrawIndirect,
+	// IndirectCount falls back to Indirect without VK_KHR_draw_indirect_count
+	enum class EDrawSubmission : uint8_t {
+		Direct,			// One vkCmdDrawIndexed per draw
+		Indirect,		// Draws written to the frame allocator, one vkCmdDrawIndexedIndirect per run of draws that share state
+		IndirectCount	// As Indirect with the draw count read from a buffer, which GPU culling can write
+	};
+
+	static constexpr uint32_t DRAW_SUBMISSION_COUNT = 3;
+
+	struct FRenderStats {
+		uint32_t objectsVisible = 0;
+		uint32_t objectsCulled = 0;
+		uint32_t drawCalls = 0;			// One per instance range, plus the meshlet ranges of single objects
+		uint32_t stateChanges = 0;		// Pipeline, geometry and texture binds together
+		uint32_t pipelineBinds = 0;
+		uint32_t geometryBinds = 0;		// Vertex and index buffer binds
+		uint32_t textureBinds = 0;		// Descriptor set 1 binds
+		uint32_t indirectCalls = 0;		// Indirect draw calls, each covers a run of draws
+		uint64_t trianglesSubmitted = 0;
+		uint32_t clustersVisible = 0;
+		uint32_t clustersCulled = 0;
+		uint32_t gpuCulledObjects = 0;	// Objects tested by the culling shader, counted in neither visible nor culled
+		uint32_t instancesDropped = 0;	// Visible objects whose instance data did not fit in the frame allocator
+	};
+
 	class SERenderSystem {
 
 	public:
 
 #pragma region Lifecycle
-		SERenderSystem(SEGraphicsDevice& graphicsDevice, VkRenderPass renderPass, VkDescriptorSetLayout globalDescriptorSetLayout);
+		// Set 1 of the pipelines holds an object's texture, defaultTextureDescriptorSet is bound for objects without a resident one
+		// Instance data is written to frameAllocator, which must have begun the frame being recorded
+		SERenderSystem(SEGraphicsDevice& graphicsDevice, SEFrameAllocator& frameAllocator, VkRenderPass renderPass, VkDescriptorSetLayout globalDescriptorSetLayout, VkDescriptorSetLayout textureDescriptorSetLayout, VkDescriptorSet defaultTextureDescriptorSet);
 		~SERenderSystem();
 
 		SERenderSystem(const SERenderSystem&) = delete;
 		SERenderSystem& operator=(const SERenderSystem&) = delete;
 #pragma endregion Lifecycle
 
+		// Records the draws inline into frameInfo.commandBuffer, inside the render pass
 		void render_game_objects(FFrameInfo& frameInfo, std::vector<SEGameObject>& gameObjects);
+		// Prepares the draws on the calling thread, then records them into secondary command buffers on the recorder's
+		// threads, each taking a contiguous share of the runs. Execute the returned buffers in order inside renderPass,
+		// begun with VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS
+		const std::vector<VkCommandBuffer>& record_game_objects(FFrameInfo& frameInfo, std::vector<SEGameObject>& gameObjects, SEParallelRecorder& recorder, VkRenderPass renderPass);
+		// Registers an object with GPU culling, or rewrites its record after its transform, mesh or texture changed.
+		// Records stay on the GPU between frames, only changed ones are uploaded. Ignored while GPU culling is inactive
+		void add_gpu_scene_object(const SEGameObject& gameObject);
+		void remove_gpu_scene_object(SEGameObject::id_type id);
+		// Records the culling dispatch over the registered objects when GPU culling is on and supported, the next
+		// render_game_objects of the same frame draws its output. Call before the render pass begins. A frame whose
+		// frame allocator cannot take the changes is culled on the CPU instead
+		void record_gpu_culling(FFrameInfo& frameInfo);
+		bool is_gpu_culling_active() const { return m_CullingSettings.gpuCulling && m_GraphicsDevice.supports_draw_indirect_count(); }
+
+		void set_lod_settings(const FLodSettings& lodSettings) { m_LodSettings = lodSettings; }
+		const FLodSettings& get_lod_settings() const { return m_LodSettings; }
+		void set_culling_settings(const FCullingSettings& cullingSettings) { m_CullingSettings = cullingSettings; }
+		const FCullingSettings& get_culling_settings() const { return m_CullingSettings; }
+		void set_draw_submission(EDrawSubmission drawSubmission) { m_DrawSubmission = drawSubmission; }
+		EDrawSubmission get_draw_submission() const { return m_DrawSubmission; }
+		// Off draws visible objects in the order of the game object list, to compare state changes against sorted draws
+		void set_draw_sorting(bool bDrawSorting) { m_bDrawSorting = bDrawSorting; }
+		bool is_draw_sorting() const { return m_bDrawSorting; }
+		// The requested submission after falling back to what the device supports
+		EDrawSubmission get_supported_draw_submission(EDrawSubmission drawSubmission) const;
+		// Counts of the last render_game_objects call
+		const FRenderStats& get_render_stats() const { return m_RenderStats; }
+
+		// Times recording objectCount draws of mesh into a secondary command buffer with each submission mode and prints
+		// the results. The draws do not batch, as if every object had a mesh of its own. Rewinds the frame allocator, so
+		// no frame may be in flight
+		void benchmark_draw_submission(VkRenderPass renderPass, SEMesh& mesh, VkDescriptorSet globalDescriptorSet, const std::vector<uint32_t>& objectCounts, uint32_t iterations = 20);
 
 
 	private:
+		// Fewer draws than this per thread cost more in waking workers and binding state again than they save
+		static constexpr uint32_t MIN_DRAWS_PER_THREAD = 256;
+		// Pass field of the sort keys, passes draw in increasing order. Only opaque geometry exists so far
+		static constexpr uint32_t OPAQUE_PASS = 0;
 
-		void create_pipeline_layout(VkDescriptorSetLayout globalDescriptorSetLayout);
+		// Sort key of one visible object, most significant field first:
+		//   pass 2 bits | pipeline 2 | mesh 16 | level of detail 4 | texture 16 | depth 24
+		// State fields come first so that objects which batch together are adjacent and pipeline changes are rarest.
+		// Depth is last, so instances inside a batch draw front to back. Ids wrap, objects whose ids collide only
+		// lose batching, FInstanceDraw::is_same_batch still compares the real state
+		static uint64_t make_sort_key(uint32_t pass, EVertexFormat vertexFormat, uint32_t meshId, uint32_t lodIndex, uint32_t textureId, float viewDepth);
+		static constexpr uint64_t SORT_KEY_DEPTH_MASK = (1ull << 24) - 1;
+
+		void create_pipeline_layout(VkDescriptorSetLayout globalDescriptorSetLayout, VkDescriptorSetLayout textureDescriptorSetLayout);
 		void create_pipeline(VkRenderPass renderPass);
+		// Adds draws for the index ranges of the meshlets inside the frustum and not facing away for one instance. Frustum
+		// and camera are in mesh space
+		void add_visible_meshlet_draws(SEMesh& mesh, VkDescriptorSet textureDescriptorSet, const FFrustum& meshFrustum, const glm::vec3& meshCameraPosition, bool bConeCulling, uint32_t instanceIndex);
+		// Diameter of the world bounding sphere on screen in pixels, which streaming turns into the mip level it wants
+		static float get_screen_extent(const glm::vec3& worldCenter, float worldRadius, const FFrameInfo& frameInfo);
+		uint32_t select_lod(const SEMesh& mesh, const glm::mat4& transformMatrix, const glm::vec3& scale, const SECamera& camera, uint32_t previousLodIndex) const;
+		// Vertex and index buffers bound in the command buffer being recorded
+		struct FBoundGeometry {
+			VkBuffer vertexBuffer = VK_NULL_HANDLE;
+			VkBuffer indexBuffer = VK_NULL_HANDLE;
+			VkIndexType indexType = VK_INDEX_TYPE_UINT32;
+		};
+
+		// One draw of m_DrawCommands, with the state it needs bound
+		struct FDrawCommand {
+			VkDrawIndexedIndirectCommand command;
+			SEMesh* mesh;
+			VkDescriptorSet textureDescriptorSet;
+		};
+		// Draws that follow each other in m_DrawCommands and share pipeline, geometry buffers and texture. An indirect
+		// call covers a run
+		struct FDrawRun {
+			uint32_t firstDraw;
+			uint32_t drawCount;
+		};
+		// State of one command buffer being recorded, each recording thread has its own
+		struct FBoundState {
+			EVertexFormat vertexFormat = EVertexFormat::Full;
+			FBoundGeometry geometry{};
+			VkDescriptorSet textureDescriptorSet = VK_NULL_HANDLE;
+			FRenderStats renderStats{};		// Binds and indirect calls recorded, added to m_RenderStats afterwards
+		};
+		// Binds the buffers of a mesh unless they are bound already. Meshes in the geometry pool share them
+		void bind_mesh_geometry(VkCommandBuffer commandBuffer, const SEMesh& mesh, FBoundState& boundState);
+		static bool is_same_draw_state(const FDrawCommand& left, const FDrawCommand& right);
+		void bind_draw_state(VkCommandBuffer commandBuffer, const FDrawCommand& drawCommand, FBoundState& boundState);
+		// Splits m_DrawCommands into m_DrawRuns
+		void build_draw_runs();
+		// Records runs firstRun to runEnd of m_DrawRuns. Indirect modes write their commands, and the counts, to the frame
+		// allocator. Safe to call from several threads for separate runs
+		void submit_draws(VkCommandBuffer commandBuffer, EDrawSubmission drawSubmission, FBoundState& boundState, uint32_t firstRun, uint32_t runEnd);
+		// Fills m_DrawCandidates and their world bounding spheres with the objects whose mesh is resident, only those
+		// without an index buffer when bNonIndexedOnly is set
+		void gather_draw_candidates(const FFrameInfo& frameInfo, std::vector<SEGameObject>& gameObjects, bool bNonIndexedOnly);
+		// Draws what the culling shader appended, one indirect count draw per run of the GPU scene
+		void submit_gpu_culled_draws(VkCommandBuffer commandBuffer, FBoundState& boundState);
+		// Culls, picks levels of detail and textures and builds the frame's runs. After a culling dispatch only the
+		// objects the shader cannot draw are left
+		void prepare_draws(FFrameInfo& frameInfo, std::vector<SEGameObject>& gameObjects);
+		// Binds the frame's pipeline state and records a range of the prepared runs, after the culling dispatch's draws
+		// when bGpuCulledDraws is set
+		void record_draws(VkCommandBuffer commandBuffer, const FFrameInfo& frameInfo, uint32_t firstRun, uint32_t runEnd, bool bGpuCulledDraws, FBoundState& boundState);
+		void add_recording_stats(const FRenderStats& recordingStats);
+		// Clears m_CandidateVisible for candidates outside the frustum. Spheres are tested in one batch, survivors
+		// are refined against their world space boxes
+		void cull_candidates(const FFrustum& frustum);
+
+		// Resident mesh of a game object and its world transform, gathered before culling
+		struct FDrawCandidate {
+			SEGameObject* gameObject;
+			SEMesh* mesh;
+			glm::mat4 transformMatrix;
+		};
+
+		// Visible object after level of detail and texture selection, sorted so that draws of one batch are adjacent
+		struct FInstanceDraw {
+			SEMesh* mesh;
+			uint32_t lodIndex;
+			VkDescriptorSet textureDescriptorSet;
+			uint32_t candidateIndex;
+
+			bool is_same_batch(const FInstanceDraw& other) const { return mesh == other.mesh && lodIndex == other.lodIndex && textureDescriptorSet == other.textureDescriptorSet; }
+		};
 
 
 		SEGraphicsDevice& m_GraphicsDevice;
+		SEFrameAllocator& m_FrameAllocator;
 		VkPipelineLayout m_PipelineLayout;
+		VkDescriptorSet m_DefaultTextureDescriptorSet;
+
+		// One pipeline per vertex format, selected per mesh while recording
+		std::array<std::unique_ptr<SERenderPipeline>, VERTEX_FORMAT_COUNT> m_Pipelines;
+
+		FLodSettings m_LodSettings{};
+		FCullingSettings m_CullingSettings{};
+		FRenderStats m_RenderStats{};
+		EDrawSubmission m_DrawSubmission{EDrawSubmission::IndirectCount};
+
+		// Per frame culling input, world bounding spheres kept as separate arrays for the batch test. Members so
+		// their capacity carries over between frames
+		std::vector<FDrawCandidate> m_DrawCandidates{};
+		std::vector<float> m_CandidateCentersX{};
+		std::vector<float> m_CandidateCentersY{};
+		std::vector<float> m_CandidateCentersZ{};
+		std::vector<float> m_CandidateRadii{};
+		std::vector<uint8_t> m_CandidateVisible{};
+		std::vector<FInstanceDraw> m_InstanceDraws{};
+		std::vector<FInstanceDraw> m_SortedInstanceDraws{};
+		std::vector<FSortItem> m_SortItems{};
+		std::vector<FSortItem> m_SortScratch{};
+		bool m_bDrawSorting = true;
+		bool m_bInstanceLimitWarned = false;
+		std::vector<FDrawCommand> m_DrawCommands{};
+		std::vector<FDrawRun> m_DrawRuns{};
+		VkDeviceSize m_InstanceOffset = 0;			// Of this frame's instance data in the frame allocator
+		bool m_bDrawsGpuCulled = false;				// The frame also draws the output of its culling dispatch
+		std::vector<uint32_t> m_ThreadFirstRuns{};	// Per recording thread, with the run count at the end
+		std::vector<FRenderStats> m_ThreadRenderStats{};
 
-		std::unique_ptr<SERenderPipeline> m_Pipeline;
+		// Created on first use
+		std::unique_ptr<SEGpuScene> m_GpuScene{};
+		std::unique_ptr<SEGpuCulling> m_GpuCulling{};
+		bool m_bGpuCullingRecorded = false;
+		uint64_t m_GpuCullingFrame = 0;		// Frame number of the last recorded culling dispatch
 	};
 
 } // end SE namespace
\ No newline at end of file
@@ -9,6 +9,7 @@ namespace SE {
 	{
 		recreate_swap_chain();
 		create_command_buffers();
+		m_FrameAllocator = std::make_unique<SEFrameAllocator>(m_GraphicsDevice, SESwapChain::MAX_FRAMES_IN_FLIGHT);
 	}
 
 	SERenderer::~SERenderer()
@@ -35,6 +36,9 @@ namespace SE {
 
 		m_bIsFrameStarted = true;
 
+		// Acquiring waited for the fence of the frame that last used this index, so its transient data is free
+		m_FrameAllocator->begin_frame(m_CurrentFrameIndex);
+
 		VkCommandBuffer commandBuffer = get_current_command_buffer();
 		VkCommandBufferBeginInfo beginInfo{};
 		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
@@ -53,6 +57,12 @@ namespace SE {
 
 		VkCommandBuffer commandBuffer = get_current_command_buffer();
 
+		// Host writes to non-coherent memory made for this frame reach the device with its submission
+		if (m_GraphicsDevice.get_memory_allocator().flush_dirty_ranges() != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to flush mapped memory!");
+		}
+
 		if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS)
 		{
 			throw std::runtime_error("failed to record command buffer!");
@@ -72,7 +82,7 @@ namespace SE {
 		m_CurrentFrameIndex = (m_CurrentFrameIndex + 1) % SESwapChain::MAX_FRAMES_IN_FLIGHT;
 	}
 
-	void SERenderer::begin_swap_chain_render_pass(VkCommandBuffer commandBuffer)
+	void SERenderer::begin_swap_chain_render_pass(VkCommandBuffer commandBuffer, VkSubpassContents subpassContents)
 	{
 		assert(m_bIsFrameStarted && "Can't call begin_swap_chain_render_pass if frame is not in progress");
 		assert(commandBuffer == get_current_command_buffer() && "Can't begin render pass on command buffer from a different frame");
@@ -91,7 +101,8 @@ namespace SE {
 		renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
 		renderPassInfo.pClearValues = clearValues.data();
 
-		vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+		vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, subpassContents);
+		if (subpassContents == VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS) { return; }
 
 		VkViewport viewport{};
 		viewport.x = 0.0f;
@@ -144,7 +155,7 @@ namespace SE {
 		if (!m_CommandBuffers.empty()) 
 		{
 			// Wait for the device to finish all operations
-			vkDeviceWaitIdle(m_GraphicsDevice.device());
+			m_GraphicsDevice.wait_idle();
 
 			vkFreeCommandBuffers(m_GraphicsDevice.device(), m_GraphicsDevice.get_command_pool(), static_cast<uint32_t>(m_CommandBuffers.size()), m_CommandBuffers.data());
 			m_CommandBuffers.clear();
@@ -160,7 +171,7 @@ namespace SE {
 			windowExtent = m_SEWindow.get_window_extent();
 			glfwWaitEvents();
 		}
-		vkDeviceWaitIdle(m_GraphicsDevice.device());
+		m_GraphicsDevice.wait_idle();
 
 		if (m_SwapChain == nullptr)
 		{
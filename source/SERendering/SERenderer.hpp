@@ -3,6 +3,7 @@
 #include "SERendering/SEWindow/SEWindow.hpp"
 #include "SERendering/SEGraphicsDevice/SEGraphicsDevice.hpp"
 #include "SERendering/SERenderPipeline/SESwapChain.hpp"
+#include "SERendering/SEFrameAllocator.hpp"
 
 #include <memory>
 #include <vector>
@@ -26,13 +27,18 @@ namespace SE {
 
 		VkCommandBuffer begin_frame();
 		void end_frame();
-		void begin_swap_chain_render_pass(VkCommandBuffer commandBuffer);
+		// With VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS the pass only takes vkCmdExecuteCommands, the secondary
+		// command buffers set viewport and scissor themselves
+		void begin_swap_chain_render_pass(VkCommandBuffer commandBuffer, VkSubpassContents subpassContents = VK_SUBPASS_CONTENTS_INLINE);
 		void end_swap_chain_render_pass(VkCommandBuffer commandBuffer);
 		bool is_frame_in_progress() const { return m_bIsFrameStarted; };
 		VkRenderPass get_swap_chain_render_pass() const { return m_SwapChain->get_render_pass(); };
 		float get_swap_chain_aspect_ratio() const { return m_SwapChain->get_extent_aspect_ratio(); };
+		VkExtent2D get_swap_chain_extent() const { return m_SwapChain->get_spawchain_extent(); }
 		VkCommandBuffer get_current_command_buffer() const;
 		uint32_t get_current_frame_index() const;
+		// Transient per frame data, rewound for each frame by begin_frame
+		SEFrameAllocator& get_frame_allocator() { return *m_FrameAllocator; }
 
 	private:
 
@@ -47,6 +53,7 @@ namespace SE {
 
 		std::unique_ptr<SESwapChain> m_SwapChain;
 		std::vector<VkCommandBuffer> m_CommandBuffers;
+		std::unique_ptr<SEFrameAllocator> m_FrameAllocator;
 
 		uint32_t m_CurrentImageIndex = 0;
 		uint32_t m_CurrentFrameIndex = 0;
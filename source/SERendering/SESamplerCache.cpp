@@ -0,0 +1,55 @@
+#include "SESamplerCache.hpp"
+
+#include <stdexcept>
+
+namespace SE {
+
+#pragma region Lifecycle
+SESamplerCache::~SESamplerCache()
+{
+	for (const auto& [samplerDesc, sampler] : m_Samplers)
+	{
+		vkDestroySampler(m_GraphicsDevice.device(), sampler, nullptr);
+	}
+}
+#pragma endregion Lifecycle
+
+VkSampler SESamplerCache::get_sampler(const FSamplerDesc& samplerDesc)
+{
+	std::lock_guard<std::mutex> samplerLock{m_Mutex};
+	VkSampler& sampler = m_Samplers[samplerDesc];
+	if (sampler != VK_NULL_HANDLE) { return sampler; }
+
+	VkSamplerCreateInfo samplerInfo{};
+	samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+	samplerInfo.magFilter = samplerDesc.filter;
+	samplerInfo.minFilter = samplerDesc.filter;
+	samplerInfo.mipmapMode = samplerDesc.mipmapMode;
+	samplerInfo.addressModeU = samplerDesc.addressMode;
+	samplerInfo.addressModeV = samplerDesc.addressMode;
+	samplerInfo.addressModeW = samplerDesc.addressMode;
+	samplerInfo.mipLodBias = 0.0f;
+	samplerInfo.anisotropyEnable = samplerDesc.bAnisotropy ? VK_TRUE : VK_FALSE;
+	samplerInfo.maxAnisotropy = samplerDesc.bAnisotropy ? m_GraphicsDevice.properties.limits.maxSamplerAnisotropy : 1.0f;
+	samplerInfo.compareEnable = VK_FALSE;
+	samplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
+	samplerInfo.minLod = 0.0f;
+	samplerInfo.maxLod = VK_LOD_CLAMP_NONE;
+	samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
+	samplerInfo.unnormalizedCoordinates = VK_FALSE;
+
+	if (vkCreateSampler(m_GraphicsDevice.device(), &samplerInfo, nullptr, &sampler) != VK_SUCCESS)
+	{
+		m_Samplers.erase(samplerDesc);
+		throw std::runtime_error("failed to create sampler!");
+	}
+	return sampler;
+}
+
+uint32_t SESamplerCache::get_sampler_count()
+{
+	std::lock_guard<std::mutex> samplerLock{m_Mutex};
+	return static_cast<uint32_t>(m_Samplers.size());
+}
+
+} // namespace SE
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "SERendering/SEGraphicsDevice/SEGraphicsDevice.hpp"
+
+#include <mutex>
+#include <unordered_map>
+
+namespace SE {
+
+// Sampler state that textures can share. Samplers never clamp the level of detail, image views select the
+// resident mip levels, so one sampler serves a texture whatever its residency
+struct FSamplerDesc {
+	VkFilter filter = VK_FILTER_LINEAR;
+	VkSamplerMipmapMode mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+	VkSamplerAddressMode addressMode = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+	bool bAnisotropy = true;		// At the device's maximum anisotropy
+
+	bool operator==(const FSamplerDesc& other) const
+	{
+		return filter == other.filter && mipmapMode == other.mipmapMode && addressMode == other.addressMode && bAnisotropy == other.bAnisotropy;
+	}
+};
+
+// Creates each distinct sampler once. Devices limit the number of live samplers (maxSamplerAllocationCount, as
+// low as 4000), so textures take their sampler from here instead of creating their own. Thread safe
+class SESamplerCache {
+
+public:
+#pragma region Lifecycle
+	SESamplerCache(SEGraphicsDevice& device) : m_GraphicsDevice(device) {}
+	~SESamplerCache();
+	SESamplerCache(const SESamplerCache&) = delete;
+	SESamplerCache& operator=(const SESamplerCache&) = delete;
+#pragma endregion Lifecycle
+
+	// The sampler lives as long as the cache
+	VkSampler get_sampler(const FSamplerDesc& samplerDesc);
+	uint32_t get_sampler_count();
+
+private:
+	struct FSamplerDescHash {
+		size_t operator()(const FSamplerDesc& samplerDesc) const
+		{
+			return static_cast<size_t>(samplerDesc.filter) | static_cast<size_t>(samplerDesc.mipmapMode) << 8 | static_cast<size_t>(samplerDesc.addressMode) << 16
+				| static_cast<size_t>(samplerDesc.bAnisotropy) << 24;
+		}
+	};
+
+	SEGraphicsDevice& m_GraphicsDevice;
+
+	std::mutex m_Mutex;
+	std::unordered_map<FSamplerDesc, VkSampler, FSamplerDescHash> m_Samplers{};
+};
+
+} // namespace SE
@@ -0,0 +1,368 @@
+#include "SEStagingRing.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace SE {
+
+#pragma region Lifecycle
+SEStagingRing::SEStagingRing(SEGraphicsDevice& device, VkDeviceSize capacity) : m_GraphicsDevice{device}, m_Capacity{capacity}
+{
+	m_RingBuffer = std::make_unique<SEBuffer>(device, capacity, 1, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, EMemoryCategory::Staging);
+	if (m_RingBuffer->map() != VK_SUCCESS)
+	{
+		throw std::runtime_error("failed to map staging ring!");
+	}
+
+	const QueueFamilyIndices queueFamilies = device.find_physical_queue_families();
+	m_bOwnershipTransfer = queueFamilies.has_separate_transfer_family();
+	m_TransferFamily = queueFamilies.transferFamily;
+	m_GraphicsFamily = queueFamilies.graphicsFamily;
+
+	VkCommandPoolCreateInfo poolInfo = {};
+	poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+	poolInfo.queueFamilyIndex = m_TransferFamily;
+	poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+
+	if (vkCreateCommandPool(device.device(), &poolInfo, nullptr, &m_CommandPool) != VK_SUCCESS)
+	{
+		throw std::runtime_error("failed to create staging command pool!");
+	}
+
+	if (m_bOwnershipTransfer)
+	{
+		poolInfo.queueFamilyIndex = m_GraphicsFamily;
+		if (vkCreateCommandPool(device.device(), &poolInfo, nullptr, &m_AcquireCommandPool) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to create staging acquire command pool!");
+		}
+	}
+}
+
+SEStagingRing::~SEStagingRing()
+{
+	wait_idle();
+
+	// Command buffers go with the pools
+	for (const FSubmission& submission : m_FreeSubmissions)
+	{
+		vkDestroyFence(m_GraphicsDevice.device(), submission.fence, nullptr);
+		if (submission.copiesDone != VK_NULL_HANDLE)
+		{
+			vkDestroySemaphore(m_GraphicsDevice.device(), submission.copiesDone, nullptr);
+		}
+	}
+	vkDestroyCommandPool(m_GraphicsDevice.device(), m_CommandPool, nullptr);
+	if (m_AcquireCommandPool != VK_NULL_HANDLE)
+	{
+		vkDestroyCommandPool(m_GraphicsDevice.device(), m_AcquireCommandPool, nullptr);
+	}
+}
+#pragma endregion Lifecycle
+
+uint64_t SEStagingRing::upload_to_buffer(const void* data, VkDeviceSize size, VkBuffer dstBuffer, VkDeviceSize dstOffset)
+{
+	std::lock_guard<std::mutex> ringLock{m_Mutex};
+	m_Stats.uploads++;
+
+	const char* source = static_cast<const char*>(data);
+	const VkDeviceSize maxChunkSize = m_Capacity / 4;
+	while (size > 0)
+	{
+		const VkDeviceSize chunkSize = std::min(size, maxChunkSize);
+
+		VkDeviceSize ringOffset = 0;
+		while (!try_reserve(chunkSize, ringOffset))
+		{
+			retire_submissions(false);
+			if (try_reserve(chunkSize, ringOffset)) { break; }
+
+			// Queued copies hold ring space as well, it only comes back once they are submitted and complete
+			flush_locked();
+			retire_submissions(true);
+			m_Stats.stalls++;
+		}
+
+		memcpy(static_cast<char*>(m_RingBuffer->get_mapped_memory()) + ringOffset, source, chunkSize);
+		m_PendingCopies.push_back(FPendingCopy{dstBuffer, VkBufferCopy{ringOffset, dstOffset, chunkSize}});
+
+		source += chunkSize;
+		dstOffset += chunkSize;
+		size -= chunkSize;
+		m_Stats.copyRegions++;
+		m_Stats.uploadedBytes += chunkSize;
+	}
+	return m_CurrentTicket;
+}
+
+void SEStagingRing::flush()
+{
+	std::lock_guard<std::mutex> ringLock{m_Mutex};
+	retire_submissions(false);
+	flush_locked();
+}
+
+void SEStagingRing::wait_idle()
+{
+	std::lock_guard<std::mutex> ringLock{m_Mutex};
+	flush_locked();
+	while (!m_Submissions.empty())
+	{
+		retire_submissions(true);
+	}
+}
+
+FStagingStats SEStagingRing::get_stats()
+{
+	std::lock_guard<std::mutex> ringLock{m_Mutex};
+	return m_Stats;
+}
+
+bool SEStagingRing::try_reserve(VkDeviceSize size, VkDeviceSize& offset)
+{
+	if (m_UsedBytes == 0)
+	{
+		m_Head = 0;
+		m_Tail = 0;
+	}
+
+	// Free space is [head, capacity) plus [0, tail) until the head wraps, then [head, tail)
+	VkDeviceSize start = (m_Head + COPY_ALIGNMENT - 1) & ~(COPY_ALIGNMENT - 1);
+	VkDeviceSize padding = 0;
+	const bool bWrapped = m_Head < m_Tail || (m_Head == m_Tail && m_UsedBytes > 0);
+	if (!bWrapped)
+	{
+		if (start + size <= m_Capacity)
+		{
+			padding = start - m_Head;
+		}
+		else if (size <= m_Tail)
+		{
+			// The end of the ring is skipped and stays held until the tail passes it
+			start = 0;
+			padding = m_Capacity - m_Head;
+		}
+		else
+		{
+			return false;
+		}
+	}
+	else
+	{
+		if (start + size > m_Tail) { return false; }
+		padding = start - m_Head;
+	}
+
+	m_Head = start + size;
+	m_UsedBytes += padding + size;
+	m_PendingRingBytes += padding + size;
+	offset = start;
+	return true;
+}
+
+void SEStagingRing::flush_locked()
+{
+	if (m_PendingCopies.empty()) { return; }
+
+	FSubmission submission{};
+	if (!m_FreeSubmissions.empty())
+	{
+		submission = m_FreeSubmissions.back();
+		m_FreeSubmissions.pop_back();
+		vkResetFences(m_GraphicsDevice.device(), 1, &submission.fence);
+	} else {
+		VkCommandBufferAllocateInfo allocInfo{};
+		allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+		allocInfo.commandPool = m_CommandPool;
+		allocInfo.commandBufferCount = 1;
+		VkFenceCreateInfo fenceInfo{};
+		fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+		if (vkAllocateCommandBuffers(m_GraphicsDevice.device(), &allocInfo, &submission.commandBuffer) != VK_SUCCESS ||
+			vkCreateFence(m_GraphicsDevice.device(), &fenceInfo, nullptr, &submission.fence) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to create staging submission!");
+		}
+
+		if (m_bOwnershipTransfer)
+		{
+			allocInfo.commandPool = m_AcquireCommandPool;
+			VkSemaphoreCreateInfo semaphoreInfo{};
+			semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+			if (vkAllocateCommandBuffers(m_GraphicsDevice.device(), &allocInfo, &submission.acquireCommandBuffer) != VK_SUCCESS ||
+				vkCreateSemaphore(m_GraphicsDevice.device(), &semaphoreInfo, nullptr, &submission.copiesDone) != VK_SUCCESS)
+			{
+				throw std::runtime_error("failed to create staging acquire submission!");
+			}
+		}
+	}
+
+	VkCommandBufferBeginInfo beginInfo{};
+	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+	vkBeginCommandBuffer(submission.commandBuffer, &beginInfo);
+
+	// One copy command per destination buffer. The sort is stable, so overlapping copies keep their order
+	std::stable_sort(m_PendingCopies.begin(), m_PendingCopies.end(), [](const FPendingCopy& left, const FPendingCopy& right) { return left.dstBuffer < right.dstBuffer; });
+	std::vector<VkBufferCopy> regions;
+	regions.reserve(m_PendingCopies.size());
+	for (size_t copyIndex = 0; copyIndex < m_PendingCopies.size();)
+	{
+		const VkBuffer dstBuffer = m_PendingCopies[copyIndex].dstBuffer;
+		regions.clear();
+		for (; copyIndex < m_PendingCopies.size() && m_PendingCopies[copyIndex].dstBuffer == dstBuffer; copyIndex++)
+		{
+			regions.push_back(m_PendingCopies[copyIndex].region);
+		}
+		vkCmdCopyBuffer(submission.commandBuffer, m_RingBuffer->get_buffer(), dstBuffer, static_cast<uint32_t>(regions.size()), regions.data());
+	}
+
+	if (m_bOwnershipTransfer)
+	{
+		record_ownership_transfer(submission);
+	}
+	else
+	{
+		// Later submissions on the queue read the data as vertices, indices, uniforms or storage
+		VkMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_UNIFORM_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+		vkCmdPipelineBarrier(submission.commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+			0, 1, &barrier, 0, nullptr, 0, nullptr);
+	}
+
+	vkEndCommandBuffer(submission.commandBuffer);
+	submit(submission);
+
+	submission.ringEnd = m_Head;
+	submission.ringBytes = m_PendingRingBytes;
+	m_PendingRingBytes = 0;
+	m_Submissions.push_back(submission);
+	m_PendingCopies.clear();
+
+	m_SubmittedTicket.store(m_CurrentTicket++, std::memory_order_release);
+	m_Stats.submits++;
+}
+
+void SEStagingRing::record_ownership_transfer(const FSubmission& submission)
+{
+	// Release and acquire name the same ranges. Copies are sorted by destination, chunks of one upload are adjacent
+	std::vector<VkBufferMemoryBarrier> barriers;
+	for (const FPendingCopy& copy : m_PendingCopies)
+	{
+		if (!barriers.empty() && barriers.back().buffer == copy.dstBuffer && barriers.back().offset + barriers.back().size == copy.region.dstOffset)
+		{
+			barriers.back().size += copy.region.size;
+			continue;
+		}
+
+		VkBufferMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+		barrier.srcQueueFamilyIndex = m_TransferFamily;
+		barrier.dstQueueFamilyIndex = m_GraphicsFamily;
+		barrier.buffer = copy.dstBuffer;
+		barrier.offset = copy.region.dstOffset;
+		barrier.size = copy.region.size;
+		barriers.push_back(barrier);
+	}
+	m_Stats.ownershipTransfers += barriers.size();
+
+	// Release, the access masks of the destination family are ignored here
+	for (VkBufferMemoryBarrier& barrier : barriers)
+	{
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = 0;
+	}
+	vkCmdPipelineBarrier(submission.commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+		0, 0, nullptr, static_cast<uint32_t>(barriers.size()), barriers.data(), 0, nullptr);
+
+	// Acquire, ordered after the copies by the semaphore. Its stages match the semaphore wait stages
+	const VkPipelineStageFlags readStages = VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+	for (VkBufferMemoryBarrier& barrier : barriers)
+	{
+		barrier.srcAccessMask = 0;
+		barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_UNIFORM_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+	}
+
+	VkCommandBufferBeginInfo beginInfo{};
+	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+	vkBeginCommandBuffer(submission.acquireCommandBuffer, &beginInfo);
+	vkCmdPipelineBarrier(submission.acquireCommandBuffer, readStages, readStages,
+		0, 0, nullptr, static_cast<uint32_t>(barriers.size()), barriers.data(), 0, nullptr);
+	vkEndCommandBuffer(submission.acquireCommandBuffer);
+}
+
+void SEStagingRing::submit(const FSubmission& submission)
+{
+	VkSubmitInfo submitInfo{};
+	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submitInfo.commandBufferCount = 1;
+	submitInfo.pCommandBuffers = &submission.commandBuffer;
+
+	if (!m_bOwnershipTransfer)
+	{
+		std::lock_guard<std::mutex> queueLock{m_GraphicsDevice.get_queue_mutex()};
+		if (vkQueueSubmit(m_GraphicsDevice.graphicsQueue(), 1, &submitInfo, submission.fence) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to submit staging copies!");
+		}
+		return;
+	}
+
+	submitInfo.signalSemaphoreCount = 1;
+	submitInfo.pSignalSemaphores = &submission.copiesDone;
+	{
+		std::lock_guard<std::mutex> queueLock{m_GraphicsDevice.get_transfer_queue_mutex()};
+		if (vkQueueSubmit(m_GraphicsDevice.transferQueue(), 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to submit staging copies!");
+		}
+	}
+
+	// Frames submitted to the graphics queue after the acquire see the data, frames already queued keep rendering
+	// while the copies run. The fence covers both submissions
+	const VkPipelineStageFlags waitStages = VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+	VkSubmitInfo acquireInfo{};
+	acquireInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	acquireInfo.waitSemaphoreCount = 1;
+	acquireInfo.pWaitSemaphores = &submission.copiesDone;
+	acquireInfo.pWaitDstStageMask = &waitStages;
+	acquireInfo.commandBufferCount = 1;
+	acquireInfo.pCommandBuffers = &submission.acquireCommandBuffer;
+	{
+		std::lock_guard<std::mutex> queueLock{m_GraphicsDevice.get_queue_mutex()};
+		if (vkQueueSubmit(m_GraphicsDevice.graphicsQueue(), 1, &acquireInfo, submission.fence) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to submit staging acquire!");
+		}
+	}
+}
+
+void SEStagingRing::retire_submissions(bool bWait)
+{
+	while (!m_Submissions.empty())
+	{
+		const FSubmission& submission = m_Submissions.front();
+		if (bWait)
+		{
+			vkWaitForFences(m_GraphicsDevice.device(), 1, &submission.fence, VK_TRUE, UINT64_MAX);
+			bWait = false;
+		}
+		else if (vkGetFenceStatus(m_GraphicsDevice.device(), submission.fence) != VK_SUCCESS)
+		{
+			break;
+		}
+
+		m_Tail = submission.ringEnd;
+		m_UsedBytes -= submission.ringBytes;
+		m_FreeSubmissions.push_back(submission);
+		m_Submissions.pop_front();
+	}
+}
+
+} // namespace SE
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "SERendering/SEGraphicsDevice/SEGraphicsDevice.hpp"
+#include "SERendering/SEBuffer.hpp"
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace SE {
+
+struct FStagingStats {
+	uint64_t uploads = 0;			// upload_to_buffer calls
+	uint64_t copyRegions = 0;
+	uint64_t uploadedBytes = 0;
+	uint64_t submits = 0;
+	uint64_t stalls = 0;			// Waits for the GPU to release ring space
+	uint64_t ownershipTransfers = 0;	// Buffer ranges released by the transfer family and acquired by graphics
+};
+
+// Persistently mapped staging buffer used as a ring. Uploads copy into the ring and queue a buffer copy, flush records
+// every queued copy into one command buffer and submits it with a fence. Ring space of a submission is reused once its
+// fence signals, so nothing waits for the queue to go idle. Thread safe
+//
+// On devices with a separate transfer family the copies run on the transfer queue, overlapping rendering. The written
+// ranges are released to the graphics family there and acquired by a small graphics submission that waits on the
+// copies' semaphore. Other devices record the copies on the graphics queue
+class SEStagingRing {
+
+public:
+	static constexpr VkDeviceSize DEFAULT_CAPACITY = 32ull * 1024 * 1024;
+	static constexpr VkDeviceSize COPY_ALIGNMENT = 16;
+
+#pragma region Lifecycle
+	SEStagingRing(SEGraphicsDevice& device, VkDeviceSize capacity = DEFAULT_CAPACITY);
+	~SEStagingRing();
+	SEStagingRing(const SEStagingRing&) = delete;
+	SEStagingRing& operator=(const SEStagingRing&) = delete;
+#pragma endregion Lifecycle
+
+	// Stages size bytes for dstBuffer at dstOffset, in chunks of at most a quarter of the ring. Returns the ticket of
+	// the submission that will carry the copy, the data is visible to commands submitted to the graphics queue once
+	// is_submitted(ticket) holds
+	uint64_t upload_to_buffer(const void* data, VkDeviceSize size, VkBuffer dstBuffer, VkDeviceSize dstOffset = 0);
+
+	// Submits the queued copies, if any, without waiting for them. Ends with a barrier that makes the writes visible
+	// to every later command on the queue
+	void flush();
+	// Flushes and waits for every submission to complete
+	void wait_idle();
+
+	bool is_submitted(uint64_t ticket) const { return ticket <= m_SubmittedTicket.load(std::memory_order_acquire); }
+
+	FStagingStats get_stats();
+
+private:
+	struct FPendingCopy {
+		VkBuffer dstBuffer;
+		VkBufferCopy region;
+	};
+
+	struct FSubmission {
+		VkCommandBuffer commandBuffer;
+		VkCommandBuffer acquireCommandBuffer;	// Ownership acquire on the graphics queue, with a separate transfer family
+		VkSemaphore copiesDone;
+		VkFence fence;							// Signals after the last submission of the batch
+		VkDeviceSize ringEnd;		// Head of the ring after this submission's data
+		VkDeviceSize ringBytes;		// Ring bytes held, including alignment and wrap padding
+	};
+
+	// Callers hold m_Mutex
+	bool try_reserve(VkDeviceSize size, VkDeviceSize& offset);
+	void flush_locked();
+	void record_ownership_transfer(const FSubmission& submission);
+	void submit(const FSubmission& submission);
+	// Releases the ring space of completed submissions. With bWait, blocks until the oldest one completes first
+	void retire_submissions(bool bWait);
+
+
+	SEGraphicsDevice& m_GraphicsDevice;
+	std::unique_ptr<SEBuffer> m_RingBuffer;
+	VkDeviceSize m_Capacity;
+	VkCommandPool m_CommandPool = VK_NULL_HANDLE;			// Transfer family
+	VkCommandPool m_AcquireCommandPool = VK_NULL_HANDLE;	// Graphics family, with a separate transfer family
+	bool m_bOwnershipTransfer = false;
+	uint32_t m_TransferFamily = 0;
+	uint32_t m_GraphicsFamily = 0;
+
+	std::mutex m_Mutex;
+	VkDeviceSize m_Head = 0;
+	VkDeviceSize m_Tail = 0;
+	VkDeviceSize m_UsedBytes = 0;
+	VkDeviceSize m_PendingRingBytes = 0;
+	std::vector<FPendingCopy> m_PendingCopies{};
+	std::deque<FSubmission> m_Submissions{};
+	// Command buffers and fences of retired submissions, reused by later ones
+	std::vector<FSubmission> m_FreeSubmissions{};
+
+	uint64_t m_CurrentTicket = 1;
+	std::atomic<uint64_t> m_SubmittedTicket{0};
+	FStagingStats m_Stats{};
+};
+
+} // namespace SE
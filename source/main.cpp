@@ -1,13 +1,61 @@
 #include "SEApp/SEApp.hpp"
+#include "SECore/SEComponents/SEMesh.hpp"
+#include "SERendering/SEGraphicsDevice/SEMemoryAllocator.hpp"
 
 #include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <stdexcept>
 
-int main() 
+int main(int argc, char** argv) 
 {
+	// Offline benchmarks run without creating a window or device
+	if (argc >= 3 && strcmp(argv[1], "--benchmark-mesh-load") == 0)
+	{
+		SE::SEMesh::benchmark_load_paths(argv[2]);
+		return 0;
+	}
+	if (argc >= 3 && strcmp(argv[1], "--benchmark-vertex-dedup") == 0)
+	{
+		SE::SEMesh::benchmark_vertex_dedup(argv[2]);
+		return 0;
+	}
+	if (argc >= 3 && strcmp(argv[1], "--benchmark-mesh-optimize") == 0)
+	{
+		SE::SEMesh::benchmark_mesh_optimization(argv[2]);
+		return 0;
+	}
+	if (argc >= 2 && strcmp(argv[1], "--benchmark-gpu-allocator") == 0)
+	{
+		SE::SEMemoryAllocator::benchmark_sub_allocation(argc >= 3 ? static_cast<uint32_t>(strtoul(argv[2], nullptr, 10)) : 1000000);
+		return 0;
+	}
+
+	// Needs a device, so it opens a small window
+	if (argc >= 3 && strcmp(argv[1], "--benchmark-mesh-upload") == 0)
+	{
+		SE::SEWindow window{640, 360, "Mesh upload benchmark"};
+		SE::SEGraphicsDevice device{window};
+		SE::SEMesh::benchmark_upload_paths(device, argv[2]);
+		return 0;
+	}
 
 	SE::SEApp app{};
+	for (int argumentIndex = 1; argumentIndex < argc; argumentIndex++)
+	{
+		if (strcmp(argv[argumentIndex], "--gpu-culling") == 0) { app.set_gpu_culling(true); }
+		if (strcmp(argv[argumentIndex], "--no-draw-sorting") == 0) { app.set_draw_sorting(false); }
+		if (strcmp(argv[argumentIndex], "--recording-threads") == 0 && argumentIndex + 1 < argc)
+		{
+			app.set_recording_thread_count(static_cast<uint32_t>(strtoul(argv[++argumentIndex], nullptr, 10)));
+		}
+	}
+
+	if (argc >= 3 && strcmp(argv[1], "--benchmark-draw-submission") == 0)
+	{
+		app.benchmark_draw_submission(argv[2]);
+		return 0;
+	}
 
 	try 
 	{